@@ -0,0 +1,134 @@
+#ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_BISECTIONEIGENSOLVER_HPP
+#define MROCK_IEOM_INCLUDE_MROCK_IEOM_BISECTIONEIGENSOLVER_HPP
+#include "detail/SymmetricTridiagonal.hpp"
+#include "detail/UnderlyingRealType.hpp"
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace mrock::iEoM {
+/**
+ * @brief Dense Hermitian eigensolver for a slice of the spectrum, i.e., the lowest eigenpairs or an eigenvalue window.
+ *
+ * The matrix is reduced to a real symmetric tridiagonal matrix T by Householder reflections (4/3 n^3 flops).
+ * The requested eigenvalues of T are found by bisection with Sturm sequence counts, O(n) per step,
+ * and their eigenvectors by inverse iteration, O(n) per step, see detail::SymmetricTridiagonal.
+ * Eigenvectors of close eigenvalues are orthogonalized against each other.
+ * Finally, the reflections are applied to the k eigenvectors of T, O(n^2 k).
+ * Compared to a full diagonalization, this saves the O(n^3) accumulation of all eigenvectors.
+ *
+ * @tparam EigenMatrixType Dense matrix type.
+ */
+template <class EigenMatrixType>
+class BisectionEigenSolver {
+public:
+    using Scalar = typename EigenMatrixType::Scalar;
+    using RealType = detail::UnderlyingRealType_t<Scalar>;
+    using RealVector = Eigen::Vector<RealType, Eigen::Dynamic>;
+    using RealMatrix = Eigen::Matrix<RealType, Eigen::Dynamic, Eigen::Dynamic>;
+    using EigenvectorMatrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+
+private:
+    Eigen::Index _n_eigenpairs{};
+    RealType _lower{-std::numeric_limits<RealType>::infinity()};
+    RealType _upper{std::numeric_limits<RealType>::infinity()};
+
+    RealVector _eigenvalues;
+    EigenvectorMatrix _eigenvectors;
+
+    BisectionEigenSolver(Eigen::Index n_eigenpairs, RealType lower, RealType upper)
+        : _n_eigenpairs(n_eigenpairs), _lower(lower), _upper(upper){};
+
+public:
+    /** Number of inverse iteration steps per eigenvector. */
+    int n_inverse_iterations{3};
+
+    /**
+     * @brief Solver for the @p n_eigenpairs lowest eigenpairs.
+     */
+    static BisectionEigenSolver lowest(Eigen::Index n_eigenpairs) {
+        return BisectionEigenSolver(n_eigenpairs, -std::numeric_limits<RealType>::infinity(),
+                                    std::numeric_limits<RealType>::infinity());
+    }
+
+    /**
+     * @brief Solver for all eigenpairs with eigenvalues in [lower, upper).
+     */
+    static BisectionEigenSolver window(RealType lower, RealType upper) {
+        return BisectionEigenSolver(std::numeric_limits<Eigen::Index>::max(), lower, upper);
+    }
+
+    /**
+     * @brief Compute the requested eigenpairs of the Hermitian @p matrix; only its lower triangle is read.
+     */
+    void compute(const EigenMatrixType& matrix) {
+        const Eigen::Index n = matrix.rows();
+        if (n == 0) {
+            _eigenvalues.resize(0);
+            _eigenvectors.resize(0, 0);
+            return;
+        }
+        const Eigen::Tridiagonalization<EigenvectorMatrix> tridiagonalization(matrix);
+        const RealVector diagonal = tridiagonalization.diagonal();
+        const RealVector off_diagonal = tridiagonalization.subDiagonal();
+        detail::SymmetricTridiagonal<RealType> tridiagonal;
+        tridiagonal.reset(diagonal.data(), off_diagonal.data(), n);
+
+        const Eigen::Index first = std::isfinite(_lower) ? tridiagonal.count_below(_lower) : 0;
+        const Eigen::Index last =
+            std::min(first + std::min(_n_eigenpairs, n), std::isfinite(_upper) ? tridiagonal.count_below(_upper) : n);
+        const Eigen::Index n_found = std::max<Eigen::Index>(last - first, 0);
+
+        _eigenvalues.resize(n_found);
+        for (Eigen::Index j = 0; j < n_found; ++j) {
+            _eigenvalues(j) = tridiagonal.bisect(first + j);
+        }
+
+        const RealMatrix tridiagonal_vectors = inverse_iteration(tridiagonal);
+        _eigenvectors = tridiagonalization.matrixQ() * tridiagonal_vectors.template cast<Scalar>();
+    }
+
+    /**
+     * @brief Computed eigenvalues in ascending order.
+     */
+    inline const RealVector& eigenvalues() const noexcept { return _eigenvalues; }
+    /**
+     * @brief Eigenvectors belonging to eigenvalues(), one per column.
+     */
+    inline const EigenvectorMatrix& eigenvectors() const noexcept { return _eigenvectors; }
+
+private:
+    /**
+     * @brief Eigenvectors of the tridiagonal matrix for the computed eigenvalues.
+     *
+     * Vectors of a cluster of close eigenvalues are orthogonalized against the previous vectors of their cluster
+     * in every step, see detail::SymmetricTridiagonal::cluster_gap().
+     */
+    RealMatrix inverse_iteration(detail::SymmetricTridiagonal<RealType>& tridiagonal) const {
+        RealMatrix vectors(tridiagonal.size(), _eigenvalues.size());
+        std::mt19937_64 generator(0U);
+        std::uniform_real_distribution<RealType> distribution(-1, 1);
+        Eigen::Index cluster_begin{};
+        for (Eigen::Index j = 0; j < _eigenvalues.size(); ++j) {
+            if (j > 0 && _eigenvalues(j) - _eigenvalues(j - 1) > tridiagonal.cluster_gap())
+                cluster_begin = j;
+
+            RealVector z = RealVector::NullaryExpr(tridiagonal.size(), [&]() { return distribution(generator); });
+            tridiagonal.inverse_iteration(_eigenvalues(j), n_inverse_iterations, z, [&](RealVector& iterate) {
+                for (int pass = 0; pass < 2; ++pass) {
+                    for (Eigen::Index k = cluster_begin; k < j; ++k) {
+                        iterate -= vectors.col(k).dot(iterate) * vectors.col(k);
+                    }
+                }
+            });
+            vectors.col(j) = z;
+        }
+        return vectors;
+    }
+};
+}  // namespace mrock::iEoM
+#endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_BISECTIONEIGENSOLVER_HPP
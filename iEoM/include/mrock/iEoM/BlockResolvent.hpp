@@ -0,0 +1,299 @@
+#ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_BLOCKRESOLVENT_HPP
+#define MROCK_IEOM_INCLUDE_MROCK_IEOM_BLOCKRESOLVENT_HPP
+
+#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
+#ifndef _OPENMP
+#define MROCK_IEOM_DO_NOT_PARALLELIZE
+#else
+#include <omp.h>
+#endif  // ifndef _OPENMP
+#endif  // ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
+
+#include "Resolvent.hpp"
+#include "ResolventDataTypes.hpp"
+#include "detail/KrylovBasis.hpp"
+#include "detail/UnderlyingRealType.hpp"
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mrock::iEoM {
+/**
+ * @brief Block tridiagonal matrix produced by the block Lanczos algorithm.
+ *
+ * The projected operator reads
+ *      T = [ A_0  B_1^+             ]
+ *          [ B_1  A_1   B_2^+       ]
+ *          [      B_2   A_2   ...   ]
+ * and the starting states S are represented in the first block as S = Q_0 R_0.
+ *
+ * @tparam Scalar Scalar type of the blocks.
+ */
+template <class Scalar>
+struct BlockTridiagonalData {
+    using BlockMatrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+
+    std::vector<BlockMatrix> A;
+    std::vector<BlockMatrix> B;
+    BlockMatrix R_0;
+
+    /**
+     * @brief Number of starting states, i.e., the block size.
+     */
+    inline Eigen::Index block_size() const noexcept { return R_0.cols(); }
+    /**
+     * @brief Number of block Lanczos steps that have been performed.
+     */
+    inline Eigen::Index n_steps() const noexcept { return static_cast<Eigen::Index>(A.size()); }
+
+    /**
+     * @brief Assemble the dense (block_size * n_steps)-dimensional projected operator T.
+     */
+    BlockMatrix construct_matrix() const {
+        const Eigen::Index p = block_size();
+        BlockMatrix T = BlockMatrix::Zero(p * n_steps(), p * n_steps());
+        for (Eigen::Index j = 0; j < n_steps(); ++j) {
+            T.block(j * p, j * p, p, p) = A[j];
+            if (j > 0) {
+                T.block(j * p, (j - 1) * p, p, p) = B[j - 1];
+                T.block((j - 1) * p, j * p, p, p) = B[j - 1].adjoint();
+            }
+        }
+        return T;
+    }
+};
+
+/**
+ * @brief Block Lanczos engine advancing several starting states at once.
+ *
+ * Each iteration multiplies the operator with the whole block of p Krylov vectors (one GEMM)
+ * instead of performing p separate matrix-vector products. This turns the bandwidth-bound
+ * loop over starting states into a compute-bound one.
+ * The resulting block tridiagonal matrix is much smaller than the operator. The scalar
+ * continued-fraction coefficients of each starting state (or of a combination of starting states)
+ * are obtained by a scalar Lanczos run on this small matrix. As m block steps match the
+ * moments <s_i|H^k|s_j> up to k = 2m-1, the first m coefficients coincide with those of
+ * a scalar Lanczos run on the full operator.
+ *
+ * @tparam EigenMatrixType Matrix type used for the Hermitian operator; must be square.
+ * @tparam EigenVectorType Vector type used for the starting states.
+ */
+template <class EigenMatrixType, class EigenVectorType>
+class BlockResolvent {
+private:
+    using Scalar = typename EigenVectorType::Scalar;
+    using RealType = detail::UnderlyingRealType_t<Scalar>;
+    using BlockMatrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+    using SmallVector = Eigen::Vector<Scalar, Eigen::Dynamic>;
+
+    /**
+     * @brief Thin QR factorization of a block against the current basis.
+     *
+     * The columns of @p block are orthonormalized one after another with two passes of
+     * classical Gram-Schmidt. Columns that are (numerically) linearly dependent on the previous
+     * ones are replaced by random vectors orthogonal to the whole basis and get a zero diagonal
+     * entry in R. Thereby, the block size stays constant while the Krylov space of the
+     * starting states is unaffected.
+     *
+     * @param block Block to factorize; overwritten by its orthonormal factor.
+     * @param basis Current Krylov basis; the orthonormal columns are appended to it.
+     * @return The upper triangular factor R.
+     */
+    static BlockMatrix orthonormalize_block(BlockMatrix& block, detail::KrylovBasis<EigenVectorType>& basis) {
+        const Eigen::Index p = block.cols();
+        BlockMatrix R = BlockMatrix::Zero(p, p);
+        const Eigen::Index basis_begin = basis.size();
+
+        for (Eigen::Index c = 0; c < p; ++c) {
+            auto column = block.col(c);
+            const RealType original_norm = column.norm();
+            const auto new_vectors = basis.active().middleCols(basis_begin, c);
+            for (int pass = 0; pass < 2; ++pass) {
+                const SmallVector projection = new_vectors.adjoint() * column;
+                column.noalias() -= new_vectors * projection;
+                R.col(c).head(c) += projection;
+            }
+            const RealType norm = column.norm();
+            if (norm > deflation_tolerance * std::max(RealType{1}, original_norm)) {
+                R(c, c) = norm;
+                column /= norm;
+            } else {
+                // Deflation: keep the block size constant with a random direction that does not couple
+                // The generator is local and seeded by the basis size, so that the results are reproducible
+                // and concurrent runs do not share a state
+                std::mt19937_64 generator(static_cast<std::uint64_t>(basis.size()));
+                std::uniform_real_distribution<RealType> distribution(-1, 1);
+                column = EigenVectorType::NullaryExpr(block.rows(), [&]() { return Scalar(distribution(generator)); });
+                basis.orthogonalize(column);
+                basis.orthogonalize(column);
+                column.normalize();
+            }
+            basis.push_back(column);
+        }
+        return R;
+    }
+
+public:
+    /** Relative tolerance below which a new Krylov direction is considered linearly dependent. */
+    static constexpr RealType deflation_tolerance = 1e-10;
+
+    /** Starting states, one per column. */
+    BlockMatrix startingStates;
+    /** Names of the starting states; used to name the extracted continued fractions. */
+    std::vector<std::string> names;
+    /** Extracted continued-fraction coefficients, one wrapper per starting state (and per cross term). */
+    std::vector<ResolventDataWrapper<RealType>> data;
+    /** Block tridiagonal representation of the operator in the block Krylov space. */
+    BlockTridiagonalData<Scalar> block_tridiagonal;
+
+    BlockResolvent() = default;
+    /**
+     * @brief Construct from a list of starting states.
+     *
+     * @param states Starting states; all must have the same size.
+     * @param _names Optional names of the starting states.
+     */
+    BlockResolvent(const std::vector<EigenVectorType>& states, const std::vector<std::string>& _names = {})
+        : names(_names) {
+        set_starting_states(states);
+    };
+
+    /**
+     * @brief Set the starting states for the block iteration.
+     *
+     * @param states Starting states; all must have the same size.
+     */
+    void set_starting_states(const std::vector<EigenVectorType>& states) {
+        startingStates.resize(states.empty() ? 0 : states.front().size(), states.size());
+        for (std::size_t i = 0U; i < states.size(); ++i) {
+            startingStates.col(i) = states[i];
+        }
+        names.resize(states.size());
+    }
+
+    /**
+     * @brief Run block Lanczos with full reorthogonalization and extract continued fractions.
+     *
+     * @param toSolve Hermitian operator matrix.
+     * @param maxIter Maximum number of block iterations, i.e., continued-fraction depth per state.
+     * @param cross_terms If true, additionally extracts the continued fractions of 0.5 * (s_i + s_j)
+     *                    for all pairs i < j, from which the off-diagonal Green's functions follow as
+     *                    G_ij = 2 G_{0.5(i+j)} - (G_ii + G_jj) / 2.
+     */
+    void compute_with_reorthogonalization(const EigenMatrixType& toSolve, int maxIter, bool cross_terms = false) {
+        const Eigen::Index matrix_size = toSolve.rows();
+        const Eigen::Index p = startingStates.cols();
+        if (toSolve.rows() != toSolve.cols()) {
+            std::cerr << "Matrix is not square!" << std::endl;
+            throw;
+        }
+        if (p == 0) {
+            return;
+        }
+        maxIter = std::min(maxIter, static_cast<int>(matrix_size / p));
+
+        detail::KrylovBasis<EigenVectorType> basis(matrix_size, p * (maxIter + 1));
+        block_tridiagonal = BlockTridiagonalData<Scalar>{};
+        block_tridiagonal.A.reserve(maxIter);
+        block_tridiagonal.B.reserve(maxIter);
+
+        BlockMatrix W = startingStates;
+        block_tridiagonal.R_0 = orthonormalize_block(W, basis);
+
+        for (int j = 0; j < maxIter; ++j) {
+            // One GEMM with the operator for all p Krylov vectors
+            W.noalias() = toSolve * basis.block(j, p);
+            BlockMatrix A_j = basis.block(j, p).adjoint() * W;
+            // A_j is Hermitian in exact arithmetic
+            A_j = (0.5 * (A_j + A_j.adjoint())).eval();
+            W.noalias() -= basis.block(j, p) * A_j;
+            if (j > 0) {
+                W.noalias() -= basis.block(j - 1, p) * block_tridiagonal.B.back().adjoint();
+            }
+            block_tridiagonal.A.push_back(std::move(A_j));
+
+            if (j + 1 == maxIter) {
+                break;
+            }
+            basis.orthogonalize_block(W);
+            block_tridiagonal.B.push_back(orthonormalize_block(W, basis));
+            if (block_tridiagonal.B.back().norm() < 1e-10) {
+                // Invariant subspace
+                block_tridiagonal.B.pop_back();
+                break;
+            }
+        }
+        extract_continued_fractions(maxIter, cross_terms);
+    }
+
+    /**
+     * @brief Continued-fraction coefficients of an arbitrary combination of the starting states.
+     *
+     * @param combination Coefficients c of the state sum_i c_i s_i.
+     * @param maxIter Maximum continued-fraction depth.
+     * @param name Name of the returned data wrapper.
+     * @return Wrapper holding one set of continued-fraction coefficients.
+     */
+    ResolventDataWrapper<RealType> extract(const SmallVector& combination,
+                                           int maxIter,
+                                           const std::string& name = "") const {
+        return extract(block_tridiagonal.construct_matrix(), combination, maxIter, name);
+    }
+
+    /**
+     * @brief Get the extracted resolvent data.
+     *
+     * @return The per-state wrappers followed by the cross-term wrappers, if requested.
+     */
+    const std::vector<ResolventDataWrapper<RealType>>& get_data() const { return data; }
+
+private:
+    ResolventDataWrapper<RealType> extract(const BlockMatrix& T,
+                                           const SmallVector& combination,
+                                           int maxIter,
+                                           const std::string& name) const {
+        SmallVector projected_state = SmallVector::Zero(T.rows());
+        projected_state.head(block_tridiagonal.block_size()) = block_tridiagonal.R_0 * combination;
+
+        Resolvent<BlockMatrix, SmallVector> scalar_resolvent(projected_state, name);
+        scalar_resolvent.compute_with_reorthogonalization(T, maxIter);
+        return scalar_resolvent.get_data();
+    }
+
+    void extract_continued_fractions(int maxIter, bool cross_terms) {
+        const Eigen::Index p = startingStates.cols();
+        std::vector<std::pair<Eigen::Index, Eigen::Index>> combinations;
+        for (Eigen::Index i = 0; i < p; ++i) {
+            combinations.emplace_back(i, i);
+        }
+        if (cross_terms) {
+            for (Eigen::Index i = 0; i < p; ++i) {
+                for (Eigen::Index j = i + 1; j < p; ++j) {
+                    combinations.emplace_back(i, j);
+                }
+            }
+        }
+
+        const BlockMatrix T = block_tridiagonal.construct_matrix();
+        data.resize(combinations.size());
+#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
+#pragma omp parallel for
+#endif
+        for (std::size_t k = 0U; k < combinations.size(); ++k) {
+            const auto [i, j] = combinations[k];
+            SmallVector combination = SmallVector::Zero(p);
+            combination(i) += 0.5;
+            combination(j) += 0.5;
+            data[k] = extract(T, combination, maxIter, i == j ? names[i] : names[i] + "+" + names[j]);
+        }
+    }
+};
+}  // namespace mrock::iEoM
+#endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_BLOCKRESOLVENT_HPP
@@ -1,8 +1,13 @@
 #ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_GENERALRESOLVENT_HPP
 #define MROCK_IEOM_INCLUDE_MROCK_IEOM_GENERALRESOLVENT_HPP
 
+#include <algorithm>
 #include <chrono>
+#include <limits>
+#include <numeric>
+#include <optional>
 #include <string>
+#include <utility>
 
 #ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
 #ifndef _OPENMP
@@ -13,6 +18,7 @@
 #endif  // ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
 
 #include "Resolvent.hpp"
+#include "detail/Hermiticity.hpp"
 #include "detail/PivotToBlockStructure.hpp"
 #include "detail/UnderlyingRealType.hpp"
 #include "detail/constexpr_power.hpp"
@@ -121,6 +127,165 @@ public:
      */
     template <int CheckHermitian = -1>
     std::vector<ResolventDataWrapper<RealType>> compute_collective_modes(unsigned int LANCZOS_ITERATION_NUMBER) {
+        const PreparedResolvents prepared = prepare_resolvents<CheckHermitian>();
+        std::chrono::time_point begin = std::chrono::steady_clock::now();
+
+        const int N_RESOLVENTS = prepared.starting_states.size();
+        std::vector<ResolventType> resolvents(N_RESOLVENTS);
+#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
+#pragma omp parallel for
+#endif
+        for (int i = 0; i < N_RESOLVENTS; i++) {
+            resolvents[i].data.name = prepared.names[i];
+            resolvents[i].set_starting_state(prepared.starting_states[i]);
+            resolvents[i].compute(prepared.M_blocked, LANCZOS_ITERATION_NUMBER);
+        }
+
+        std::chrono::time_point end = std::chrono::steady_clock::now();
+        std::cout << "Time for resolventes: "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << "[ms]" << std::endl;
+
+        std::vector<ResolventDataWrapper<RealType>> ret;
+        ret.reserve(resolvents.size());
+        for (const auto& re : resolvents) {
+            ret.push_back(re.get_data());
+        }
+        return ret;
+    }
+
+    /**
+     * @brief Same as compute_collective_modes(), but with one independent resolvent per block.
+     *
+     * After pivoting, the adjusted dynamical matrix is block diagonal, so each Green's function is the sum of the
+     * Green's functions of the blocks, each with the projection of the starting state onto that block.
+     * Blocks that a starting state does not touch are skipped. Blocks with at most @p exact_block_size rows are
+     * diagonalized once and contribute their exact poles and weights; all other blocks run a Lanczos iteration
+     * of their own dimension. The (starting state, block) pairs are scheduled dynamically, largest blocks first.
+     * Compared to compute_collective_modes(), an iteration costs O(b^2) for a block of size b instead of O(n^2).
+     *
+     * @tparam CheckHermitian If positive, enforces Hermiticity checks on M and N.
+     * @param LANCZOS_ITERATION_NUMBER Maximal number of Lanczos iterations per block.
+     * @param exact_block_size Largest block that is diagonalized; defaults to LANCZOS_ITERATION_NUMBER,
+     *                         for which the Lanczos iteration would not truncate the block either.
+     * @return One BlockwiseResolventData per starting state, in the order of compute_collective_modes();
+     *         each Lanczos result and each pole carries the index of its block.
+     */
+    template <int CheckHermitian = -1>
+    std::vector<BlockwiseResolventData<RealType>>
+    compute_collective_modes_per_block(unsigned int LANCZOS_ITERATION_NUMBER,
+                                       std::optional<Eigen::Index> exact_block_size = std::nullopt) {
+        const PreparedResolvents prepared = prepare_resolvents<CheckHermitian>();
+        std::chrono::time_point begin = std::chrono::steady_clock::now();
+
+        const BlockedMatrix& M_blocked = prepared.M_blocked;
+        const int N_BLOCKS = M_blocked.blocks.size();
+        const int N_RESOLVENTS = prepared.starting_states.size();
+        const Eigen::Index max_exact_size = exact_block_size.value_or(LANCZOS_ITERATION_NUMBER);
+        const auto is_exact = [&](int b) { return M_blocked.blocks[b].rows() <= max_exact_size; };
+        const auto touches = [&](int s, int b) {
+            const auto& state = prepared.starting_states[s];
+            return state.segment(M_blocked.blocks_begin[b], M_blocked.blocks[b].rows()).squaredNorm() >
+                   std::numeric_limits<RealType>::epsilon() * state.squaredNorm();
+        };
+
+        // Only blocks touched by some starting state are diagonalized
+        std::vector<Eigen::SelfAdjointEigenSolver<Matrix>> exact_solutions(N_BLOCKS);
+#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (int b = 0; b < N_BLOCKS; b++) {
+            if (!is_exact(b))
+                continue;
+            for (int s = 0; s < N_RESOLVENTS; s++) {
+                if (touches(s, b)) {
+                    exact_solutions[b].compute(M_blocked.blocks[b]);
+                    break;
+                }
+            }
+        }
+
+        // Ordered by starting state and then by block, which fixes the order of BlockwiseResolventData::lanczos
+        std::vector<std::pair<int, int>> lanczos_tasks;
+        for (int s = 0; s < N_RESOLVENTS; s++) {
+            for (int b = 0; b < N_BLOCKS; b++) {
+                if (!is_exact(b) && touches(s, b))
+                    lanczos_tasks.emplace_back(s, b);
+            }
+        }
+        // Largest blocks first, so that the dynamic schedule ends with the cheap ones
+        std::vector<std::size_t> schedule(lanczos_tasks.size());
+        std::iota(schedule.begin(), schedule.end(), std::size_t{});
+        std::stable_sort(schedule.begin(), schedule.end(), [&](std::size_t lhs, std::size_t rhs) {
+            return M_blocked.blocks[lanczos_tasks[lhs].second].rows() >
+                   M_blocked.blocks[lanczos_tasks[rhs].second].rows();
+        });
+
+        const int N_TASKS = lanczos_tasks.size();
+        std::vector<ResolventData<RealType>> task_results(N_TASKS);
+#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (int t = 0; t < N_TASKS; t++) {
+            const auto [s, b] = lanczos_tasks[schedule[t]];
+            const auto block = M_blocked.blocks[b];
+            Resolvent<Matrix, ComplexVector> resolvent;
+            resolvent.set_starting_state(prepared.starting_states[s].segment(M_blocked.blocks_begin[b], block.rows()));
+            const auto apply_block = [&block](Eigen::Ref<const ComplexVector> in, Eigen::Ref<ComplexVector> out) {
+                out.noalias() = block * in;
+            };
+            resolvent.compute(make_operator(block.rows(), apply_block), LANCZOS_ITERATION_NUMBER);
+            task_results[schedule[t]] = resolvent.get_data().lanczos.front();
+        }
+
+        std::vector<BlockwiseResolventData<RealType>> ret(N_RESOLVENTS);
+        for (int t = 0; t < N_TASKS; t++) {
+            const auto [s, b] = lanczos_tasks[t];
+            ret[s].lanczos.push_back(std::move(task_results[t]));
+            ret[s].lanczos_blocks.push_back(b);
+        }
+#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
+#pragma omp parallel for
+#endif
+        for (int s = 0; s < N_RESOLVENTS; s++) {
+            ret[s].name = prepared.names[s];
+            for (int b = 0; b < N_BLOCKS; b++) {
+                if (!is_exact(b) || !touches(s, b))
+                    continue;
+                const Eigen::Vector<RealType, Eigen::Dynamic> weights =
+                    (exact_solutions[b].eigenvectors().adjoint() *
+                     prepared.starting_states[s].segment(M_blocked.blocks_begin[b], M_blocked.blocks[b].rows()))
+                        .cwiseAbs2();
+                ret[s].poles.insert(ret[s].poles.end(), exact_solutions[b].eigenvalues().begin(),
+                                    exact_solutions[b].eigenvalues().end());
+                ret[s].weights.insert(ret[s].weights.end(), weights.begin(), weights.end());
+                ret[s].pole_blocks.insert(ret[s].pole_blocks.end(), weights.size(), b);
+            }
+        }
+
+        std::chrono::time_point end = std::chrono::steady_clock::now();
+        std::cout << "Time for resolventes: "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << "[ms]" << std::endl;
+        return ret;
+    }
+
+private:
+    using ComplexVector = Eigen::Vector<std::complex<RealType>, Eigen::Dynamic>;
+
+    /**
+     * @brief Adjusted dynamical matrix and Lanczos starting states, both in the pivoted basis.
+     */
+    struct PreparedResolvents {
+        BlockedMatrix M_blocked;
+        /** |a>, (|a> + |b>) / 2 and (|a> + i|b>) / 2 for each of the user's starting states. */
+        std::vector<ComplexVector> starting_states;
+        std::vector<std::string> names;
+    };
+
+    /**
+     * @brief Fills M and N, pivots them into block structure and adjusts M by the norm matrix.
+     */
+    template <int CheckHermitian>
+    PreparedResolvents prepare_resolvents() {
         using __matrix_wrapper__ = detail::blocked_matrix_wrapper<NumberType>;
         std::chrono::time_point begin = std::chrono::steady_clock::now();
         std::chrono::time_point end = std::chrono::steady_clock::now();
@@ -129,10 +294,10 @@ public:
         create_starting_states();
 
         if constexpr (CheckHermitian > 0) {
-            if ((M - M.adjoint()).norm() > detail::constexpr_power<-CheckHermitian, RealType, RealType>(10.)) {
+            if (!detail::is_hermitian(M, detail::constexpr_power<-CheckHermitian, RealType, RealType>(10.))) {
                 throw std::runtime_error("M is not Hermitian!");
             }
-            if ((N - N.adjoint()).norm() > detail::constexpr_power<-CheckHermitian, RealType, RealType>(10.)) {
+            if (!detail::is_hermitian(N, detail::constexpr_power<-CheckHermitian, RealType, RealType>(10.))) {
                 throw std::runtime_error("N is not Hermitian!");
             }
         }
@@ -142,10 +307,12 @@ public:
                   << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << "[ms]" << std::endl;
         begin = std::chrono::steady_clock::now();
 
-        const auto pivot = detail::pivot_to_block_structure(M);
-        M = pivot.transpose() * M * pivot;
-        const std::vector<detail::HermitianBlock> blocks = detail::identify_hermitian_blocks(M);
-        N = pivot.transpose() * N * pivot;
+        // The blocks have to be shared by M and N
+        const detail::BlockStructure structure = detail::find_block_structure(RealType(1e-12), M, N);
+        const auto& pivot = structure.permutation;
+        const std::vector<detail::HermitianBlock>& blocks = structure.blocks;
+        detail::permute_in_place(M, pivot);
+        detail::permute_in_place(N, pivot);
 
         BlockedMatrix M_blocked(M, blocks);
         BlockedMatrix N_blocked(N, blocks);
@@ -163,14 +330,10 @@ public:
                   << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << "[ms]" << std::endl;
         begin = std::chrono::steady_clock::now();
 
-        const auto bufferMatrix = N_blocked * M_solver.eigenvectors;
-        // = N * 1/M * N
+        const auto pseudo_inverse = [this](RealType x) { return abs(x) < this->_internal._precision ? 0 : 1. / x; };
+        // = N * 1/M * N; per block, the chain is fused into one product N V and one rank-k update
         BlockedMatrix n_hacek =
-            bufferMatrix *
-            M_solver.eigenvalues
-                .unaryExpr([this](RealType x) { return abs(x) < this->_internal._precision ? 0 : 1. / x; })
-                .asDiagonal() *
-            bufferMatrix.adjoint();
+            detail::congruence(N_blocked * M_solver.eigenvectors, M_solver.eigenvalues.unaryExpr(pseudo_inverse));
 
         __matrix_wrapper__ norm_solver = __matrix_wrapper__::solve_block_diagonal_matrix(n_hacek);  // , blocks
         this->_internal.template apply_matrix_operation<detail::iEoM_operation::SQRT>(norm_solver.eigenvalues);
@@ -180,36 +343,31 @@ public:
                   << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << "[ms]" << std::endl;
         begin = std::chrono::steady_clock::now();
 
-        // n_hacek -> n_hacek^(-1/2)
-        n_hacek = norm_solver.eigenvectors *
-                  norm_solver.eigenvalues
-                      .unaryExpr([this](RealType x) { return abs(x) < this->_internal._precision ? 0 : 1. / x; })
-                      .asDiagonal() *
-                  norm_solver.eigenvectors.adjoint();
+        // n_hacek -> n_hacek^(-1/2); evaluated into the existing blocks
+        n_hacek.noalias() =
+            detail::congruence(norm_solver.eigenvectors, norm_solver.eigenvalues.unaryExpr(pseudo_inverse));
         // Starting here M is the adjusted solver matrix (M s hackem)
-        // n_hacek * M * n_hacek
-        M_blocked =
-            n_hacek * M_blocked *
-            n_hacek;  // M_solver.eigenvectors * M_solver.eigenvalues.asDiagonal() * M_solver.eigenvectors.adjoint()
+        // n_hacek * M * n_hacek, in place and with one workspace per thread
+        M_blocked = detail::congruence(n_hacek, M_blocked);
         // Starting here N is the extra matrix that defines |a> ((N s hackem) * N)
         N_blocked.applyOnTheLeft(n_hacek);
 
         // Starting here h_hacek is its own inverse (defining |b>)
-        n_hacek = norm_solver.eigenvectors * norm_solver.eigenvalues.asDiagonal() * norm_solver.eigenvectors.adjoint();
+        n_hacek.noalias() = detail::congruence(norm_solver.eigenvectors, norm_solver.eigenvalues);
 
         end = std::chrono::steady_clock::now();
         std::cout << "Time for adjusting of the matrices: "
                   << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << "[ms]" << std::endl;
-        begin = std::chrono::steady_clock::now();
 
         const int N_RESOLVENT_TYPES = starting_states.size();
-        std::vector<ResolventType> resolvents(3 * N_RESOLVENT_TYPES);
-        resolvents.resize(3 * N_RESOLVENT_TYPES);
-        if (N_RESOLVENT_TYPES <= resolvent_names.size()) {
-            for (std::size_t i = 0U; i < N_RESOLVENT_TYPES; ++i) {
-                resolvents[3 * i].data.name = resolvent_names[i] + "_a";
-                resolvents[3 * i + 1].data.name = resolvent_names[i] + "_a+b";
-                resolvents[3 * i + 2].data.name = resolvent_names[i] + "_a+ib";
+        PreparedResolvents prepared;
+        prepared.starting_states.resize(3 * N_RESOLVENT_TYPES);
+        prepared.names.resize(3 * N_RESOLVENT_TYPES);
+        if (starting_states.size() <= resolvent_names.size()) {
+            for (std::size_t i = 0U; i < starting_states.size(); ++i) {
+                prepared.names[3 * i] = resolvent_names[i] + "_a";
+                prepared.names[3 * i + 1] = resolvent_names[i] + "_a+b";
+                prepared.names[3 * i + 2] = resolvent_names[i] + "_a+ib";
             }
         }
 #ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
@@ -219,28 +377,12 @@ public:
             Vector a = N * (pivot.transpose() * starting_states[i]).eval();
             Vector b = n_hacek * (pivot.transpose() * starting_states[i]).eval();
 
-            resolvents[3 * i].set_starting_state(a);
-            resolvents[3 * i + 1].set_starting_state(0.5 * (a + b));
-            resolvents[3 * i + 2].set_starting_state(0.5 * (a + std::complex<RealType>{0, 1} * b));
-        }
-        // M = M_blocked.construct_matrix();
-#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
-#pragma omp parallel for
-#endif
-        for (int i = 0; i < 3 * N_RESOLVENT_TYPES; i++) {
-            resolvents[i].compute(M_blocked, LANCZOS_ITERATION_NUMBER);
+            prepared.starting_states[3 * i] = a;
+            prepared.starting_states[3 * i + 1] = 0.5 * (a + b);
+            prepared.starting_states[3 * i + 2] = 0.5 * (a + std::complex<RealType>{0, 1} * b);
         }
-
-        end = std::chrono::steady_clock::now();
-        std::cout << "Time for resolventes: "
-                  << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << "[ms]" << std::endl;
-
-        std::vector<ResolventDataWrapper<RealType>> ret;
-        ret.reserve(resolvents.size());
-        for (const auto& re : resolvents) {
-            ret.push_back(re.get_data());
-        }
-        return ret;
+        prepared.M_blocked = std::move(M_blocked);
+        return prepared;
     }
 };
 }  // namespace mrock::iEoM
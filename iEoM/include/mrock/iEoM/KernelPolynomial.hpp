@@ -0,0 +1,341 @@
+#ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_KERNELPOLYNOMIAL_HPP
+#define MROCK_IEOM_INCLUDE_MROCK_IEOM_KERNELPOLYNOMIAL_HPP
+#include "LinearOperator.hpp"
+#include "detail/UnderlyingRealType.hpp"
+#include "detail/is_complex.hpp"
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <numbers>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifndef MROCK_IEOM_NO_NLOHMANN_JSON
+#include <nlohmann/json.hpp>
+#endif
+
+namespace mrock::iEoM {
+/**
+ * @brief Damping kernels of the kernel polynomial method.
+ *
+ * see A. Weiße et al., Rev. Mod. Phys. 78, 275 (2006)
+ */
+enum class KPMKernel {
+    /** Optimal for positive spectral functions; delta peaks are broadened to Gaussians of width ~pi / N. */
+    JACKSON,
+    /** Reproduces the resolvent at a finite broadening, i.e., Lorentzian peaks; controlled by lambda. */
+    LORENTZ
+};
+
+/**
+ * @brief Damping factors g_n of a KPM kernel for n = 0, ..., n_moments - 1.
+ *
+ * @param kernel Kernel type.
+ * @param n_moments Number of moments.
+ * @param lorentz_lambda Parameter of the Lorentz kernel; the broadening is lambda / n_moments in rescaled units.
+ */
+template <class RealType>
+std::vector<RealType> kpm_kernel(KPMKernel kernel, int n_moments, RealType lorentz_lambda = 4) {
+    std::vector<RealType> g(n_moments);
+    const RealType N = static_cast<RealType>(n_moments);
+    for (int n = 0; n < n_moments; ++n) {
+        if (kernel == KPMKernel::JACKSON) {
+            const RealType q = std::numbers::pi_v<RealType> / (N + 1);
+            g[n] = ((N - n + 1) * std::cos(q * n) + std::sin(q * n) / std::tan(q)) / (N + 1);
+        } else {
+            g[n] = std::sinh(lorentz_lambda * (1 - n / N)) / std::sinh(lorentz_lambda);
+        }
+    }
+    return g;
+}
+
+/**
+ * @brief Chebyshev moments mu_n = <psi| T_n((H - center) / half_width) |psi> of a starting state.
+ *
+ * The starting state is not normalized, thus mu_0 = <psi|psi> is the total spectral weight,
+ * analogous to b_0 of ResolventData.
+ *
+ * @tparam RealType Numeric type of the moments.
+ */
+template <class RealType>
+struct ChebyshevMoments {
+    std::string name;
+    std::vector<RealType> mu;
+    /** The spectrum is mapped onto [-1, 1] via x = (omega - center) / half_width. */
+    RealType center{};
+    RealType half_width{1};
+
+    /**
+     * @brief Reconstruct the spectral function A(omega) = sum_i |<i|psi>|^2 delta(omega - E_i).
+     *
+     * The result vanishes outside of [center - half_width, center + half_width].
+     * Each point costs O(n_moments).
+     *
+     * @param grid Frequencies at which A is evaluated; arbitrary order and spacing.
+     * @param kernel Damping kernel.
+     * @param lorentz_lambda Parameter of the Lorentz kernel.
+     */
+    std::vector<RealType> spectral_function(const std::vector<RealType>& grid,
+                                            KPMKernel kernel = KPMKernel::JACKSON,
+                                            RealType lorentz_lambda = 4) const {
+        const int n_moments = static_cast<int>(mu.size());
+        const std::vector<RealType> g = kpm_kernel<RealType>(kernel, n_moments, lorentz_lambda);
+        std::vector<RealType> result(grid.size());
+        for (std::size_t k = 0U; k < grid.size(); ++k) {
+            const RealType x = (grid[k] - center) / half_width;
+            if (n_moments == 0 || std::abs(x) >= 1) {
+                continue;
+            }
+            RealType T_previous = 1;
+            RealType T_current = x;
+            RealType value = g[0] * mu[0];
+            for (int n = 1; n < n_moments; ++n) {
+                value += 2 * g[n] * mu[n] * T_current;
+                const RealType T_next = 2 * x * T_current - T_previous;
+                T_previous = T_current;
+                T_current = T_next;
+            }
+            result[k] = value / (std::numbers::pi_v<RealType> * half_width * std::sqrt(1 - x * x));
+        }
+        return result;
+    }
+};
+
+#ifndef MROCK_IEOM_NO_NLOHMANN_JSON
+template <class RealType>
+void to_json(nlohmann::json& j, const ChebyshevMoments<RealType>& moments) {
+    j = nlohmann::json{
+        {"name", moments.name}, {"mu", moments.mu}, {"center", moments.center}, {"half_width", moments.half_width}};
+}
+#endif
+
+/**
+ * @brief Spectral functions via the kernel polynomial method (KPM).
+ *
+ * Alternative to Resolvent for very large operators: the Chebyshev recurrence is numerically stable,
+ * needs no reorthogonalization, and only three vectors per starting state, i.e., O(n) memory and
+ * O(n_moments) operator applications. Several starting states are advanced together, so that dense and
+ * sparse matrices are applied to all of them in a single GEMM/SpMM sweep.
+ * The operator must be Hermitian and its spectrum must lie inside the spectral bounds,
+ * which are set explicitly or estimated with a short Lanczos run.
+ *
+ * @tparam EigenMatrixType Matrix type of the operator; dense or sparse.
+ * @tparam EigenVectorType Vector type of the starting states.
+ */
+template <class EigenMatrixType, class EigenVectorType>
+class KernelPolynomialMethod {
+private:
+    using Scalar = typename EigenVectorType::Scalar;
+    using RealType = detail::UnderlyingRealType_t<Scalar>;
+    using Block = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+    using RealMatrix = Eigen::Matrix<RealType, Eigen::Dynamic, Eigen::Dynamic>;
+    template <class Operator>
+    static constexpr bool is_operator = detail::ResolventOperator<Operator, EigenMatrixType, EigenVectorType>;
+
+    RealType _center{};
+    RealType _half_width{};
+
+    /**
+     * @brief Chebyshev recurrence for all columns of @p states at once.
+     *
+     * Uses mu_(2k) = 2 <T_k|T_k> - mu_0 and mu_(2k+1) = 2 <T_(k+1)|T_k> - mu_1,
+     * so that n_moments moments cost only n_moments / 2 operator applications.
+     *
+     * @return Moments, one column per state.
+     */
+    template <class Operator>
+    RealMatrix chebyshev_moments(const Operator& op, const Block& states, int n_moments) const {
+        if (_half_width <= RealType{}) {
+            std::cerr << "The spectral bounds of the KPM have not been set!" << std::endl;
+            throw;
+        }
+        RealMatrix mu = RealMatrix::Zero(n_moments, states.cols());
+        if (n_moments == 0) {
+            return mu;
+        }
+        Block previous = states;  // |T_(k-1)>
+        Block current(states.rows(), states.cols());
+        Block buffer(states.rows(), states.cols());
+
+        mu.row(0) = previous.colwise().squaredNorm();
+        if (n_moments == 1) {
+            return mu;
+        }
+        // |T_1> = H' |T_0>
+        detail::apply_operator_block<EigenVectorType>(op, previous, buffer);
+        current = (buffer - _center * previous) / _half_width;
+        mu.row(1) = previous.cwiseProduct(current.conjugate()).colwise().sum().real();
+
+        for (int k = 1; 2 * k < n_moments; ++k) {
+            mu.row(2 * k) = 2 * current.colwise().squaredNorm() - mu.row(0);
+            if (2 * k + 1 >= n_moments) {
+                break;
+            }
+            // |T_(k+1)> = 2 H' |T_k> - |T_(k-1)>, stored in previous
+            detail::apply_operator_block<EigenVectorType>(op, current, buffer);
+            previous = (2 / _half_width) * (buffer - _center * current) - previous;
+            mu.row(2 * k + 1) = 2 * previous.cwiseProduct(current.conjugate()).colwise().sum().real() - mu.row(1);
+            previous.swap(current);
+        }
+        return mu;
+    }
+
+    /**
+     * @brief Fill the columns with random vectors satisfying E[|r><r|] = 1.
+     *
+     * Real vectors have random signs, complex vectors random phases; in both cases <r|r> = n exactly.
+     */
+    template <class Generator>
+    static void fill_random(Block& block, Generator& generator) {
+        if constexpr (detail::is_complex_v<Scalar>) {
+            std::uniform_real_distribution<RealType> phase(0, 2 * std::numbers::pi_v<RealType>);
+            block = block.unaryExpr([&](const Scalar&) { return std::polar(RealType{1}, phase(generator)); });
+        } else {
+            std::bernoulli_distribution sign;
+            block = block.unaryExpr([&](const Scalar&) { return sign(generator) ? Scalar{1} : Scalar{-1}; });
+        }
+    }
+
+    ChebyshevMoments<RealType> make_moments(const RealMatrix& mu, Eigen::Index column, std::string name) const {
+        ChebyshevMoments<RealType> moments;
+        moments.name = std::move(name);
+        moments.mu.assign(mu.col(column).data(), mu.col(column).data() + mu.rows());
+        moments.center = _center;
+        moments.half_width = _half_width;
+        return moments;
+    }
+
+public:
+    KernelPolynomialMethod() = default;
+    /**
+     * @brief Construct with known bounds of the spectrum.
+     *
+     * @param lower Lower bound of the spectrum.
+     * @param upper Upper bound of the spectrum.
+     * @param padding Relative safety margin; the spectrum has to lie strictly inside the rescaled interval.
+     */
+    KernelPolynomialMethod(RealType lower, RealType upper, RealType padding = 0.01) {
+        set_spectral_bounds(lower, upper, padding);
+    }
+
+    /**
+     * @brief Set the bounds of the spectrum.
+     *
+     * @param lower Lower bound of the spectrum.
+     * @param upper Upper bound of the spectrum.
+     * @param padding Relative safety margin; the spectrum has to lie strictly inside the rescaled interval.
+     */
+    void set_spectral_bounds(RealType lower, RealType upper, RealType padding = 0.01) {
+        _center = (upper + lower) / 2;
+        _half_width = (upper - lower) / (2 - padding);
+    }
+
+    /**
+     * @brief Estimate the bounds of the spectrum with a short Lanczos run.
+     *
+     * The extremal Ritz values are widened by the norm of the last Lanczos residual,
+     * see Y. Zhou and R.-C. Li, Linear Algebra Appl. 435, 480 (2011).
+     *
+     * @param op Hermitian matrix or LinearOperator.
+     * @param n_lanczos Number of Lanczos iterations.
+     * @param padding Relative safety margin, see set_spectral_bounds().
+     */
+    template <class Operator>
+        requires is_operator<Operator>
+    void estimate_spectral_bounds(const Operator& op, int n_lanczos = 40, RealType padding = 0.01) {
+        const Eigen::Index matrix_size = detail::operator_size<EigenVectorType>(op);
+        n_lanczos = std::min(n_lanczos, static_cast<int>(matrix_size));
+
+        // A start vector without symmetries, so that it overlaps with the extremal eigenvectors
+        EigenVectorType previous = EigenVectorType::Zero(matrix_size);
+        EigenVectorType current =
+            Eigen::Vector<RealType, Eigen::Dynamic>::LinSpaced(matrix_size, 1, 2).normalized().template cast<Scalar>();
+        EigenVectorType buffer(matrix_size);
+        std::vector<RealType> alphas, betas{RealType{}};
+        for (int i = 0; i < n_lanczos; ++i) {
+            detail::apply_operator<EigenVectorType>(op, current, buffer);
+            alphas.push_back(std::real(current.dot(buffer)));
+            buffer -= alphas.back() * current + betas.back() * previous;
+            betas.push_back(buffer.norm());
+            if (betas.back() < 1e-10) {
+                break;
+            }
+            previous.swap(current);
+            current = buffer / betas.back();
+        }
+        const Eigen::Index m = static_cast<Eigen::Index>(alphas.size());
+        using TMap = Eigen::Map<const Eigen::Vector<RealType, Eigen::Dynamic>>;
+        Eigen::SelfAdjointEigenSolver<RealMatrix> solver;
+        solver.computeFromTridiagonal(TMap(alphas.data(), m), TMap(betas.data() + 1, m - 1), Eigen::EigenvaluesOnly);
+        set_spectral_bounds(solver.eigenvalues()(0) - betas.back(), solver.eigenvalues()(m - 1) + betas.back(),
+                            padding);
+    }
+
+    inline RealType center() const noexcept { return _center; }
+    inline RealType half_width() const noexcept { return _half_width; }
+
+    /**
+     * @brief Compute the Chebyshev moments of several starting states in one sweep.
+     *
+     * @param op Hermitian matrix or LinearOperator.
+     * @param starting_states Starting states; not normalized.
+     * @param n_moments Number of moments per state.
+     * @param names Names of the states; optional.
+     * @return Moments of each starting state, in the order of @p starting_states.
+     */
+    template <class Operator>
+        requires is_operator<Operator>
+    std::vector<ChebyshevMoments<RealType>> compute_moments(const Operator& op,
+                                                            const std::vector<EigenVectorType>& starting_states,
+                                                            int n_moments,
+                                                            const std::vector<std::string>& names = {}) const {
+        const Eigen::Index matrix_size = detail::operator_size<EigenVectorType>(op);
+        Block states(matrix_size, static_cast<Eigen::Index>(starting_states.size()));
+        for (std::size_t i = 0U; i < starting_states.size(); ++i) {
+            states.col(i) = starting_states[i];
+        }
+        const RealMatrix mu = chebyshev_moments(op, states, n_moments);
+
+        std::vector<ChebyshevMoments<RealType>> result;
+        result.reserve(starting_states.size());
+        for (std::size_t i = 0U; i < starting_states.size(); ++i) {
+            result.push_back(make_moments(mu, i, i < names.size() ? names[i] : std::string{}));
+        }
+        return result;
+    }
+
+    /**
+     * @brief Estimate the moments of the trace, mu_n = Tr T_n(H'), stochastically.
+     *
+     * The spectral function of the result is the density of states, normalized to the dimension.
+     * The statistical error of mu_n decreases as 1 / sqrt(n_random_vectors * dimension).
+     *
+     * @param op Hermitian matrix or LinearOperator.
+     * @param n_random_vectors Number of random vectors.
+     * @param n_moments Number of moments.
+     * @param seed Seed of the random number generator.
+     * @param batch_size Number of random vectors advanced together; bounds the memory to 3 * batch_size vectors.
+     */
+    template <class Operator>
+        requires is_operator<Operator>
+    ChebyshevMoments<RealType> compute_stochastic_trace(
+        const Operator& op, int n_random_vectors, int n_moments, unsigned int seed = 0U, int batch_size = 16) const {
+        const Eigen::Index matrix_size = detail::operator_size<EigenVectorType>(op);
+        std::mt19937_64 generator(seed);
+        Eigen::Vector<RealType, Eigen::Dynamic> mu = Eigen::Vector<RealType, Eigen::Dynamic>::Zero(n_moments);
+        for (int done = 0; done < n_random_vectors; done += batch_size) {
+            Block states(matrix_size, std::min(batch_size, n_random_vectors - done));
+            fill_random(states, generator);
+            mu += chebyshev_moments(op, states, n_moments).rowwise().sum();
+        }
+        mu /= n_random_vectors;
+        return make_moments(mu, 0, "trace");
+    }
+};
+}  // namespace mrock::iEoM
+#endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_KERNELPOLYNOMIAL_HPP
@@ -0,0 +1,149 @@
+#ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_LINEAROPERATOR_HPP
+#define MROCK_IEOM_INCLUDE_MROCK_IEOM_LINEAROPERATOR_HPP
+#include <Eigen/Core>
+
+#include <concepts>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+
+namespace mrock::iEoM {
+/**
+ * @brief Matrix-free linear operator acting on vectors of type Vector.
+ *
+ * An operator must provide its dimension via rows() and its action via
+ *      void apply(Eigen::Ref<const Vector> in, Eigen::Ref<Vector> out) const;
+ * which has to overwrite @p out with the operator applied to @p in.
+ * The operator is always square. Passing Eigen::Ref allows the Lanczos routines to hand
+ * over columns of their Krylov panels without copies.
+ *
+ * @tparam Operator Operator type.
+ * @tparam Vector Eigen vector type the operator acts on.
+ */
+template <class Operator, class Vector>
+concept LinearOperator = requires(const Operator& op, Eigen::Ref<const Vector> in, Eigen::Ref<Vector> out) {
+    { op.rows() } -> std::convertible_to<Eigen::Index>;
+    op.apply(in, out);
+};
+
+/**
+ * @brief Linear operator defined by a callable.
+ *
+ * @tparam Function Callable with signature void(Eigen::Ref<const Vector> in, Eigen::Ref<Vector> out).
+ */
+template <class Function>
+class FunctionOperator {
+private:
+    Eigen::Index _rows{};
+    Function _function;
+
+public:
+    /**
+     * @brief Construct from the dimension and the action of the operator.
+     *
+     * @param rows Dimension of the (square) operator.
+     * @param function Callable computing out = A in.
+     */
+    FunctionOperator(Eigen::Index rows, Function function) : _rows(rows), _function(std::move(function)){};
+
+    /**
+     * @brief Dimension of the operator.
+     */
+    inline Eigen::Index rows() const noexcept { return _rows; }
+    /**
+     * @brief Dimension of the operator; identical to rows().
+     */
+    inline Eigen::Index cols() const noexcept { return _rows; }
+
+    /**
+     * @brief Apply the operator, out = A in.
+     */
+    template <class In, class Out>
+    inline void apply(const In& in, Out&& out) const {
+        _function(in, std::forward<Out>(out));
+    }
+};
+
+/**
+ * @brief Create a FunctionOperator from a callable.
+ *
+ * Example for a diagonal plus rank-one operator that never materializes the dense matrix:
+ *      auto op = make_operator(n, [&](Eigen::Ref<const Vector> in, Eigen::Ref<Vector> out) {
+ *          out = diagonal.cwiseProduct(in) - coupling * coupling.dot(in);
+ *      });
+ *
+ * @param rows Dimension of the (square) operator.
+ * @param function Callable computing out = A in.
+ * @return The wrapped operator.
+ */
+template <class Function>
+FunctionOperator<std::decay_t<Function>> make_operator(Eigen::Index rows, Function&& function) {
+    return FunctionOperator<std::decay_t<Function>>(rows, std::forward<Function>(function));
+}
+
+namespace detail {
+/**
+ * @brief Operators accepted by Resolvent: a LinearOperator or any Eigen matrix or expression, e.g., `2.0 * A` or
+ * `A.topLeftCorner(n, n)`, whose scalars convert to those of the Resolvent's matrix type.
+ */
+template <class Operator, class EigenMatrixType, class EigenVectorType>
+concept ResolventOperator =
+    LinearOperator<Operator, EigenVectorType> ||
+    (std::derived_from<Operator, Eigen::EigenBase<Operator>> &&
+     std::convertible_to<typename Operator::Scalar, typename EigenMatrixType::Scalar>);
+
+/**
+ * @brief Compute out = op * in for both matrices and matrix-free operators.
+ *
+ * @param op Matrix or LinearOperator.
+ * @param in Input vector.
+ * @param out Output vector; must already have the correct size.
+ */
+template <class EigenVectorType, class Operator, class In, class Out>
+inline void apply_operator(const Operator& op, const In& in, Out& out) {
+    if constexpr (LinearOperator<Operator, EigenVectorType>) {
+        op.apply(Eigen::Ref<const EigenVectorType>(in), Eigen::Ref<EigenVectorType>(out));
+    } else {
+        out.noalias() = op * in;
+    }
+}
+
+/**
+ * @brief Compute out = op * in column by column for both matrices and matrix-free operators.
+ *
+ * Matrices act on the whole block at once, i.e., via a single GEMM (dense) or SpMM (sparse).
+ * Matrix-free operators are applied to each column; the columns are passed without copies.
+ *
+ * @param op Matrix or LinearOperator.
+ * @param in Input block, one vector per column.
+ * @param out Output block; must already have the correct size.
+ */
+template <class EigenVectorType, class Operator, class InBlock, class OutBlock>
+inline void apply_operator_block(const Operator& op, const InBlock& in, OutBlock& out) {
+    if constexpr (LinearOperator<Operator, EigenVectorType>) {
+        for (Eigen::Index c = 0; c < in.cols(); ++c) {
+            op.apply(Eigen::Ref<const EigenVectorType>(in.col(c)), Eigen::Ref<EigenVectorType>(out.col(c)));
+        }
+    } else {
+        out.noalias() = op * in;
+    }
+}
+
+/**
+ * @brief Dimension of a matrix or matrix-free operator.
+ *
+ * Matrices must be square; otherwise, an error is raised.
+ */
+template <class EigenVectorType, class Operator>
+inline Eigen::Index operator_size(const Operator& op) {
+    if constexpr (!LinearOperator<Operator, EigenVectorType>) {
+        if (op.rows() != op.cols()) {
+            std::cerr << "Matrix is not square!" << std::endl;
+            throw;
+        }
+    }
+    return op.rows();
+}
+}  // namespace detail
+}  // namespace mrock::iEoM
+#endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_LINEAROPERATOR_HPP
@@ -0,0 +1,135 @@
+#ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_MEMORYREPORT_HPP
+#define MROCK_IEOM_INCLUDE_MROCK_IEOM_MEMORYREPORT_HPP
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace mrock::iEoM {
+/**
+ * @brief High-water marks of the dense matrices of a computation, per phase.
+ *
+ * The marks count the matrices held by the computation, including the workspaces of the dense eigensolvers
+ * and the Lanczos bases, but not the allocator overhead or the memory of the caller.
+ * Phases may overlap if they run concurrently; each mark then includes the matrices of the other phases.
+ */
+struct MemoryReport {
+    struct Phase {
+        std::string name;
+        std::size_t high_water_bytes{};
+    };
+    /** The phases in the order in which they started. */
+    std::vector<Phase> phases;
+
+    /**
+     * @brief The overall high-water mark.
+     */
+    std::size_t high_water_bytes() const noexcept {
+        std::size_t bytes{};
+        for (const auto& phase : phases) {
+            bytes = std::max(bytes, phase.high_water_bytes);
+        }
+        return bytes;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const MemoryReport& report) {
+        for (const auto& phase : report.phases) {
+            os << phase.name << ": " << static_cast<double>(phase.high_water_bytes) / (1024. * 1024.) << " MiB\n";
+        }
+        os << "Peak: " << static_cast<double>(report.high_water_bytes()) / (1024. * 1024.) << " MiB";
+        return os;
+    }
+};
+
+namespace detail {
+/**
+ * @brief Thread-safe bookkeeping of the bytes held by a computation, see MemoryReport.
+ *
+ * The owner reports every allocation and release of a tracked matrix. Each allocation raises the
+ * high-water marks of all phases that are active at that moment.
+ */
+class MemoryTracker {
+private:
+    mutable std::mutex _mutex;
+    std::size_t _current{};
+    MemoryReport _report;
+    std::vector<std::size_t> _active;
+
+public:
+    MemoryTracker() = default;
+    MemoryTracker(const MemoryTracker& other) {
+        std::lock_guard<std::mutex> lock(other._mutex);
+        _current = other._current;
+        _report = other._report;
+        _active = other._active;
+    }
+    MemoryTracker& operator=(const MemoryTracker& other) {
+        if (this != &other) {
+            std::scoped_lock lock(_mutex, other._mutex);
+            _current = other._current;
+            _report = other._report;
+            _active = other._active;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Bytes occupied by the coefficients of @p matrix.
+     */
+    template <class Derived>
+    static std::size_t bytes(const Eigen::DenseBase<Derived>& matrix) noexcept {
+        return static_cast<std::size_t>(matrix.size()) * sizeof(typename Derived::Scalar);
+    }
+
+    /**
+     * @brief Forget all phases and start counting from zero.
+     */
+    void reset() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _current = 0U;
+        _report.phases.clear();
+        _active.clear();
+    }
+
+    /**
+     * @brief Starts a phase; its high-water mark starts at the currently held bytes.
+     *
+     * @return The handle to pass to end_phase().
+     */
+    std::size_t begin_phase(std::string name) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _report.phases.push_back({std::move(name), _current});
+        _active.push_back(_report.phases.size() - 1U);
+        return _report.phases.size() - 1U;
+    }
+
+    void end_phase(std::size_t phase) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::erase(_active, phase);
+    }
+
+    void allocate(std::size_t bytes) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _current += bytes;
+        for (const std::size_t phase : _active) {
+            _report.phases[phase].high_water_bytes = std::max(_report.phases[phase].high_water_bytes, _current);
+        }
+    }
+
+    void release(std::size_t bytes) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _current -= std::min(bytes, _current);
+    }
+
+    MemoryReport report() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _report;
+    }
+};
+}  // namespace detail
+}  // namespace mrock::iEoM
+#endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_MEMORYREPORT_HPP
@@ -3,26 +3,52 @@
 // Use (void) to silence unused warnings.
 #define assertm(exp, msg) assert(((void)msg, exp))
 
+#include "LinearOperator.hpp"
 #include "ResolventDataTypes.hpp"
+#include "TerminationCriterion.hpp"
 #include "detail/GramSchmidt.hpp"
+#include "detail/KrylovBasis.hpp"
+#include "detail/LowerPrecision.hpp"
+#include "detail/OmegaRecurrence.hpp"
+#include "detail/RitzTracker.hpp"
 #include "detail/UnderlyingRealType.hpp"
 #include "detail/is_complex.hpp"
 
 #include <Eigen/Dense>
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <type_traits>
+#include <utility>
 
 namespace mrock::iEoM {
 using std::abs;
 
+/**
+ * @brief Reorthogonalization strategy of the Lanczos iteration.
+ */
+enum class Reorthogonalization {
+    /** Reorthogonalize every new Lanczos vector against the whole basis. */
+    FULL,
+    /**
+     * Estimate the loss of orthogonality with the omega recurrence and reorthogonalize only
+     * if it exceeds sqrt(eps), and only against the affected basis vectors (semi-orthogonality).
+     */
+    PARTIAL
+};
+
 /**
  * @brief Performs Lanczos-based resolvent computations for linear operators.
  *
  * This class builds recurrence coefficients for continued fraction resolvent
  * representations. It supports Hermitian and symplectic problems and can
  * store residual information for low-lying eigenvalues when requested.
+ * EigenMatrixType may be dense or sparse (Eigen::SparseMatrix), in which case each iteration costs O(nnz).
+ * Besides matrices of type EigenMatrixType, all compute methods accept matrix-free operators
+ * satisfying the LinearOperator concept, e.g., created with make_operator(). Then, the operator
+ * is never materialized and only its action on a vector is required.
  *
  * @tparam EigenMatrixType Matrix type used for the operator; must be square.
  * @tparam EigenVectorType Vector type used for the starting state and Krylov basis.
@@ -34,84 +60,147 @@ private:
     using ComputationType = typename EigenMatrixType::Scalar;
     using resolvent_data = ResolventData<RealType>;
     static constexpr bool isComplex = detail::is_complex_v<typename EigenVectorType::Scalar>;
+    template <class Operator>
+    static constexpr bool is_operator = detail::ResolventOperator<Operator, EigenMatrixType, EigenVectorType>;
+    // Storage types of the mixed-precision mode
+    using LowScalar = detail::LowerPrecision_t<typename EigenVectorType::Scalar>;
+    using LowRealType = detail::UnderlyingRealType_t<LowScalar>;
+    using LowVectorType = Eigen::Vector<LowScalar, Eigen::Dynamic>;
+    template <class Operator>
+    static constexpr bool is_low_precision_operator =
+        LinearOperator<Operator, LowVectorType> ||
+        (std::derived_from<Operator, Eigen::EigenBase<Operator>> && std::same_as<typename Operator::Scalar, LowScalar>);
 
-public:
-    /** Starting state vector used to generate the Lanczos basis. */
-    EigenVectorType startingState;
-    /** Computed resolvent data including recurrence coefficients and residual information. */
-    ResolventDataWrapper<RealType> data;
-    /**
-     * @brief Set the starting state used for the resolvent iteration.
-     *
-     * @param state New starting state vector.
-     */
-    inline void set_starting_state(const EigenVectorType& state) { this->startingState = state; };
     /**
-     * @brief Get the current starting state.
+     * @brief Update the residual estimates of the lowest Ritz pairs of the current tridiagonal matrix.
      *
-     * @return Const reference to the starting state vector.
-     */
-    const EigenVectorType& getStartingState() const { return this->startingState; }
-    /**
-     * @brief Construct with a starting state and optional name.
+     * Ritz values that coincide with an already stored eigenvalue are Lanczos ghosts and are skipped.
+     * see https://epubs.siam.org/doi/book/10.1137/1.9780898719581, chapter 4.4, eq. 4.13
      *
-     * @param _StargingState Initial Krylov vector for the resolvent iteration.
-     * @param name Optional name stored in the result wrapper.
+     * @param ritz_tracker Tracker of the lowest Ritz pairs, updated to the current tridiagonal matrix.
+     * @param tolerance Residual below which a Ritz pair is converged.
+     * @param last_beta Norm of the most recent Lanczos residual.
+     * @param iterNum Current number of Lanczos iterations, i.e., the size of the tridiagonal matrix.
+     * @param maxIter Maximum number of Lanczos iterations; at the last iteration, all values are stored.
+     * @param residual_info Residual information to be updated.
+     * @param newly_converged Filled with the (residual index, Ritz index) pairs that converged in this check.
+     * @return Number of residuals that converged in this check.
      */
-    Resolvent(const EigenVectorType& _StargingState, const std::string& name = "")
-        : startingState(_StargingState), data(name){};
+    template <int n_residuals>
+    static int update_residuals(detail::RitzTracker<RealType>& ritz_tracker,
+                                RealType tolerance,
+                                RealType last_beta,
+                                int iterNum,
+                                int maxIter,
+                                ResidualInformation<RealType, n_residuals>& residual_info,
+                                std::array<std::pair<int, int>, n_residuals>& newly_converged) {
+        int skip{};
+        int i_skip{};
+        int n_newly_converged{};
+        for (int i = 0; i < n_residuals; ++i) {
+            if (residual_info.converged[i])
+                continue;
+
+        redo_if_ghost:
+            i_skip = i + skip;  // To avoid Lanczos ghosts
+            if (i_skip >= iterNum)
+                break;
+            residual_info.residuals[i] = last_beta * abs(ritz_tracker.eigenvector(i_skip)(iterNum - 1));
+            if (residual_info.residuals[i] < tolerance || iterNum >= maxIter) {
+                // The tracker sorts the eigenvalues in ascending order
+                for (int c = 0; c < n_residuals; ++c) {  //&& residual_info.converged[c]
+                    if (abs(residual_info.eigenvalues[c] - ritz_tracker.eigenvalue(i_skip)) < 1e-12) {
+                        // Found a Lanczos ghost
+                        ++skip;
+                        goto redo_if_ghost;
+                    }
+                }
+
+                residual_info.converged[i] = residual_info.residuals[i] < tolerance;
+                residual_info.eigenvalues[i] = ritz_tracker.eigenvalue(i_skip);
+                residual_info.n_ghosts[i] = skip;
+
+                // The eigenvector is useless, if the residual is not small
+                // However, the eigenvalue is bounded by lambda_true = lambda_approx +/- residual
+                if (residual_info.converged[i]) {
+                    newly_converged[n_newly_converged++] = {i, i_skip};
+                }
+            }
+            if (!residual_info.converged[i] && iterNum < maxIter)
+                break;  // Fill list form the bottom up
+        }
+        return n_newly_converged;
+    }
+
     /**
-     * @brief Construct with an optional name only.
-     *
-     * @param name Name stored in the result wrapper.
+     * @brief Whether all tracked residuals have converged.
      */
-    Resolvent(const std::string name) : data(name){};
-    Resolvent() = default;
+    template <int n_residuals>
+    static bool all_converged(const ResidualInformation<RealType, n_residuals>& residual_info) {
+        return std::all_of(residual_info.converged.begin(), residual_info.converged.end(), [](bool v) { return v; });
+    }
 
     /**
-     * @brief Compute generalized Lanczos coefficients for a symplectic problem.
+     * @brief Generalized Lanczos iteration in the inner product defined by a positive semidefinite metric S.
      *
-     * @param toSolve Operator matrix to solve.
-     * @param symplectic Symplectic metric matrix; must be positive semidefinite.
+     * Together with every Lanczos vector |q>, its image S|q> is kept. The metric is thus applied
+     * exactly once per iteration, namely to the new unnormalized vector |r>, and S|r> provides its norm
+     * as well as, after normalization, the cached image of the next Lanczos vector.
+     * With metric reorthogonalization, |r> is orthogonalized against all previous vectors in the metric,
+     * and S|r> is updated from the cached images instead of applying S again,
+     * see KrylovBasis::orthogonalize_in_metric().
+     *
+     * @param toSolve Operator matrix or LinearOperator to solve.
+     * @param symplectic Metric matrix or LinearOperator.
      * @param maxIter Maximum Lanczos iterations.
+     * @param metric_reorthogonalization Whether to reorthogonalize in the metric.
+     * @param compute_alpha Callable (|q>, S|q>, H|q>) -> alpha.
      */
-    void compute(const EigenMatrixType& toSolve, const EigenMatrixType& symplectic, int maxIter) {
-        const std::size_t matrix_size = toSolve.rows();
+    template <class Operator, class Metric, class AlphaFunction>
+    void metric_lanczos(const Operator& toSolve,
+                        const Metric& symplectic,
+                        int maxIter,
+                        bool metric_reorthogonalization,
+                        AlphaFunction&& compute_alpha) {
+        const std::size_t matrix_size = detail::operator_size<EigenVectorType>(toSolve);
         maxIter = std::min(maxIter, static_cast<int>(matrix_size));
 
-        if (toSolve.rows() != toSolve.cols()) {
-            std::cerr << "Matrix is not square!" << std::endl;
-            throw;
-        }
-
-        EigenVectorType currentSolution(matrix_size);  // corresponds to |q_(i+1)>
-        // First filling
-        std::vector<EigenVectorType> basis_vectors;
-        EigenVectorType first = EigenVectorType::Zero(matrix_size);  // corresponds to |q_0>
-        EigenVectorType second = this->startingState;                // corresponds to |q_1>
         resolvent_data res;
-        ComputationType norm_buffer = second.dot(symplectic * second);
+        EigenVectorType previous = EigenVectorType::Zero(matrix_size);  // corresponds to |q_(i-1)>
+        EigenVectorType current = this->startingState;                  // corresponds to |q_i>
+        EigenVectorType metric_current(matrix_size);                     // corresponds to S|q_i>
+        detail::apply_operator<EigenVectorType>(symplectic, current, metric_current);
+        ComputationType norm_buffer = current.dot(metric_current);
         if constexpr (isComplex) {
             assertm(abs(norm_buffer.imag()) < 1e-6, "First norm is complex! ");
         }
         res.b_i.push_back(abs(norm_buffer));
-
-        second /= std::sqrt(res.b_i.back());
-        basis_vectors.push_back(first);
-        basis_vectors.push_back(second);
+        const RealType starting_norm = std::sqrt(res.b_i.back());
+        current /= starting_norm;
+        metric_current /= starting_norm;
+
+        detail::KrylovBasis<EigenVectorType> basis_vectors, metric_basis_vectors;
+        if (metric_reorthogonalization) {
+            basis_vectors = detail::KrylovBasis<EigenVectorType>(matrix_size, maxIter + 1);
+            metric_basis_vectors = detail::KrylovBasis<EigenVectorType>(matrix_size, maxIter + 1);
+            basis_vectors.push_back(current);
+            metric_basis_vectors.push_back(metric_current);
+        }
 
         std::vector<RealType> alphas, betas;
         alphas.reserve(maxIter);
-        betas.reserve(maxIter);
+        betas.reserve(maxIter + 1);
 
         betas.push_back(1);
         int iterNum{};
         bool goOn = true;
-        EigenVectorType buffer;
+        detail::TerminationMonitor<RealType> monitor(termination);
+        EigenVectorType buffer(matrix_size);
+        EigenVectorType metric_buffer(matrix_size);
         while (goOn) {
             // algorithm
-            buffer = toSolve * basis_vectors.back();
-            norm_buffer = basis_vectors.back().dot(symplectic * buffer);
+            detail::apply_operator<EigenVectorType>(toSolve, current, buffer);
+            norm_buffer = compute_alpha(current, metric_current, buffer);
             if constexpr (isComplex) {
                 assertm(abs(norm_buffer.imag()) < 1e-6, "First norm in loop is complex!");
                 alphas.push_back(norm_buffer.real());
@@ -119,45 +208,118 @@ public:
                 alphas.push_back(norm_buffer);
             }
 
-            currentSolution =
-                (buffer - (alphas.back() * basis_vectors.back())) - (betas.back() * basis_vectors[iterNum]);
-            norm_buffer = std::sqrt(currentSolution.dot(symplectic * currentSolution));
+            buffer -= alphas.back() * current + betas.back() * previous;
+            detail::apply_operator<EigenVectorType>(symplectic, buffer, metric_buffer);
+            if (metric_reorthogonalization) {
+                basis_vectors.orthogonalize_in_metric(buffer, metric_buffer, metric_basis_vectors);
+            }
+            norm_buffer = std::sqrt(buffer.dot(metric_buffer));
             if constexpr (isComplex) {
                 assertm(abs(norm_buffer.imag()) < 1e-6, "Second norm in loop is complex!");
             }
             betas.push_back(abs(norm_buffer));
-            basis_vectors.push_back(currentSolution / betas.back());
+            previous.swap(current);
+            current = buffer / betas.back();
+            metric_current = metric_buffer / betas.back();
             ++iterNum;
+            if (metric_reorthogonalization && iterNum < maxIter) {
+                basis_vectors.push_back(current);
+                metric_basis_vectors.push_back(metric_current);
+            }
 
             // breaking conditions
-            if (iterNum >= maxIter || abs(betas.back()) < 1e-10) {
+            if (monitor.terminate(iterNum, maxIter, alphas, betas, res.termination_reason)) {
                 goOn = false;
             }
         }
-        for (long i = 0; i < alphas.size(); i++) {
+        for (std::size_t i = 0U; i < alphas.size(); ++i) {
             res.a_i.push_back(alphas[i]);
             res.b_i.push_back(betas[i + 1]);
         }
         data.push_back(std::move(res));
     }
 
+public:
+    /** Starting state vector used to generate the Lanczos basis. */
+    EigenVectorType startingState;
+    /** Computed resolvent data including recurrence coefficients and residual information. */
+    ResolventDataWrapper<RealType> data;
+    /**
+     * @brief Adaptive stopping criterion used by all compute methods.
+     *
+     * Disabled by default, i.e., the iteration runs for maxIter iterations unless the Krylov space is exhausted.
+     * The reason of termination is stored in ResolventData::termination_reason.
+     */
+    TerminationCriterion<RealType> termination;
+    /**
+     * @brief Convergence criterion of the Ritz pairs tracked by compute_with_residuals().
+     */
+    ResidualCriterion<RealType> residual_criterion;
+    /**
+     * @brief Set the starting state used for the resolvent iteration.
+     *
+     * @param state New starting state vector.
+     */
+    inline void set_starting_state(const EigenVectorType& state) { this->startingState = state; };
+    /**
+     * @brief Get the current starting state.
+     *
+     * @return Const reference to the starting state vector.
+     */
+    const EigenVectorType& getStartingState() const { return this->startingState; }
+    /**
+     * @brief Construct with a starting state and optional name.
+     *
+     * @param _StargingState Initial Krylov vector for the resolvent iteration.
+     * @param name Optional name stored in the result wrapper.
+     */
+    Resolvent(const EigenVectorType& _StargingState, const std::string& name = "")
+        : startingState(_StargingState), data(name){};
+    /**
+     * @brief Construct with an optional name only.
+     *
+     * @param name Name stored in the result wrapper.
+     */
+    Resolvent(const std::string name) : data(name){};
+    Resolvent() = default;
+
+    /**
+     * @brief Compute generalized Lanczos coefficients for a symplectic problem.
+     *
+     * The metric is applied exactly once per iteration, see metric_lanczos().
+     *
+     * @param toSolve Operator matrix or LinearOperator to solve.
+     * @param symplectic Symplectic metric matrix or LinearOperator; must be positive semidefinite.
+     * @param maxIter Maximum Lanczos iterations.
+     * @param metric_reorthogonalization Whether to reorthogonalize every new Lanczos vector
+     *                                   in the metric against the whole basis.
+     */
+    template <class Operator, class Metric>
+        requires(is_operator<Operator> && is_operator<Metric>)
+    void compute(const Operator& toSolve,
+                 const Metric& symplectic,
+                 int maxIter,
+                 bool metric_reorthogonalization = false) {
+        // <q|S H|q> = (S|q>)^+ H|q>, as S is Hermitian; this reuses the cached S|q>
+        metric_lanczos(toSolve, symplectic, maxIter, metric_reorthogonalization,
+                       [](const EigenVectorType&, const EigenVectorType& metric_current,
+                          const EigenVectorType& buffer) { return metric_current.dot(buffer); });
+    }
+
     /**
      * @brief Compute Lanczos coefficients for a Hermitian problem.
      *
      * This overload assumes the symplectic metric is the identity matrix.
      *
-     * @param toSolve Operator matrix to solve.
+     * @param toSolve Operator matrix or LinearOperator to solve.
      * @param maxIter Maximum Lanczos iterations.
      */
-    void compute(const EigenMatrixType& toSolve, int maxIter) {
-        const std::size_t matrix_size = toSolve.rows();
+    template <class Operator>
+        requires is_operator<Operator>
+    void compute(const Operator& toSolve, int maxIter) {
+        const std::size_t matrix_size = detail::operator_size<EigenVectorType>(toSolve);
         maxIter = std::min(maxIter, static_cast<int>(matrix_size));
 
-        if (toSolve.rows() != toSolve.cols()) {
-            std::cerr << "Matrix is not square!" << std::endl;
-            throw;
-        }
-
         EigenVectorType currentSolution(matrix_size);  // corresponds to |q_(i+1)>
         // First filling
         std::vector<EigenVectorType> basis_vectors;
@@ -177,11 +339,12 @@ public:
         betas.push_back(1);
         int iterNum{};
         bool goOn = true;
-        EigenVectorType buffer;
+        detail::TerminationMonitor<RealType> monitor(termination);
+        EigenVectorType buffer(matrix_size);
 
         while (goOn) {
             // algorithm
-            buffer = toSolve * basis_vectors.back();
+            detail::apply_operator<EigenVectorType>(toSolve, basis_vectors.back(), buffer);
             if constexpr (isComplex) {
                 // This has to be real, as <x|H|x> is always real if H=H^+
                 alphas.push_back(basis_vectors.back().dot(buffer).real());
@@ -194,7 +357,7 @@ public:
             ++iterNum;
 
             // breaking conditions
-            if (iterNum >= maxIter || abs(betas.back()) < 1e-10) {
+            if (monitor.terminate(iterNum, maxIter, alphas, betas, res.termination_reason)) {
                 goOn = false;
             }
         }
@@ -211,39 +374,60 @@ public:
      * @brief Compute generalized Lanczos coefficients using an explicit M and N representation.
      *
      * This form can be more stable for complex-valued matrices whose inner product is defined by N.
+     * Both the metric and N are applied exactly once per iteration, see metric_lanczos().
      *
-     * @param toSolve Operator matrix to solve.
-     * @param symplectic Symplectic metric matrix; must be positive semidefinite.
-     * @param N Auxiliary matrix used in the formulation.
+     * @param toSolve Operator matrix or LinearOperator to solve.
+     * @param symplectic Symplectic metric matrix or LinearOperator; must be positive semidefinite.
+     * @param N Auxiliary matrix or LinearOperator used in the formulation.
      * @param maxIter Maximum Lanczos iterations.
+     * @param metric_reorthogonalization Whether to reorthogonalize every new Lanczos vector
+     *                                   in the metric against the whole basis.
      */
-    void compute_from_N_M(const EigenMatrixType& toSolve,
-                          const EigenMatrixType& symplectic,
-                          const EigenMatrixType& N,
-                          int maxIter) {
-        auto matrix_size = toSolve.rows();
-        maxIter = std::min(maxIter, static_cast<int>(matrix_size));
+    template <class Operator, class Metric, class NOperator>
+        requires(is_operator<Operator> && is_operator<Metric> && is_operator<NOperator>)
+    void compute_from_N_M(const Operator& toSolve,
+                          const Metric& symplectic,
+                          const NOperator& N,
+                          int maxIter,
+                          bool metric_reorthogonalization = false) {
+        EigenVectorType n_buffer(detail::operator_size<EigenVectorType>(N));
+        metric_lanczos(toSolve, symplectic, maxIter, metric_reorthogonalization,
+                       [&](const EigenVectorType& current, const EigenVectorType&, const EigenVectorType&) {
+                           detail::apply_operator<EigenVectorType>(N, current, n_buffer);
+                           return current.dot(n_buffer);
+                       });
+    }
 
-        if (toSolve.rows() != toSolve.cols()) {
-            std::cerr << "Matrix is not square!" << std::endl;
-            throw;
-        }
+    /**
+     * @brief Compute Lanczos coefficients for a Hermitian problem with basis reorthogonalization.
+     *
+     * By default, this version reorthogonalizes the Krylov basis at every iteration to improve numerical stability.
+     * The basis is kept in one contiguous panel, so each reorthogonalization consists of two passes of
+     * classical Gram-Schmidt, i.e., four GEMVs against the panel.
+     * With Reorthogonalization::PARTIAL, the loss of orthogonality is estimated by the omega recurrence
+     * and the basis is only reorthogonalized when (and where) it is needed. Semi-orthogonality suffices
+     * for the recurrence coefficients to be accurate to working precision, while the cost of the
+     * reorthogonalizations no longer grows quadratically with @p maxIter.
+     * The number of reorthogonalizations is stored in ResolventData::n_reorthogonalizations.
+     *
+     * @param toSolve Hermitian operator matrix or LinearOperator.
+     * @param maxIter Maximum Lanczos iterations.
+     * @param reorthogonalization Reorthogonalization strategy.
+     */
+    template <class Operator>
+        requires is_operator<Operator>
+    void compute_with_reorthogonalization(const Operator& toSolve,
+                                          int maxIter,
+                                          Reorthogonalization reorthogonalization = Reorthogonalization::FULL) {
+        const std::size_t matrix_size = detail::operator_size<EigenVectorType>(toSolve);
+        maxIter = std::min(maxIter, static_cast<int>(matrix_size));
 
         EigenVectorType currentSolution(matrix_size);  // corresponds to |q_(i+1)>
         // First filling
-        std::vector<EigenVectorType> basis_vectors;
-        EigenVectorType first = EigenVectorType::Zero(matrix_size);  // corresponds to |q_0>
-        EigenVectorType second = this->startingState;                // corresponds to |q_1>
+        detail::KrylovBasis<EigenVectorType> basis_vectors(matrix_size, maxIter + 1);
         resolvent_data res;
-        ComputationType norm_buffer = second.dot(symplectic * second);
-        if constexpr (isComplex) {
-            assertm(abs(norm_buffer.imag()) < 1e-6, "First norm is complex! ");
-        }
-        res.b_i.push_back(abs(norm_buffer));
-
-        second /= std::sqrt(res.b_i.back());
-        basis_vectors.push_back(first);
-        basis_vectors.push_back(second);
+        res.b_i.push_back(this->startingState.squaredNorm());
+        basis_vectors.push_back(this->startingState / std::sqrt(res.b_i.back()));  // corresponds to |q_1>
 
         std::vector<RealType> alphas, betas;
         alphas.reserve(maxIter);
@@ -252,66 +436,84 @@ public:
         betas.push_back(1);
         int iterNum{};
         bool goOn = true;
-        EigenVectorType buffer;
+        detail::TerminationMonitor<RealType> monitor(termination);
+        EigenVectorType buffer(matrix_size);
+        detail::OmegaRecurrence<RealType> omega(matrix_size, maxIter + 1);
         while (goOn) {
             // algorithm
-            buffer = toSolve * basis_vectors.back();
-            norm_buffer = basis_vectors.back().dot(N * basis_vectors.back());
+            detail::apply_operator<EigenVectorType>(toSolve, basis_vectors.back(), buffer);
             if constexpr (isComplex) {
-                assertm(abs(norm_buffer.imag()) < 1e-6, "First norm in loop is complex!");
-                alphas.push_back(norm_buffer.real());
+                // This has to be real, as <x|H|x> is always real if H=H^+
+                alphas.push_back(basis_vectors.back().dot(buffer).real());
             } else {
-                alphas.push_back(norm_buffer);
+                alphas.push_back(basis_vectors.back().dot(buffer));
             }
-
-            currentSolution =
-                (buffer - (alphas.back() * basis_vectors.back())) - (betas.back() * basis_vectors[iterNum]);
-            norm_buffer = std::sqrt(currentSolution.dot(symplectic * currentSolution));
-            if constexpr (isComplex) {
-                assertm(abs(norm_buffer.imag()) < 1e-6, "Second norm in loop is complex!");
+            if (iterNum > 0) {
+                currentSolution =
+                    buffer - (alphas.back() * basis_vectors.back() + betas.back() * basis_vectors[iterNum - 1]);
+            } else {
+                currentSolution = buffer - (alphas.back() * basis_vectors.back());
+            }
+            if (reorthogonalization == Reorthogonalization::FULL) {
+                basis_vectors.orthogonalize(currentSolution);
+                betas.push_back(currentSolution.norm());
+                ++res.n_reorthogonalizations;
+            } else {
+                betas.push_back(currentSolution.norm());
+                if (omega.update(alphas, betas)) {
+                    for (const auto& [begin, count] : omega.intervals()) {
+                        basis_vectors.orthogonalize(currentSolution, begin, count);
+                    }
+                    omega.reorthogonalized();
+                    betas.back() = currentSolution.norm();
+                    ++res.n_reorthogonalizations;
+                }
+                omega.advance();
             }
-            betas.push_back(abs(norm_buffer));
             basis_vectors.push_back(currentSolution / betas.back());
             ++iterNum;
 
             // breaking conditions
-            if (iterNum >= maxIter || abs(betas.back()) < 1e-10) {
+            if (monitor.terminate(iterNum, maxIter, alphas, betas, res.termination_reason)) {
                 goOn = false;
             }
         }
         for (std::size_t i = 0U; i < alphas.size(); ++i) {
             res.a_i.push_back(alphas[i]);
-            res.b_i.push_back(betas[i + 1]);
+            res.b_i.push_back(betas[i + 1] * betas[i + 1]);
         }
+        // The last b is irrelevant, it does not really exist; it's an artifact of the algorithm
+        res.b_i.pop_back();
         data.push_back(std::move(res));
     }
 
     /**
-     * @brief Compute Lanczos coefficients for a Hermitian problem with basis reorthogonalization.
+     * @brief Mixed-precision variant of compute_with_reorthogonalization().
      *
-     * This version reorthogonalizes the Krylov basis at every iteration to improve numerical stability.
+     * The operator and the Krylov basis are held in the next lower precision (float for double),
+     * which halves the memory traffic of both the matrix-vector products and the reorthogonalizations
+     * as well as the memory of the basis. The inner products and norms are accumulated, and the recurrence
+     * coefficients stored, in the full precision.
+     * The coefficients are accurate to roughly the lower precision's epsilon relative to the operator norm.
+     * Use compare_resolvent_data() against a full-precision run to determine how many coefficients are reliable.
      *
-     * @param toSolve Hermitian operator matrix.
+     * @param toSolve Hermitian operator in the lower precision, e.g., `matrix.cast<float>()` or a LinearOperator
+     *                acting on vectors of the lower precision.
      * @param maxIter Maximum Lanczos iterations.
      */
-    void compute_with_reorthogonalization(const EigenMatrixType& toSolve, int maxIter) {
-        const std::size_t matrix_size = toSolve.rows();
+    template <class Operator>
+        requires is_low_precision_operator<Operator>
+    void compute_mixed_precision(const Operator& toSolve, int maxIter) {
+        const std::size_t matrix_size = detail::operator_size<LowVectorType>(toSolve);
         maxIter = std::min(maxIter, static_cast<int>(matrix_size));
 
-        if (toSolve.rows() != toSolve.cols()) {
-            std::cerr << "Matrix is not square!" << std::endl;
-            throw;
-        }
-
-        EigenVectorType currentSolution(matrix_size);  // corresponds to |q_(i+1)>
+        LowVectorType currentSolution(matrix_size);  // corresponds to |q_(i+1)>
         // First filling
-        std::vector<EigenVectorType> basis_vectors;
-        EigenVectorType second = this->startingState;  // corresponds to |q_1>
+        detail::KrylovBasis<LowVectorType> basis_vectors(matrix_size, maxIter + 1);
         resolvent_data res;
-        res.b_i.push_back(second.squaredNorm());
-
-        second /= std::sqrt(res.b_i.back());
-        basis_vectors.push_back(second);
+        res.b_i.push_back(this->startingState.squaredNorm());
+        basis_vectors.push_back(
+            (this->startingState / std::sqrt(res.b_i.back())).template cast<LowScalar>());  // corresponds to |q_1>
 
         std::vector<RealType> alphas, betas;
         alphas.reserve(maxIter);
@@ -320,30 +522,34 @@ public:
         betas.push_back(1);
         int iterNum{};
         bool goOn = true;
-        EigenVectorType buffer;
+        detail::TerminationMonitor<RealType> monitor(termination);
+        LowVectorType buffer(matrix_size);
         while (goOn) {
             // algorithm
-            buffer = toSolve * basis_vectors.back();
+            detail::apply_operator<LowVectorType>(toSolve, basis_vectors.back(), buffer);
+            // The inner product is accumulated in the full precision
+            const auto alpha = basis_vectors.back().template cast<ComputationType>().dot(
+                buffer.template cast<ComputationType>());
             if constexpr (isComplex) {
                 // This has to be real, as <x|H|x> is always real if H=H^+
-                alphas.push_back(basis_vectors.back().dot(buffer).real());
+                alphas.push_back(alpha.real());
             } else {
-                alphas.push_back(basis_vectors.back().dot(buffer));
+                alphas.push_back(alpha);
             }
             if (iterNum > 0) {
-                currentSolution =
-                    buffer - (alphas.back() * basis_vectors.back() + betas.back() * basis_vectors[iterNum]);
+                currentSolution = buffer - (static_cast<LowRealType>(alphas.back()) * basis_vectors.back() +
+                                            static_cast<LowRealType>(betas.back()) * basis_vectors[iterNum - 1]);
             } else {
-                currentSolution = buffer - (alphas.back() * basis_vectors.back());
+                currentSolution = buffer - static_cast<LowRealType>(alphas.back()) * basis_vectors.back();
             }
-            detail::GramSchmidt<typename EigenVectorType::Scalar>::orthogonalize_single_vector(currentSolution,
-                                                                                               basis_vectors);
-            betas.push_back(currentSolution.norm());
-            basis_vectors.push_back(currentSolution / betas.back());
+            basis_vectors.orthogonalize(currentSolution);
+            betas.push_back(currentSolution.template cast<ComputationType>().norm());
+            ++res.n_reorthogonalizations;
+            basis_vectors.push_back(currentSolution / static_cast<LowRealType>(betas.back()));
             ++iterNum;
 
             // breaking conditions
-            if (iterNum >= maxIter || abs(betas.back()) < 1e-10) {
+            if (monitor.terminate(iterNum, maxIter, alphas, betas, res.termination_reason)) {
                 goOn = false;
             }
         }
@@ -356,37 +562,48 @@ public:
         data.push_back(std::move(res));
     }
 
+    /**
+     * @brief Mixed-precision Lanczos for an operator given in the full precision.
+     *
+     * Converts @p toSolve to the lower precision once and calls the overload above.
+     * Pass the operator in the lower precision directly to also save its memory.
+     *
+     * @param toSolve Hermitian operator matrix in the full precision.
+     * @param maxIter Maximum Lanczos iterations.
+     */
+    void compute_mixed_precision(const EigenMatrixType& toSolve, int maxIter) {
+        using LowMatrixType = decltype(toSolve.template cast<LowScalar>().eval());
+        const LowMatrixType low_precision_operator = toSolve.template cast<LowScalar>();
+        compute_mixed_precision(low_precision_operator, maxIter);
+    }
+
     /**
      * @brief Compute Lanczos coefficients and low-lying residuals for a Hermitian problem.
      *
-     * This method uses reorthogonalization and periodically estimates residuals for the
-     * lowest @p n_residuals Ritz values.
+     * This method uses reorthogonalization and estimates residuals for the lowest @p n_residuals
+     * Ritz values every residual_criterion.check_every iterations. The Ritz values are tracked
+     * incrementally by bisection, so each check costs O(n_residuals * iterNum) instead of a full
+     * diagonalization of the tridiagonal matrix. The Ritz vectors that converged in a check are
+     * reconstructed from the basis panel with a single GEMM.
      *
      * @tparam n_residuals Number of residual eigenvalues to track.
-     * @param toSolve Hermitian operator matrix.
+     * @param toSolve Hermitian operator matrix or LinearOperator.
      * @param maxIter Maximum Lanczos iterations.
      * @return ResidualInformation containing eigenvalue residuals, converged eigenvectors, and weights.
      */
-    template <int n_residuals>
-    ResidualInformation<RealType, n_residuals> compute_with_residuals(const EigenMatrixType& toSolve, int maxIter) {
+    template <int n_residuals, class Operator>
+        requires is_operator<Operator>
+    ResidualInformation<RealType, n_residuals> compute_with_residuals(const Operator& toSolve, int maxIter) {
         static_assert(isComplex == false, "Residual computation not implemented for complex types yet!");
-        const std::size_t matrix_size = toSolve.rows();
+        const std::size_t matrix_size = detail::operator_size<EigenVectorType>(toSolve);
         maxIter = std::min(maxIter, static_cast<int>(matrix_size));
 
-        if (toSolve.rows() != toSolve.cols()) {
-            std::cerr << "Matrix is not square!" << std::endl;
-            throw;
-        }
-
         EigenVectorType currentSolution(matrix_size);  // corresponds to |q_(i+1)>
         // First filling
-        std::vector<EigenVectorType> basis_vectors;
-        EigenVectorType second = this->startingState;  // corresponds to |q_1>
+        detail::KrylovBasis<EigenVectorType> basis_vectors(matrix_size, maxIter + 1);
         resolvent_data res;
-        res.b_i.push_back(second.squaredNorm());
-
-        second /= std::sqrt(res.b_i.back());
-        basis_vectors.push_back(second);
+        res.b_i.push_back(this->startingState.squaredNorm());
+        basis_vectors.push_back(this->startingState / std::sqrt(res.b_i.back()));  // corresponds to |q_1>
 
         std::vector<RealType> alphas, betas;
         alphas.reserve(maxIter);
@@ -395,17 +612,18 @@ public:
         betas.push_back(1);
         int iterNum{};
         bool goOn = true;
-        EigenVectorType buffer;
+        detail::TerminationMonitor<RealType> monitor(termination);
+        EigenVectorType buffer(matrix_size);
 
-        Eigen::SelfAdjointEigenSolver<EigenMatrixType> eigen_solver;
-        typedef Eigen::Vector<RealType, Eigen::Dynamic> TVector;
-        typedef Eigen::Map<const TVector> TMap;
+        detail::RitzTracker<RealType> ritz_tracker;
 
         ResidualInformation<RealType, n_residuals> residual_info;
+        // Residuals that converged in the current check, stored as (residual index, Ritz index)
+        std::array<std::pair<int, int>, n_residuals> newly_converged;
 
         while (goOn) {
             // algorithm
-            buffer = toSolve * basis_vectors.back();
+            detail::apply_operator<EigenVectorType>(toSolve, basis_vectors.back(), buffer);
             if constexpr (isComplex) {
                 // This has to be real, as <x|H|x> is always real if H=H^+
                 alphas.push_back(basis_vectors.back().dot(buffer).real());
@@ -414,74 +632,172 @@ public:
             }
             if (iterNum > 0) {
                 currentSolution =
-                    buffer - (alphas.back() * basis_vectors.back() + betas.back() * basis_vectors[iterNum]);
+                    buffer - (alphas.back() * basis_vectors.back() + betas.back() * basis_vectors[iterNum - 1]);
             } else {
                 currentSolution = buffer - (alphas.back() * basis_vectors.back());
             }
 
-            detail::GramSchmidt<typename EigenVectorType::Scalar>::orthogonalize_single_vector(currentSolution,
-                                                                                               basis_vectors);
+            basis_vectors.orthogonalize(currentSolution);
             betas.push_back(currentSolution.norm());
+            ++res.n_reorthogonalizations;
             basis_vectors.push_back(currentSolution / betas.back());
             ++iterNum;
 
-            if (iterNum > n_residuals + 1 && iterNum % 10 == 0) {
-                if (!std::all_of(residual_info.converged.begin(), residual_info.converged.end(),
-                                 [](bool v) { return v; })) {
-                    eigen_solver.computeFromTridiagonal(TMap(alphas.data(), iterNum),
-                                                        TMap(betas.data() + 1, iterNum - 1));
-                    int skip{};
-                    int i_skip{};
-                    // see https://epubs.siam.org/doi/book/10.1137/1.9780898719581, chapter 4.4, eq. 4.13
-                    for (int i = 0; i < n_residuals; ++i) {
-                        if (residual_info.converged[i])
-                            continue;
-
-                    redo_if_ghost:
-                        i_skip = i + skip;  // To avoid Lanczos ghosts
-                        if (i_skip >= iterNum)
-                            break;
-                        residual_info.residuals[i] =
-                            betas.back() * abs(eigen_solver.eigenvectors().col(i_skip)(iterNum - 1));
-                        constexpr double CONVERGE_EPS = 1.49011612e-8;  // ~ sqrt(machine epsilon) ~ 2^{-26}
-                        if (residual_info.residuals[i] < CONVERGE_EPS || iterNum >= maxIter) {
-                            // Eigen sorts the eigenvalues in ascending order
-                            for (int c = 0; c < n_residuals; ++c) {  //&& residual_info.converged[c]
-                                if (abs(residual_info.eigenvalues[c] - eigen_solver.eigenvalues()(i_skip)) < 1e-12) {
-                                    // Found a Lanczos ghost
-                                    ++skip;
-                                    goto redo_if_ghost;
-                                }
-                            }
-
-                            residual_info.converged[i] = residual_info.residuals[i] < CONVERGE_EPS;
-                            residual_info.eigenvalues[i] = eigen_solver.eigenvalues()(i_skip);
-                            residual_info.n_ghosts[i] = skip;
-
-                            // Computing the eigenvector in the original space
-                            EigenVectorType eigvec = EigenVectorType::Zero(matrix_size);
-                            for (int j = 0; j < iterNum; ++j) {
-                                eigvec += eigen_solver.eigenvectors().col(i_skip)(j) * basis_vectors[j];
-                            }
-                            // The eigenvector is useless, if the residual is not small
-                            // However, the eigenvalue is bounded by lambda_true = lambda_approx +/- residual
-                            if (residual_info.converged[i]) {
-                                residual_info.eigenvectors[i] =
-                                    std::vector<RealType>(eigvec.data(), eigvec.data() + eigvec.size());
-                                residual_info.weights[i] = eigvec.dot(this->startingState);
-                            }
+            if (iterNum > n_residuals + 1 &&
+                (iterNum % std::max(residual_criterion.check_every, 1) == 0 || iterNum >= maxIter)) {
+                if (!all_converged(residual_info)) {
+                    ritz_tracker.update(alphas, betas, iterNum);
+                    const int n_newly_converged =
+                        update_residuals<n_residuals>(ritz_tracker, residual_criterion.tolerance, betas.back(), iterNum,
+                                                      maxIter, residual_info, newly_converged);
+
+                    if (n_newly_converged > 0) {
+                        // Computing the eigenvectors in the original space, all at once
+                        Eigen::Matrix<RealType, Eigen::Dynamic, Eigen::Dynamic> ritz_coefficients(iterNum,
+                                                                                                  n_newly_converged);
+                        for (int c = 0; c < n_newly_converged; ++c) {
+                            ritz_coefficients.col(c) = ritz_tracker.eigenvector(newly_converged[c].second);
+                        }
+                        const auto eigvecs = basis_vectors.reconstruct(ritz_coefficients);
+                        const EigenVectorType weights = eigvecs.adjoint() * this->startingState;
+                        for (int c = 0; c < n_newly_converged; ++c) {
+                            const int i = newly_converged[c].first;
+                            residual_info.eigenvectors[i] =
+                                std::vector<RealType>(eigvecs.col(c).data(), eigvecs.col(c).data() + matrix_size);
+                            residual_info.weights[i] = weights(c);
                         }
-                        if (!residual_info.converged[i] && iterNum < maxIter)
-                            break;  // Fill list form the bottom up
                     }
                 }
             }
 
-            // breaking conditions
-            if (iterNum >= maxIter || abs(betas.back()) < 1e-10) {
+            // breaking conditions; the adaptive criterion must not cut off unconverged Ritz pairs
+            if (monitor.terminate(iterNum, maxIter, alphas, betas, res.termination_reason,
+                                  all_converged(residual_info))) {
+                goOn = false;
+            }
+        }
+        for (std::size_t i = 0U; i < alphas.size(); ++i) {
+            res.a_i.push_back(alphas[i]);
+            res.b_i.push_back(betas[i + 1] * betas[i + 1]);
+        }
+        // The last b is irrelevant, it does not really exist; it's an artifact of the algorithm
+        res.b_i.pop_back();
+        data.push_back(std::move(res));
+
+        return residual_info;
+    }
+
+    /**
+     * @brief Memory-bounded variant of compute_with_residuals().
+     *
+     * The first pass is a plain Lanczos recurrence that keeps only three vectors in memory
+     * and stores the recurrence coefficients together with the Ritz coefficients of every
+     * converged Ritz pair. The second pass replays the recurrence from the stored coefficients,
+     * regenerating the Lanczos vectors one by one and accumulating the Ritz vectors on the fly.
+     * Thus, the memory is O((3 + n_residuals) * n) instead of O(maxIter * n) at the cost of
+     * up to twice the number of matrix-vector products.
+     * As there is no reorthogonalization, converged Ritz values reappear as Lanczos ghosts,
+     * which are skipped in the same way as in compute_with_residuals().
+     *
+     * @tparam n_residuals Number of residual eigenvalues to track.
+     * @param toSolve Hermitian operator matrix or LinearOperator.
+     * @param maxIter Maximum Lanczos iterations.
+     * @return ResidualInformation containing eigenvalue residuals, converged eigenvectors, and weights.
+     */
+    template <int n_residuals, class Operator>
+        requires is_operator<Operator>
+    ResidualInformation<RealType, n_residuals> compute_with_residuals_two_pass(const Operator& toSolve, int maxIter) {
+        static_assert(isComplex == false, "Residual computation not implemented for complex types yet!");
+        const std::size_t matrix_size = detail::operator_size<EigenVectorType>(toSolve);
+        maxIter = std::min(maxIter, static_cast<int>(matrix_size));
+
+        typedef Eigen::Vector<RealType, Eigen::Dynamic> TVector;
+
+        resolvent_data res;
+        res.b_i.push_back(this->startingState.squaredNorm());
+        const EigenVectorType first_vector = this->startingState / std::sqrt(res.b_i.back());  // corresponds to |q_1>
+
+        std::vector<RealType> alphas, betas;
+        alphas.reserve(maxIter);
+        betas.reserve(maxIter);
+        betas.push_back(1);
+
+        EigenVectorType previous = EigenVectorType::Zero(matrix_size);  // corresponds to |q_(i-1)>
+        EigenVectorType current = first_vector;                         // corresponds to |q_i>
+        EigenVectorType buffer(matrix_size);
+
+        detail::RitzTracker<RealType> ritz_tracker;
+        ResidualInformation<RealType, n_residuals> residual_info;
+        std::array<std::pair<int, int>, n_residuals> newly_converged;
+        // Coefficients of the converged Ritz vectors with respect to the Lanczos vectors
+        std::array<TVector, n_residuals> ritz_coefficients;
+
+        // First pass: recurrence coefficients and Ritz coefficients
+        int iterNum{};
+        bool goOn = true;
+        detail::TerminationMonitor<RealType> monitor(termination);
+        while (goOn) {
+            detail::apply_operator<EigenVectorType>(toSolve, current, buffer);
+            alphas.push_back(current.dot(buffer));
+            buffer -= alphas.back() * current + betas.back() * previous;
+            betas.push_back(buffer.norm());
+            previous.swap(current);
+            current = buffer / betas.back();
+            ++iterNum;
+
+            if (iterNum > n_residuals + 1 &&
+                (iterNum % std::max(residual_criterion.check_every, 1) == 0 || iterNum >= maxIter)) {
+                if (!all_converged(residual_info)) {
+                    ritz_tracker.update(alphas, betas, iterNum);
+                    const int n_newly_converged =
+                        update_residuals<n_residuals>(ritz_tracker, residual_criterion.tolerance, betas.back(), iterNum,
+                                                      maxIter, residual_info, newly_converged);
+                    for (int c = 0; c < n_newly_converged; ++c) {
+                        ritz_coefficients[newly_converged[c].first] =
+                            ritz_tracker.eigenvector(newly_converged[c].second);
+                    }
+                }
+            }
+
+            // breaking conditions; the adaptive criterion must not cut off unconverged Ritz pairs
+            if (monitor.terminate(iterNum, maxIter, alphas, betas, res.termination_reason,
+                                  all_converged(residual_info))) {
                 goOn = false;
             }
         }
+
+        // Second pass: regenerate the Lanczos vectors and accumulate the Ritz vectors
+        // The operations are the same as in the first pass, so the replayed vectors are identical
+        Eigen::Index replay_length{};
+        std::array<EigenVectorType, n_residuals> eigvecs;
+        for (int i = 0; i < n_residuals; ++i) {
+            if (!residual_info.converged[i])
+                continue;
+            replay_length = std::max(replay_length, ritz_coefficients[i].size());
+            eigvecs[i] = EigenVectorType::Zero(matrix_size);
+        }
+        previous.setZero();
+        current = first_vector;
+        for (Eigen::Index j = 0; j < replay_length; ++j) {
+            for (int i = 0; i < n_residuals; ++i) {
+                if (residual_info.converged[i] && j < ritz_coefficients[i].size()) {
+                    eigvecs[i] += ritz_coefficients[i](j) * current;
+                }
+            }
+            if (j + 1 < replay_length) {
+                detail::apply_operator<EigenVectorType>(toSolve, current, buffer);
+                buffer -= alphas[j] * current + betas[j] * previous;
+                previous.swap(current);
+                current = buffer / betas[j + 1];
+            }
+        }
+        for (int i = 0; i < n_residuals; ++i) {
+            if (!residual_info.converged[i])
+                continue;
+            residual_info.eigenvectors[i] = std::vector<RealType>(eigvecs[i].data(), eigvecs[i].data() + matrix_size);
+            residual_info.weights[i] = eigvecs[i].dot(this->startingState);
+        }
+
         for (std::size_t i = 0U; i < alphas.size(); ++i) {
             res.a_i.push_back(alphas[i]);
             res.b_i.push_back(betas[i + 1] * betas[i + 1]);
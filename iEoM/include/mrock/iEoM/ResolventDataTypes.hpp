@@ -1,7 +1,10 @@
 #ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_RESOLVENTDATATYPES_HPP
 #define MROCK_IEOM_INCLUDE_MROCK_IEOM_RESOLVENTDATATYPES_HPP
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -10,6 +13,37 @@
 #endif
 
 namespace mrock::iEoM {
+/**
+ * @brief Reason why a Lanczos run stopped.
+ */
+enum class TerminationReason {
+    /** The maximum number of iterations has been reached. */
+    MAX_ITERATIONS,
+    /** The Krylov space is exhausted, i.e., the last beta vanished. */
+    INVARIANT_SUBSPACE,
+    /** The coefficients converged to their asymptotic values, see TerminationCriterion. */
+    COEFFICIENTS_CONVERGED,
+    /** The resolvent on the probe grid converged, see TerminationCriterion. */
+    RESOLVENT_CONVERGED
+};
+
+/**
+ * @brief Human-readable name of a TerminationReason.
+ */
+inline const char* to_string(TerminationReason reason) {
+    switch (reason) {
+    case TerminationReason::MAX_ITERATIONS:
+        return "max_iterations";
+    case TerminationReason::INVARIANT_SUBSPACE:
+        return "invariant_subspace";
+    case TerminationReason::COEFFICIENTS_CONVERGED:
+        return "coefficients_converged";
+    case TerminationReason::RESOLVENT_CONVERGED:
+        return "resolvent_converged";
+    }
+    return "unknown";
+}
+
 /**
  * @brief Stores Lanczos recurrence coefficients for one resolvent run.
  *
@@ -19,6 +53,10 @@ template <class RealType>
 struct ResolventData {
     std::vector<RealType> a_i;
     std::vector<RealType> b_i;
+    /** Number of Lanczos steps in which the new vector has been reorthogonalized. */
+    int n_reorthogonalizations{};
+    /** Reason why the Lanczos iteration stopped. */
+    TerminationReason termination_reason{TerminationReason::MAX_ITERATIONS};
 };
 
 /**
@@ -121,6 +159,92 @@ inline std::ostream& operator<<(std::ostream& os, const ResolventData<T>& data)
     return os;
 }
 
+/**
+ * @brief Accuracy of continued-fraction coefficients compared to a reference run.
+ *
+ * Used to validate reduced-precision runs, e.g., Resolvent::compute_mixed_precision(), against a run
+ * in full precision. Deviations are relative, |x - x_ref| / max(1, |x_ref|).
+ *
+ * @tparam RealType Numeric type of the coefficients.
+ */
+template <class RealType>
+struct AccuracyReport {
+    /** Largest relative deviation of the a_i. */
+    RealType max_deviation_a{};
+    /** Largest relative deviation of the b_i. */
+    RealType max_deviation_b{};
+    /** Tolerance used to determine first_deviating_index. */
+    RealType tolerance{};
+    /** Number of coefficients contained in both runs. */
+    std::size_t n_compared{};
+    /** Index of the first coefficient pair (a_i, b_i) exceeding the tolerance; n_compared if there is none. */
+    std::size_t first_deviating_index{};
+    /** Whether both runs produced the same number of coefficients. */
+    bool same_length{};
+
+    /**
+     * @brief Whether all compared coefficients agree within the tolerance.
+     */
+    inline bool within_tolerance() const noexcept {
+        return same_length && first_deviating_index == n_compared;
+    }
+};
+
+/**
+ * @brief Compare continued-fraction coefficients with a reference run.
+ *
+ * @tparam RealType Numeric type of the coefficients.
+ * @param tested Coefficients to be validated.
+ * @param reference Reference coefficients, e.g., computed in double precision.
+ * @param tolerance Maximum acceptable relative deviation.
+ * @return AccuracyReport summarizing the deviations.
+ */
+template <class RealType>
+AccuracyReport<RealType> compare_resolvent_data(const ResolventData<RealType>& tested,
+                                                const ResolventData<RealType>& reference,
+                                                RealType tolerance) {
+    auto relative_deviation = [](RealType value, RealType reference_value) {
+        return std::abs(value - reference_value) / std::max(RealType{1}, std::abs(reference_value));
+    };
+
+    AccuracyReport<RealType> report;
+    report.tolerance = tolerance;
+    report.same_length = tested.a_i.size() == reference.a_i.size() && tested.b_i.size() == reference.b_i.size();
+    report.n_compared = std::min(tested.a_i.size(), reference.a_i.size());
+    report.first_deviating_index = report.n_compared;
+    for (std::size_t i = 0U; i < report.n_compared; ++i) {
+        const RealType deviation_a = relative_deviation(tested.a_i[i], reference.a_i[i]);
+        const RealType deviation_b = (i < tested.b_i.size() && i < reference.b_i.size())
+                                         ? relative_deviation(tested.b_i[i], reference.b_i[i])
+                                         : RealType{};
+        report.max_deviation_a = std::max(report.max_deviation_a, deviation_a);
+        report.max_deviation_b = std::max(report.max_deviation_b, deviation_b);
+        if (report.first_deviating_index == report.n_compared && std::max(deviation_a, deviation_b) > tolerance) {
+            report.first_deviating_index = i;
+        }
+    }
+    return report;
+}
+
+/**
+ * @brief Stream output operator for AccuracyReport.
+ *
+ * @tparam T Numeric type of the report.
+ * @param os Output stream.
+ * @param report Report to stream.
+ * @return Reference to the output stream.
+ */
+template <typename T>
+inline std::ostream& operator<<(std::ostream& os, const AccuracyReport<T>& report) {
+    os << "max. deviation a_i = " << report.max_deviation_a << ", max. deviation b_i = " << report.max_deviation_b
+       << ", first deviation > " << report.tolerance << " at i = " << report.first_deviating_index << " of "
+       << report.n_compared;
+    if (!report.same_length) {
+        os << " (different number of coefficients)";
+    }
+    return os;
+}
+
 /**
  * @brief Stores residual eigenvalue and Ritz vector information.
  *
@@ -157,6 +281,30 @@ struct FullDiagonalizationData {
     std::vector<std::vector<RealType>> weights;
 };
 
+/**
+ * @brief Resolvent of a block diagonal operator as the sum of the resolvents of its blocks.
+ *
+ * G(z) = sum_k G_k(z) + sum_j weights[j] / (z - poles[j]), where G_k is the continued fraction of lanczos[k].
+ * Each block touched by the starting state contributes either a continued fraction or its exact poles and weights;
+ * untouched blocks contribute nothing. Both lists are ordered by ascending block index.
+ *
+ * @tparam RealType Numeric type of the coefficients, poles and weights.
+ */
+template <class RealType>
+struct BlockwiseResolventData {
+    std::string name;
+    /** Lanczos coefficients of the blocks solved iteratively, one entry per block. */
+    std::vector<ResolventData<RealType>> lanczos;
+    /** Block index of each entry of lanczos. */
+    std::vector<int> lanczos_blocks;
+    /** Eigenvalues of the blocks solved exactly. */
+    std::vector<RealType> poles;
+    /** Squared projections of the starting state onto the eigenvectors belonging to poles. */
+    std::vector<RealType> weights;
+    /** Block index of each entry of poles and weights. */
+    std::vector<int> pole_blocks;
+};
+
 #ifndef MROCK_IEOM_NO_NLOHMANN_JSON
 /**
  * @brief Serialize ResolventData to JSON.
@@ -167,7 +315,12 @@ struct FullDiagonalizationData {
  */
 template <class RealType>
 void to_json(nlohmann::json& j, const ResolventData<RealType>& res_data) {
-    j = nlohmann::json{{"a_i", res_data.a_i}, {"b_i", res_data.b_i}};
+    j = nlohmann::json{
+        {"a_i", res_data.a_i},
+        {"b_i", res_data.b_i},
+        {"n_reorthogonalizations", res_data.n_reorthogonalizations},
+        {"termination_reason", to_string(res_data.termination_reason)},
+    };
 }
 
 /**
@@ -184,6 +337,44 @@ void to_json(nlohmann::json& j, const std::vector<ResolventDataWrapper<RealType>
     }
 }
 
+/**
+ * @brief Serialize BlockwiseResolventData to JSON.
+ *
+ * @tparam RealType Numeric type of the resolvent data.
+ * @param j JSON output object.
+ * @param res_data Data to serialize.
+ */
+template <class RealType>
+void to_json(nlohmann::json& j, const BlockwiseResolventData<RealType>& res_data) {
+    j = nlohmann::json{
+        {"name", res_data.name},
+        {"lanczos", res_data.lanczos},
+        {"lanczos_blocks", res_data.lanczos_blocks},
+        {"poles", res_data.poles},
+        {"weights", res_data.weights},
+        {"pole_blocks", res_data.pole_blocks},
+    };
+}
+
+/**
+ * @brief Serialize AccuracyReport to JSON.
+ *
+ * @tparam RealType Numeric type of the report.
+ * @param j JSON output object.
+ * @param report Report to serialize.
+ */
+template <class RealType>
+void to_json(nlohmann::json& j, const AccuracyReport<RealType>& report) {
+    j = nlohmann::json{
+        {"max_deviation_a", report.max_deviation_a},
+        {"max_deviation_b", report.max_deviation_b},
+        {"tolerance", report.tolerance},
+        {"n_compared", report.n_compared},
+        {"first_deviating_index", report.first_deviating_index},
+        {"same_length", report.same_length},
+    };
+}
+
 /**
  * @brief Serialize ResidualInformation to JSON.
  *
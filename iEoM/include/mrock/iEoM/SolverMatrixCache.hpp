@@ -0,0 +1,523 @@
+#ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_SOLVERMATRIXCACHE_HPP
+#define MROCK_IEOM_INCLUDE_MROCK_IEOM_SOLVERMATRIXCACHE_HPP
+#include "detail/MappedFile.hpp"
+#include "detail/PivotToBlockStructure.hpp"
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace mrock::iEoM {
+namespace detail {
+/**
+ * @brief splitmix64 finalizer; maps each 64-bit word to a pseudo-random one.
+ */
+inline std::uint64_t mix64(std::uint64_t word) noexcept {
+    word ^= word >> 30;
+    word *= 0xbf58476d1ce4e5b9ULL;
+    word ^= word >> 27;
+    word *= 0x94d049bb133111ebULL;
+    word ^= word >> 31;
+    return word;
+}
+
+/**
+ * @brief Calls @p function with every 64-bit word of the raw content of a dense matrix;
+ * trailing bytes are padded with zeros.
+ */
+template <class Derived, class Function>
+void for_each_word(const Eigen::DenseBase<Derived>& matrix, const Function& function) {
+    const auto& evaluated = matrix.derived().eval();
+    const char* bytes = reinterpret_cast<const char*>(evaluated.data());
+    const std::size_t n_bytes = evaluated.size() * sizeof(typename Derived::Scalar);
+    std::size_t position = 0U;
+    for (; position + sizeof(std::uint64_t) <= n_bytes; position += sizeof(std::uint64_t)) {
+        std::uint64_t word;
+        std::memcpy(&word, bytes + position, sizeof(word));
+        function(word);
+    }
+    if (position < n_bytes) {
+        std::uint64_t word{};
+        std::memcpy(&word, bytes + position, n_bytes - position);
+        function(word);
+    }
+}
+
+/**
+ * @brief 64-bit hash of the dimensions and the raw content of a dense matrix.
+ *
+ * Processes the data word by word (FNV-1a style multiply-xor) with a final avalanche step,
+ * so that hashing costs O(n^2) and is negligible compared to the O(n^3) work it is meant to save.
+ *
+ * @param matrix Matrix to hash.
+ * @param seed Hash of the preceding data; allows chaining several matrices.
+ */
+template <class Derived>
+std::uint64_t content_hash(const Eigen::DenseBase<Derived>& matrix, std::uint64_t seed = 0xcbf29ce484222325ULL) {
+    constexpr std::uint64_t prime = 0x100000001b3ULL;
+    std::uint64_t hash = seed;
+    auto mix = [&hash](std::uint64_t word) {
+        hash ^= word;
+        hash *= prime;
+        hash ^= hash >> 29;
+    };
+    mix(static_cast<std::uint64_t>(matrix.rows()));
+    mix(static_cast<std::uint64_t>(matrix.cols()));
+    for_each_word(matrix, mix);
+    // Final avalanche
+    return mix64(hash);
+}
+
+/**
+ * @brief Second 64-bit fingerprint of the raw content of a dense matrix.
+ *
+ * In contrast to the sequential content_hash(), this is a sum of the scrambled words, each offset by its position,
+ * so that a collision of content_hash() does not imply a collision of the fingerprint.
+ *
+ * @param matrix Matrix to fingerprint.
+ * @param seed Fingerprint of the preceding data; allows chaining several matrices.
+ */
+template <class Derived>
+std::uint64_t content_fingerprint(const Eigen::DenseBase<Derived>& matrix, std::uint64_t seed = 0U) {
+    constexpr std::uint64_t golden_ratio = 0x9e3779b97f4a7c15ULL;
+    std::uint64_t sum{};
+    std::uint64_t position{};
+    for_each_word(matrix, [&](std::uint64_t word) { sum += mix64(word + ++position * golden_ratio); });
+    return mix64(sum ^ mix64(seed + golden_ratio));
+}
+}  // namespace detail
+
+/**
+ * @brief Identifies the matrices K_+, K_- and L and the settings of a SolverMatrixCache entry.
+ *
+ * The hash selects the slot and the file of an entry. On every hit, the whole key is compared,
+ * so that a collision of the hashes is detected by the independent fingerprint and the dimensions
+ * instead of returning the matrices of another system.
+ */
+struct SolverMatrixCacheKey {
+    std::uint64_t hash{};
+    std::uint64_t fingerprint{};
+    /** Rows of K_+ and K_-, rows and columns of L */
+    std::array<std::int64_t, 4> dimensions{};
+
+    bool operator==(const SolverMatrixCacheKey&) const = default;
+};
+
+/**
+ * @brief Everything XPResolvent derives from K_+, K_- and L before the Lanczos stage.
+ *
+ * Channel index 0 refers to the phase channel, index 1 to the amplitude channel.
+ * Channels are filled on demand; an empty solver matrix means that the channel has not been computed yet.
+ *
+ * @tparam RealType Floating-point type.
+ */
+template <class RealType>
+struct SolverMatrixCacheEntry {
+    using Matrix = Eigen::Matrix<RealType, Eigen::Dynamic, Eigen::Dynamic>;
+    using TransformQR = Eigen::CompleteOrthogonalDecomposition<Matrix>;
+
+    /** Key of the matrices the entry was computed from; set by SolverMatrixCache::insert(). */
+    SolverMatrixCacheKey key;
+    /** Eigendecompositions of K_+ (index 0) and K_- (index 1), or their Cholesky factors, see k_cholesky. */
+    std::array<detail::matrix_wrapper<Matrix>, 2> k_solutions;
+    /**
+     * Whether `k_solutions[index]` holds the lower Cholesky factor C of K = C C^T in place of the eigenvectors
+     * and ones in place of the eigenvalues. Products with K need no distinction; only the inverse does.
+     */
+    std::array<bool, 2> k_cholesky{};
+    /** Solver matrices of both channels. */
+    std::array<Matrix, 2> solver_matrices;
+    /** Transforms N_new^(-1/2) L of the starting states of both channels. */
+    std::array<Matrix, 2> transform_matrices;
+    /** Whether the transform of a channel has full column rank, i.e., whether rank(N_new) equals its column count. */
+    std::array<bool, 2> full_column_rank{};
+    /** Locks the on-demand computation of channels and QR decompositions. */
+    std::mutex mutex;
+    /** Whether the entry changed since it was last written to disk. */
+    bool modified{true};
+
+private:
+    std::array<std::unique_ptr<TransformQR>, 2> _transform_qrs;
+
+public:
+    /**
+     * @brief Whether the solver matrix of @p channel is available.
+     */
+    inline bool has_channel(std::size_t channel) const noexcept { return solver_matrices[channel].size() > 0; }
+
+    /**
+     * @brief QR decomposition of the transform of @p channel; computed on first use.
+     *
+     * Only needed if the transform does not have full column rank, see XPResolvent.
+     *
+     * The caller has to hold the mutex.
+     */
+    const TransformQR& transform_qr(std::size_t channel) {
+        if (!_transform_qrs[channel]) {
+            _transform_qrs[channel] = std::make_unique<TransformQR>(transform_matrices[channel]);
+        }
+        return *_transform_qrs[channel];
+    }
+
+    /**
+     * @brief Release all data of @p channel.
+     */
+    void release_channel(std::size_t channel) {
+        solver_matrices[channel].resize(0, 0);
+        transform_matrices[channel].resize(0, 0);
+        full_column_rank[channel] = false;
+        _transform_qrs[channel].reset();
+    }
+
+    /**
+     * @brief Approximate memory held by the entry in bytes.
+     */
+    std::size_t memory_usage() const noexcept {
+        std::size_t n_elements{};
+        for (std::size_t c = 0U; c < 2U; ++c) {
+            n_elements += k_solutions[c].eigenvectors.size() + k_solutions[c].eigenvalues.size();
+            n_elements += solver_matrices[c].size() + transform_matrices[c].size();
+            if (_transform_qrs[c]) {
+                // The decomposition stores a matrix of the transform's size plus O(n) coefficients
+                n_elements += transform_matrices[c].size();
+            }
+        }
+        return n_elements * sizeof(RealType);
+    }
+};
+
+/**
+ * @brief Persistent cache of the solver matrices of XPResolvent, keyed by the content of K_+, K_- and L.
+ *
+ * A repeated parameter point, or a point that only differs in its starting states, then skips the
+ * diagonalization of K_+ and K_-, the computation of the solver matrices and of their transforms,
+ * and the QR decompositions of rank-deficient transforms; only the Lanczos stage remains.
+ * One cache may be shared by several XPResolvent objects, also from different threads.
+ *
+ * Entries are evicted in least-recently-used order once either @p max_entries or @p max_bytes is exceeded.
+ * Optionally, entries are written through to a directory, one file per entry, and looked up there
+ * if they are not (or no longer) in memory. Files are memory-mapped when being loaded.
+ * QR decompositions are not stored on disk; they are recomputed on demand.
+ *
+ * Entries are addressed by a 64-bit content hash. The stored key is compared on every hit, see
+ * SolverMatrixCacheKey; a collision is then a miss, and the new entry replaces the old one.
+ *
+ * @tparam RealType Floating-point type.
+ */
+template <class RealType>
+class SolverMatrixCache {
+public:
+    using Entry = SolverMatrixCacheEntry<RealType>;
+    using Matrix = typename Entry::Matrix;
+
+private:
+    static constexpr std::uint64_t file_magic = 0x34435845494b524dULL;  // "MRKIEXC4"
+
+    struct Slot {
+        std::shared_ptr<Entry> entry;
+        std::list<std::uint64_t>::iterator position;
+        std::size_t bytes{};
+    };
+
+    std::size_t _max_entries{};
+    std::size_t _max_bytes{};
+    std::filesystem::path _directory;
+
+    mutable std::mutex _mutex;
+    std::list<std::uint64_t> _recently_used;  // Front is the most recently used key
+    std::unordered_map<std::uint64_t, Slot> _slots;
+    std::size_t _bytes{};
+    std::size_t _hits{};
+    std::size_t _misses{};
+
+public:
+    /**
+     * @brief Construct a cache.
+     *
+     * @param max_entries Maximum number of entries kept in memory; 0 means unlimited.
+     * @param max_bytes Maximum memory of all entries in bytes; 0 means unlimited.
+     *                  The most recently inserted entry is always kept, even if it exceeds the limit alone.
+     * @param directory If not empty, entries are also stored in (and loaded from) this directory.
+     */
+    explicit SolverMatrixCache(std::size_t max_entries = 4U,
+                               std::size_t max_bytes = 0U,
+                               const std::filesystem::path& directory = {})
+        : _max_entries(max_entries), _max_bytes(max_bytes), _directory(directory) {
+        if (!_directory.empty()) {
+            std::filesystem::create_directories(_directory);
+        }
+    };
+
+    /**
+     * @brief Key of the matrices K_+, K_- and L together with all settings the solver matrices depend on.
+     *
+     * The settings include @p negative_matrix_is_error, because a cached entry skips the definiteness checks.
+     */
+    static SolverMatrixCacheKey key(const Matrix& K_plus,
+                                    const Matrix& K_minus,
+                                    const Matrix& L,
+                                    RealType sqrt_precision,
+                                    bool pivot,
+                                    bool negative_matrix_is_error) {
+        const Eigen::Vector<RealType, 3> settings(sqrt_precision, pivot ? RealType{1} : RealType{},
+                                                  negative_matrix_is_error ? RealType{1} : RealType{});
+        SolverMatrixCacheKey key;
+        key.hash = detail::content_hash(
+            settings, detail::content_hash(L, detail::content_hash(K_minus, detail::content_hash(K_plus))));
+        key.fingerprint = detail::content_fingerprint(
+            settings,
+            detail::content_fingerprint(L, detail::content_fingerprint(K_minus, detail::content_fingerprint(K_plus))));
+        key.dimensions = {K_plus.rows(), K_minus.rows(), L.rows(), L.cols()};
+        return key;
+    }
+
+    /**
+     * @brief Look up an entry in memory and, if enabled, on disk.
+     *
+     * An entry only counts if its whole key equals @p key, see SolverMatrixCacheKey.
+     *
+     * @return The entry, or nullptr if there is none.
+     */
+    std::shared_ptr<Entry> find(const SolverMatrixCacheKey& key) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto slot = _slots.find(key.hash);
+            if (slot != _slots.end() && slot->second.entry->key == key) {
+                _recently_used.splice(_recently_used.begin(), _recently_used, slot->second.position);
+                ++_hits;
+                return slot->second.entry;
+            }
+        }
+        std::shared_ptr<Entry> entry = load(key);
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (entry) {
+            ++_hits;
+            insert_locked(key.hash, entry);
+        } else {
+            ++_misses;
+        }
+        return entry;
+    }
+
+    /**
+     * @brief Insert or refresh an entry, evicting the least recently used ones if necessary.
+     *
+     * If a directory is set and the entry was modified since it was last stored, it is written to disk.
+     * Must be called again after channels have been added to the entry to update its memory accounting.
+     * An entry with the same hash but a different key is replaced.
+     */
+    void insert(const SolverMatrixCacheKey& key, const std::shared_ptr<Entry>& entry) {
+        {
+            std::lock_guard<std::mutex> entry_lock(entry->mutex);
+            entry->key = key;
+            if (!_directory.empty() && entry->modified) {
+                entry->modified = !store(*entry);
+            }
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        insert_locked(key.hash, entry);
+    }
+
+    /**
+     * @brief Remove all entries from memory; files on disk are kept.
+     */
+    void clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _slots.clear();
+        _recently_used.clear();
+        _bytes = 0U;
+    }
+
+    /**
+     * @brief Number of entries in memory.
+     */
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _slots.size();
+    }
+    /**
+     * @brief Memory of all entries at their last insertion in bytes.
+     */
+    std::size_t memory_usage() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _bytes;
+    }
+    /**
+     * @brief Number of successful lookups, in memory or on disk.
+     */
+    std::size_t hits() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _hits;
+    }
+    /**
+     * @brief Number of failed lookups.
+     */
+    std::size_t misses() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _misses;
+    }
+
+private:
+    void insert_locked(std::uint64_t key, const std::shared_ptr<Entry>& entry) {
+        auto slot = _slots.find(key);
+        if (slot == _slots.end()) {
+            _recently_used.push_front(key);
+            slot = _slots.emplace(key, Slot{entry, _recently_used.begin(), 0U}).first;
+        } else {
+            _recently_used.splice(_recently_used.begin(), _recently_used, slot->second.position);
+            slot->second.entry = entry;
+        }
+        _bytes -= slot->second.bytes;
+        slot->second.bytes = entry->memory_usage();
+        _bytes += slot->second.bytes;
+
+        while (_slots.size() > 1U && ((_max_entries > 0U && _slots.size() > _max_entries) ||
+                                      (_max_bytes > 0U && _bytes > _max_bytes))) {
+            const auto evicted = _slots.find(_recently_used.back());
+            _bytes -= evicted->second.bytes;
+            _slots.erase(evicted);
+            _recently_used.pop_back();
+        }
+    }
+
+    std::filesystem::path file_name(std::uint64_t key) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.xpcache", static_cast<unsigned long long>(key));
+        return _directory / name;
+    }
+
+    static void write_matrix(std::ofstream& file, const Eigen::Ref<const Matrix>& matrix) {
+        const std::int64_t dimensions[2] = {matrix.rows(), matrix.cols()};
+        file.write(reinterpret_cast<const char*>(dimensions), sizeof(dimensions));
+        file.write(reinterpret_cast<const char*>(matrix.data()), matrix.size() * sizeof(RealType));
+    }
+    /**
+     * @brief Read a matrix written by write_matrix().
+     *
+     * The stored dimensions are validated before anything is allocated: neither may exceed @p max_dimension,
+     * the largest dimension of the entry's key, and the file must hold all coefficients.
+     */
+    template <class EigenType>
+    static bool read_matrix(detail::MappedFileReader& reader, EigenType& matrix, std::int64_t max_dimension) {
+        std::int64_t dimensions[2];
+        if (!reader.read(dimensions, 2U) || dimensions[0] < 0 || dimensions[1] < 0 ||
+            dimensions[0] > max_dimension || dimensions[1] > max_dimension)
+            return false;
+        if constexpr (EigenType::ColsAtCompileTime == 1) {
+            if (dimensions[1] != 1)
+                return false;
+        }
+        const std::uint64_t n_coefficients =
+            static_cast<std::uint64_t>(dimensions[0]) * static_cast<std::uint64_t>(dimensions[1]);
+        if (n_coefficients > reader.remaining() / sizeof(typename EigenType::Scalar))
+            return false;
+        matrix.resize(dimensions[0], dimensions[1]);
+        return reader.read(matrix.data(), matrix.size());
+    }
+
+    /**
+     * @brief Write an entry to a temporary file and rename it, so that readers never see partial files.
+     *
+     * If writing fails, e.g., because the disk is full, the temporary file is removed and an existing
+     * file of the entry is kept.
+     *
+     * @return Whether the entry has been stored.
+     */
+    bool store(const Entry& entry) const {
+        const std::filesystem::path path = file_name(entry.key.hash);
+        std::filesystem::path temporary = path;
+        temporary += ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                std::cerr << "Warning: Could not write the solver matrix cache file " << temporary << std::endl;
+                return false;
+            }
+            const std::uint64_t header[2] = {file_magic, sizeof(RealType)};
+            file.write(reinterpret_cast<const char*>(header), sizeof(header));
+            const std::uint64_t key_words[2] = {entry.key.hash, entry.key.fingerprint};
+            file.write(reinterpret_cast<const char*>(key_words), sizeof(key_words));
+            file.write(reinterpret_cast<const char*>(entry.key.dimensions.data()), sizeof(entry.key.dimensions));
+            const std::uint64_t flags[4] = {entry.full_column_rank[0], entry.full_column_rank[1],
+                                            entry.k_cholesky[0], entry.k_cholesky[1]};
+            file.write(reinterpret_cast<const char*>(flags), sizeof(flags));
+            for (std::size_t c = 0U; c < 2U; ++c) {
+                write_matrix(file, entry.k_solutions[c].eigenvectors);
+                write_matrix(file, entry.k_solutions[c].eigenvalues);
+            }
+            for (std::size_t c = 0U; c < 2U; ++c) {
+                write_matrix(file, entry.solver_matrices[c]);
+                write_matrix(file, entry.transform_matrices[c]);
+            }
+            file.close();
+            if (file.fail()) {
+                std::cerr << "Warning: Could not write the solver matrix cache file " << temporary << std::endl;
+                std::error_code error;
+                std::filesystem::remove(temporary, error);
+                return false;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary, path, error);
+        if (error) {
+            std::cerr << "Warning: Could not store the solver matrix cache file " << path << ": " << error.message()
+                      << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    std::shared_ptr<Entry> load(const SolverMatrixCacheKey& key) const {
+        if (_directory.empty())
+            return nullptr;
+        const detail::MappedFile file(file_name(key.hash));
+        if (!file.is_open())
+            return nullptr;
+        detail::MappedFileReader reader(file);
+        std::uint64_t header[2];
+        if (!reader.read(header, 2U) || header[0] != file_magic || header[1] != sizeof(RealType))
+            return nullptr;
+
+        auto entry = std::make_shared<Entry>();
+        std::uint64_t key_words[2];
+        if (!reader.read(key_words, 2U) || !reader.read(entry->key.dimensions.data(), entry->key.dimensions.size()))
+            return nullptr;
+        entry->key.hash = key_words[0];
+        entry->key.fingerprint = key_words[1];
+        if (!(entry->key == key))
+            return nullptr;
+        std::uint64_t flags[4];
+        if (!reader.read(flags, 4U))
+            return nullptr;
+        entry->full_column_rank = {flags[0] != 0U, flags[1] != 0U};
+        entry->k_cholesky = {flags[2] != 0U, flags[3] != 0U};
+        // All matrices of an entry are built from K_plus, K_minus and L; a vector has one column
+        const std::int64_t max_dimension =
+            std::max<std::int64_t>(*std::max_element(key.dimensions.begin(), key.dimensions.end()), 1);
+        for (std::size_t c = 0U; c < 2U; ++c) {
+            if (!read_matrix(reader, entry->k_solutions[c].eigenvectors, max_dimension) ||
+                !read_matrix(reader, entry->k_solutions[c].eigenvalues, max_dimension))
+                return nullptr;
+        }
+        for (std::size_t c = 0U; c < 2U; ++c) {
+            if (!read_matrix(reader, entry->solver_matrices[c], max_dimension) ||
+                !read_matrix(reader, entry->transform_matrices[c], max_dimension))
+                return nullptr;
+        }
+        entry->modified = false;
+        return entry;
+    }
+};
+}  // namespace mrock::iEoM
+#endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_SOLVERMATRIXCACHE_HPP
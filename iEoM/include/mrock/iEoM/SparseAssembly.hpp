@@ -0,0 +1,125 @@
+#ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_SPARSEASSEMBLY_HPP
+#define MROCK_IEOM_INCLUDE_MROCK_IEOM_SPARSEASSEMBLY_HPP
+#include <Eigen/Dense>
+#include <Eigen/SparseCore>
+
+#include <cassert>
+#include <vector>
+
+namespace mrock::iEoM {
+/**
+ * @brief Collects matrix elements as triplets and assembles sparse (or dense) matrices from them.
+ *
+ * Meant to be used in fill_M() / fill_matrices() when only a few entries per row are non-zero.
+ * Entries may be added several times; duplicates are summed during assembly.
+ * Thus, the typical fill loop
+ *      M(i, j) += value;
+ * becomes
+ *      assembler(i, j) += value;
+ * and costs O(nnz) memory instead of O(n^2).
+ *
+ * @tparam Scalar Scalar type of the matrix elements.
+ * @tparam StorageIndex Index type of the assembled sparse matrix.
+ */
+template <class Scalar, class StorageIndex = int>
+class TripletAssembler {
+public:
+    using SparseMatrix = Eigen::SparseMatrix<Scalar, Eigen::ColMajor, StorageIndex>;
+    using DenseMatrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+    using Triplet = Eigen::Triplet<Scalar, StorageIndex>;
+
+private:
+    Eigen::Index _rows{};
+    Eigen::Index _cols{};
+    std::vector<StorageIndex> _row_indices;
+    std::vector<StorageIndex> _col_indices;
+    std::vector<Scalar> _values;
+
+public:
+    TripletAssembler() = default;
+    /**
+     * @brief Prepare the assembly of a rows x cols matrix.
+     *
+     * @param rows Number of rows.
+     * @param cols Number of columns.
+     * @param expected_nnz Expected number of entries; used to reserve memory.
+     */
+    TripletAssembler(Eigen::Index rows, Eigen::Index cols, std::size_t expected_nnz = 0U)
+        : _rows(rows), _cols(cols) {
+        reserve(expected_nnz);
+    };
+
+    inline Eigen::Index rows() const noexcept { return _rows; }
+    inline Eigen::Index cols() const noexcept { return _cols; }
+    /**
+     * @brief Number of stored entries, including duplicates.
+     */
+    inline std::size_t size() const noexcept { return _values.size(); }
+
+    /**
+     * @brief Reserve memory for @p expected_nnz entries.
+     */
+    void reserve(std::size_t expected_nnz) {
+        _row_indices.reserve(expected_nnz);
+        _col_indices.reserve(expected_nnz);
+        _values.reserve(expected_nnz);
+    }
+    /**
+     * @brief Remove all entries while keeping the dimensions and the allocated memory.
+     */
+    void clear() noexcept {
+        _row_indices.clear();
+        _col_indices.clear();
+        _values.clear();
+    }
+
+    /**
+     * @brief Add @p value to the entry (row, col).
+     */
+    inline void add(Eigen::Index row, Eigen::Index col, const Scalar& value) { operator()(row, col) = value; }
+
+    /**
+     * @brief Append a new, zero-initialized entry at (row, col) and return a reference to its value.
+     *
+     * The reference is only valid until the next entry is added.
+     * As duplicates are summed, both `assembler(i, j) = x` and `assembler(i, j) += x` add x to the entry.
+     */
+    inline Scalar& operator()(Eigen::Index row, Eigen::Index col) {
+        assert(row >= 0 && row < _rows && col >= 0 && col < _cols);
+        _row_indices.push_back(static_cast<StorageIndex>(row));
+        _col_indices.push_back(static_cast<StorageIndex>(col));
+        return _values.emplace_back();
+    }
+
+    /**
+     * @brief Assemble the compressed sparse matrix; duplicates are summed.
+     */
+    SparseMatrix to_sparse() const {
+        std::vector<Triplet> triplets;
+        triplets.reserve(_values.size());
+        for (std::size_t i = 0U; i < _values.size(); ++i) {
+            triplets.emplace_back(_row_indices[i], _col_indices[i], _values[i]);
+        }
+        SparseMatrix matrix(_rows, _cols);
+        matrix.setFromTriplets(triplets.begin(), triplets.end());
+        return matrix;
+    }
+
+    /**
+     * @brief Assemble a dense matrix; duplicates are summed.
+     *
+     * Useful for algorithms that need a dense matrix anyway, e.g., the full eigendecompositions
+     * of XPResolvent, while still filling the matrix in the sparse fashion.
+     *
+     * @param matrix Output matrix; resized to rows() x cols() and overwritten.
+     */
+    template <class Derived>
+    void to_dense(Eigen::PlainObjectBase<Derived>& matrix) const {
+        matrix.setZero(_rows, _cols);
+        for (std::size_t i = 0U; i < _values.size(); ++i) {
+            matrix(_row_indices[i], _col_indices[i]) += _values[i];
+        }
+    }
+};
+}  // namespace mrock::iEoM
+#endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_SPARSEASSEMBLY_HPP
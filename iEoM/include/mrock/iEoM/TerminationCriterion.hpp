@@ -0,0 +1,218 @@
+#ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_TERMINATIONCRITERION_HPP
+#define MROCK_IEOM_INCLUDE_MROCK_IEOM_TERMINATIONCRITERION_HPP
+#include "ResolventDataTypes.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+namespace mrock::iEoM {
+/**
+ * @brief Adaptive stopping criteria for the Lanczos iteration.
+ *
+ * By default, no adaptive criterion is active and Lanczos runs for the requested number of iterations
+ * (or until the Krylov space is exhausted). Two criteria can be enabled, either separately or together:
+ *
+ * - Coefficient convergence: The asymptotic values a_inf and b_inf (here b refers to the unsquared beta)
+ *   are estimated as the mean over the last @p window coefficients. The iteration stops once all of these
+ *   coefficients deviate from the estimates by less than @p coefficient_tolerance, relative to
+ *   max(|a_inf|, b_inf). This is the C++ analog of ContinuedFraction.find_termination_depth in the
+ *   Python package, which afterwards replaces the tail by the terminator built from a_inf and b_inf.
+ * - Resolvent convergence: The continued fraction G(z) is evaluated on @p probe_grid + i @p broadening.
+ *   The iteration stops once the largest change of G between two checks is smaller than
+ *   @p resolvent_tolerance times the largest |G|. The grid lives in the eigenvalue variable of the
+ *   operator, e.g., omega^2 for XPResolvent.
+ *
+ * Both criteria are evaluated every @p check_every iterations, but not before @p min_iterations.
+ *
+ * @tparam RealType Numeric type of the recurrence coefficients.
+ */
+template <class RealType>
+struct TerminationCriterion {
+    /** Number of iterations before any adaptive criterion is evaluated. */
+    int min_iterations{20};
+    /** Cadence of the checks. */
+    int check_every{10};
+
+    /** Relative tolerance of the coefficient convergence; values <= 0 disable the criterion. */
+    RealType coefficient_tolerance{};
+    /** Number of trailing coefficients used to estimate a_inf and b_inf. */
+    int window{20};
+
+    /** Probe grid for G(z); an empty grid disables the criterion. */
+    std::vector<RealType> probe_grid;
+    /** Imaginary part added to the probe grid. */
+    RealType broadening{};
+    /** Relative tolerance of the resolvent convergence. */
+    RealType resolvent_tolerance{};
+
+    /**
+     * @brief Stop once the coefficients have converged to their asymptotic values.
+     *
+     * @param tolerance Relative tolerance.
+     * @param _window Number of trailing coefficients used to estimate the asymptotic values.
+     */
+    static TerminationCriterion coefficients(RealType tolerance, int _window = 20) {
+        TerminationCriterion criterion;
+        criterion.coefficient_tolerance = tolerance;
+        criterion.window = _window;
+        criterion.min_iterations = std::max(criterion.min_iterations, _window);
+        return criterion;
+    }
+    /**
+     * @brief Stop once the resolvent on a probe grid does not change anymore.
+     *
+     * @param grid Real part of the probe points.
+     * @param _broadening Imaginary part of the probe points; must be positive.
+     * @param tolerance Relative tolerance.
+     */
+    static TerminationCriterion resolvent(std::vector<RealType> grid, RealType _broadening, RealType tolerance) {
+        TerminationCriterion criterion;
+        criterion.probe_grid = std::move(grid);
+        criterion.broadening = _broadening;
+        criterion.resolvent_tolerance = tolerance;
+        return criterion;
+    }
+
+    /**
+     * @brief Whether any adaptive criterion is active.
+     */
+    inline bool enabled() const noexcept { return coefficient_tolerance > RealType{} || !probe_grid.empty(); }
+};
+
+/**
+ * @brief Convergence criterion of the Ritz pairs tracked by Resolvent::compute_with_residuals().
+ *
+ * A Ritz pair (theta, y) of the m x m tridiagonal matrix is converged once its residual
+ * ||A x - theta x|| = beta_m |y_m| is smaller than @p tolerance.
+ *
+ * @tparam RealType Numeric type of the recurrence coefficients.
+ */
+template <class RealType>
+struct ResidualCriterion {
+    /** Residual below which a Ritz pair counts as converged; defaults to ~sqrt(machine epsilon). */
+    RealType tolerance{1.49011612e-8};
+    /**
+     * Cadence of the convergence checks; each check costs O(n_residuals * iterations).
+     * Non-positive values check in every iteration.
+     */
+    int check_every{10};
+};
+
+namespace detail {
+/**
+ * @brief Evaluates a TerminationCriterion during one Lanczos run.
+ *
+ * Holds the state of the run, i.e., the resolvent on the probe grid from the previous check.
+ * Indexing follows the storage in Resolvent: alphas[k] belongs to q_k and betas[k] (k >= 1)
+ * couples q_(k-1) and q_k; betas[0] is a dummy entry.
+ *
+ * @tparam RealType Numeric type of the recurrence coefficients.
+ */
+template <class RealType>
+class TerminationMonitor {
+private:
+    using Complex = std::complex<RealType>;
+
+    const TerminationCriterion<RealType>& _criterion;
+    std::vector<Complex> _previous_resolvent;
+
+    bool coefficients_converged(const std::vector<RealType>& alphas, const std::vector<RealType>& betas) const {
+        const std::size_t n = alphas.size();
+        const std::size_t window = std::min<std::size_t>(_criterion.window, n);
+        if (window < 2U) {
+            return false;
+        }
+        RealType a_infinity{};
+        RealType b_infinity{};
+        for (std::size_t i = n - window; i < n; ++i) {
+            a_infinity += alphas[i];
+            b_infinity += betas[i + 1];
+        }
+        a_infinity /= window;
+        b_infinity /= window;
+
+        const RealType scale = std::max(std::abs(a_infinity), b_infinity);
+        for (std::size_t i = n - window; i < n; ++i) {
+            if (std::abs(alphas[i] - a_infinity) > _criterion.coefficient_tolerance * scale ||
+                std::abs(betas[i + 1] - b_infinity) > _criterion.coefficient_tolerance * scale) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool resolvent_converged(const std::vector<RealType>& alphas, const std::vector<RealType>& betas) {
+        const std::size_t n = alphas.size();
+        std::vector<Complex> resolvent(_criterion.probe_grid.size());
+        for (std::size_t k = 0U; k < resolvent.size(); ++k) {
+            const Complex z(_criterion.probe_grid[k], _criterion.broadening);
+            // Evaluate the truncated continued fraction from the bottom up
+            Complex value = z - alphas[n - 1];
+            for (std::size_t i = n - 1; i > 0U; --i) {
+                value = z - alphas[i - 1] - betas[i] * betas[i] / value;
+            }
+            resolvent[k] = RealType{1} / value;
+        }
+
+        bool converged = !_previous_resolvent.empty();
+        if (converged) {
+            RealType max_change{};
+            RealType max_value{};
+            for (std::size_t k = 0U; k < resolvent.size(); ++k) {
+                max_change = std::max(max_change, std::abs(resolvent[k] - _previous_resolvent[k]));
+                max_value = std::max(max_value, std::abs(resolvent[k]));
+            }
+            converged = max_change <= _criterion.resolvent_tolerance * max_value;
+        }
+        _previous_resolvent = std::move(resolvent);
+        return converged;
+    }
+
+public:
+    explicit TerminationMonitor(const TerminationCriterion<RealType>& criterion) : _criterion(criterion){};
+
+    /**
+     * @brief Decide whether the Lanczos iteration has to stop.
+     *
+     * @param iterNum Number of performed iterations, i.e., alphas.size().
+     * @param maxIter Maximum number of iterations.
+     * @param alphas Diagonal recurrence coefficients.
+     * @param betas Off-diagonal recurrence coefficients (unsquared), including the dummy betas[0].
+     * @param reason Set to the reason of termination if the iteration has to stop.
+     * @param allow_adaptive If false, only the maximum number of iterations and an invariant subspace stop the
+     *                       iteration, e.g., while tracked Ritz pairs have not converged yet.
+     * @return true if the iteration has to stop.
+     */
+    bool terminate(int iterNum,
+                   int maxIter,
+                   const std::vector<RealType>& alphas,
+                   const std::vector<RealType>& betas,
+                   TerminationReason& reason,
+                   bool allow_adaptive = true) {
+        if (std::abs(betas.back()) < 1e-10) {
+            reason = TerminationReason::INVARIANT_SUBSPACE;
+            return true;
+        }
+        if (allow_adaptive && _criterion.enabled() && iterNum >= _criterion.min_iterations &&
+            iterNum % std::max(_criterion.check_every, 1) == 0) {
+            if (_criterion.coefficient_tolerance > RealType{} && coefficients_converged(alphas, betas)) {
+                reason = TerminationReason::COEFFICIENTS_CONVERGED;
+                return true;
+            }
+            if (!_criterion.probe_grid.empty() && resolvent_converged(alphas, betas)) {
+                reason = TerminationReason::RESOLVENT_CONVERGED;
+                return true;
+            }
+        }
+        if (iterNum >= maxIter) {
+            reason = TerminationReason::MAX_ITERATIONS;
+            return true;
+        }
+        return false;
+    }
+};
+}  // namespace detail
+}  // namespace mrock::iEoM
+#endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_TERMINATIONCRITERION_HPP
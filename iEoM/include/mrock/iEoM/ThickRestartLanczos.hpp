@@ -0,0 +1,327 @@
+#ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_THICKRESTARTLANCZOS_HPP
+#define MROCK_IEOM_INCLUDE_MROCK_IEOM_THICKRESTARTLANCZOS_HPP
+#include "LinearOperator.hpp"
+#include "detail/KrylovBasis.hpp"
+#include "detail/UnderlyingRealType.hpp"
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace mrock::iEoM {
+/**
+ * @brief Thick-restart Lanczos eigensolver for the lowest eigenpairs of a Hermitian operator.
+ *
+ * Computes the n_eigenpairs lowest eigenpairs with a basis of at most max_basis_size vectors,
+ * i.e., O(n * max_basis_size) memory, see K. Wu and H. Simon, SIAM J. Matrix Anal. Appl. 22, 602 (2000).
+ * Once the basis is full, it is compressed to the lowest Ritz vectors and the residual vector,
+ * and the Lanczos recurrence continues from there. Converged Ritz pairs are locked, i.e.,
+ * they are decoupled from the recurrence and only kept for the reorthogonalization.
+ * Every new Lanczos vector is fully reorthogonalized against the basis.
+ *
+ * For a dense n x n matrix, the cost is O(n^2 * max_basis_size) per restart,
+ * compared to O(n^3) for a full diagonalization.
+ *
+ * @tparam EigenMatrixType Matrix type of the operator; dense or sparse.
+ * @tparam EigenVectorType Vector type of the eigenvectors.
+ */
+template <class EigenMatrixType, class EigenVectorType>
+class ThickRestartLanczos {
+public:
+    using Scalar = typename EigenVectorType::Scalar;
+    using RealType = detail::UnderlyingRealType_t<Scalar>;
+    using RealVector = Eigen::Vector<RealType, Eigen::Dynamic>;
+    using RealMatrix = Eigen::Matrix<RealType, Eigen::Dynamic, Eigen::Dynamic>;
+    using EigenvectorMatrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+
+private:
+    template <class Operator>
+    static constexpr bool is_operator = detail::ResolventOperator<Operator, EigenMatrixType, EigenVectorType>;
+
+    int _n_eigenpairs{};
+    int _max_basis_size{};
+
+    RealVector _eigenvalues;
+    EigenvectorMatrix _eigenvectors;
+    RealVector _residuals;
+    int _n_converged{};
+    int _n_restarts{};
+    int _n_operator_applications{};
+    RealType _norm_estimate{};
+
+public:
+    /** A Ritz pair is converged once its residual is below tolerance times the estimated norm of the operator. */
+    RealType tolerance{1e-10};
+    /** Maximum number of restarts. */
+    int max_restarts{1000};
+
+    /**
+     * @brief Prepare the eigensolver.
+     *
+     * @param n_eigenpairs Number of lowest eigenpairs to compute.
+     * @param max_basis_size Maximum number of basis vectors, i.e., the restart size.
+     *                       Values <= n_eigenpairs default to max(2 * n_eigenpairs, n_eigenpairs + 20).
+     */
+    explicit ThickRestartLanczos(int n_eigenpairs, int max_basis_size = 0)
+        : _n_eigenpairs(n_eigenpairs),
+          _max_basis_size(max_basis_size > n_eigenpairs ? max_basis_size
+                                                        : std::max(2 * n_eigenpairs, n_eigenpairs + 20)){};
+
+    /**
+     * @brief Compute the lowest eigenpairs.
+     *
+     * @param op Hermitian matrix or LinearOperator.
+     * @param starting_state Starting vector; if empty or zero, a deterministic vector without symmetries is used.
+     * @return true if all requested eigenpairs converged.
+     */
+    template <class Operator>
+        requires is_operator<Operator>
+    bool compute(const Operator& op, const EigenVectorType& starting_state = EigenVectorType{}) {
+        const Eigen::Index matrix_size = detail::operator_size<EigenVectorType>(op);
+        const Eigen::Index n_wanted = std::min<Eigen::Index>(_n_eigenpairs, matrix_size);
+        const Eigen::Index m = std::min<Eigen::Index>(_max_basis_size, matrix_size);
+        _n_restarts = 0;
+        _n_operator_applications = 0;
+        _norm_estimate = RealType{};
+
+        detail::KrylovBasis<EigenVectorType> basis(matrix_size, m + 1);
+        RealMatrix T = RealMatrix::Zero(m, m);
+        Eigen::Vector<Scalar, Eigen::Dynamic> couplings;  // Arrowhead couplings after a restart
+
+        std::mt19937_64 generator(0U);
+        std::uniform_real_distribution<RealType> distribution(-1, 1);
+        auto random_vector = [&]() {
+            const RealVector random = RealVector::NullaryExpr(matrix_size, [&]() { return distribution(generator); });
+            return EigenVectorType(random.template cast<Scalar>());
+        };
+
+        EigenVectorType w = starting_state.size() == matrix_size && !starting_state.isZero(RealType{})
+                                ? starting_state
+                                : RealVector::LinSpaced(matrix_size, 1, 2).template cast<Scalar>().eval();
+        basis.push_back(w.normalized());
+
+        Eigen::Index n_locked{};
+        Eigen::Index n_thick{};  // Number of vectors coupled to basis[n_thick] by the arrowhead
+        RealType beta{};
+        RealType norm_estimate{};
+        Eigen::SelfAdjointEigenSolver<RealMatrix> solver;
+        while (true) {
+            // Extend the basis to m vectors, starting from the last one
+            for (Eigen::Index j = basis.size() - 1; j < m; ++j) {
+                detail::apply_operator<EigenVectorType>(op, basis[j], w);
+                ++_n_operator_applications;
+                T(j, j) = std::real(basis[j].dot(w));
+                w -= T(j, j) * basis[j];
+                if (j == n_thick && n_thick > 0) {
+                    w.noalias() -= basis.active().leftCols(n_thick) * couplings;
+                } else if (j > 0) {
+                    w -= beta * basis[j - 1];
+                }
+                basis.orthogonalize(w);
+                beta = w.norm();
+
+                norm_estimate = std::max(norm_estimate, std::abs(T(j, j)) + beta);
+                _norm_estimate = norm_estimate;
+                if (beta < 10 * std::numeric_limits<RealType>::epsilon() * norm_estimate) {
+                    // Invariant subspace; continue with a random vector that is not coupled to the basis
+                    beta = RealType{};
+                    if (basis.size() < matrix_size) {
+                        w = random_vector();
+                        basis.orthogonalize(w);
+                        w.normalize();
+                    } else {
+                        w.setZero();
+                    }
+                } else {
+                    w /= beta;
+                }
+                if (j + 1 < m) {
+                    T(j, j + 1) = beta;
+                    T(j + 1, j) = beta;
+                }
+                basis.push_back(w);
+            }
+
+            // Ritz pairs of the active, i.e., not locked, part
+            const Eigen::Index n_active = m - n_locked;
+            solver.compute(T.bottomRightCorner(n_active, n_active));
+            const RealVector& theta = solver.eigenvalues();
+            const RealMatrix& Y = solver.eigenvectors();
+            const RealVector residuals = beta * Y.row(n_active - 1).transpose().cwiseAbs();
+            const RealType threshold = tolerance * norm_estimate;
+
+            Eigen::Index n_newly_locked{};
+            while (n_locked + n_newly_locked < n_wanted && residuals(n_newly_locked) < threshold) {
+                ++n_newly_locked;
+            }
+            if (n_locked + n_newly_locked >= n_wanted || _n_restarts >= max_restarts || n_active < 2) {
+                finalize(basis, T, n_locked, n_newly_locked, n_wanted, theta, Y, residuals);
+                return _n_converged >= n_wanted;
+            }
+
+            // Thick restart: keep the lowest Ritz vectors and the residual vector
+            const Eigen::Index n_missing = n_wanted - n_locked;
+            const Eigen::Index n_keep =
+                std::min(std::max(n_missing + (n_active - n_missing) / 2, n_newly_locked + 1), n_active - 1);
+            const EigenVectorType residual_vector = basis.back();
+            basis.compress(n_locked, Y.leftCols(n_keep).template cast<Scalar>());
+            basis.push_back(residual_vector);
+
+            T.bottomRightCorner(n_active, n_active).setZero();
+            n_thick = n_locked + n_keep;
+            couplings.setZero(n_thick);
+            for (Eigen::Index i = 0; i < n_keep; ++i) {
+                T(n_locked + i, n_locked + i) = theta(i);
+                // Locked vectors are decoupled, which introduces an error below the tolerance
+                const RealType coupling = i < n_newly_locked ? RealType{} : beta * Y(n_active - 1, i);
+                T(n_locked + i, n_thick) = coupling;
+                T(n_thick, n_locked + i) = coupling;
+                couplings(n_locked + i) = coupling;
+            }
+            n_locked += n_newly_locked;
+            ++_n_restarts;
+        }
+    }
+
+    /**
+     * @brief Compute the lowest eigenpairs that are visible from several starting vectors.
+     *
+     * A single Lanczos run only sees the eigenspaces its starting vector overlaps with, and only one vector of each
+     * degenerate eigenspace. Thus, compute() is run once per column of @p starting_states and once from the default
+     * starting vector, which catches modes without weight in any of the states. The eigenvectors of all runs are
+     * combined by a Rayleigh-Ritz projection onto their span, so that the result contains the projection of every
+     * starting state onto each of the lowest eigenspaces, also for degenerate eigenvalues.
+     *
+     * The cost is that of compute() times the number of runs, plus O(n * k^2) for the projection,
+     * where k is the total number of eigenvectors of all runs.
+     *
+     * @param op Hermitian matrix or LinearOperator.
+     * @param starting_states Starting vectors, one per column.
+     * @return true if all requested eigenpairs converged.
+     */
+    template <class Operator>
+        requires is_operator<Operator>
+    bool compute_from_states(const Operator& op, const EigenvectorMatrix& starting_states) {
+        const Eigen::Index matrix_size = detail::operator_size<EigenVectorType>(op);
+        const Eigen::Index n_wanted = std::min<Eigen::Index>(_n_eigenpairs, matrix_size);
+
+        EigenvectorMatrix ritz_vectors(matrix_size, 0);
+        int n_restarts{};
+        int n_operator_applications{};
+        RealType norm_estimate{};
+        for (Eigen::Index run = 0; run <= starting_states.cols(); ++run) {
+            if (run < starting_states.cols()) {
+                if (starting_states.col(run).isZero(RealType{}))
+                    continue;
+                compute(op, EigenVectorType(starting_states.col(run)));
+            } else {
+                compute(op);
+            }
+            n_restarts += _n_restarts;
+            n_operator_applications += _n_operator_applications;
+            norm_estimate = std::max(norm_estimate, _norm_estimate);
+            ritz_vectors.conservativeResize(Eigen::NoChange, ritz_vectors.cols() + _eigenvectors.cols());
+            ritz_vectors.rightCols(_eigenvectors.cols()) = _eigenvectors;
+        }
+
+        // Orthonormal basis of the span; runs that found the same eigenvector add no direction
+        Eigen::ColPivHouseholderQR<EigenvectorMatrix> qr(ritz_vectors);
+        qr.setThreshold(std::sqrt(std::numeric_limits<RealType>::epsilon()));
+        const EigenvectorMatrix basis = qr.householderQ() * EigenvectorMatrix::Identity(matrix_size, qr.rank());
+        EigenvectorMatrix op_basis(matrix_size, basis.cols());
+        EigenVectorType buffer(matrix_size);
+        for (Eigen::Index i = 0; i < basis.cols(); ++i) {
+            detail::apply_operator<EigenVectorType>(op, EigenVectorType(basis.col(i)), buffer);
+            op_basis.col(i) = buffer;
+        }
+        n_operator_applications += static_cast<int>(basis.cols());
+
+        const EigenvectorMatrix projected = basis.adjoint() * op_basis;
+        const Eigen::SelfAdjointEigenSolver<EigenvectorMatrix> solver(projected);
+        const Eigen::Index n_found = std::min(n_wanted, basis.cols());
+        _eigenvalues = solver.eigenvalues().head(n_found);
+        _eigenvectors.noalias() = basis * solver.eigenvectors().leftCols(n_found);
+        _residuals = (op_basis * solver.eigenvectors().leftCols(n_found) -
+                      _eigenvectors * _eigenvalues.template cast<Scalar>().asDiagonal())
+                         .colwise()
+                         .norm()
+                         .transpose();
+        _n_converged = static_cast<int>((_residuals.array() < tolerance * norm_estimate).count());
+        _n_restarts = n_restarts;
+        _n_operator_applications = n_operator_applications;
+        _norm_estimate = norm_estimate;
+        return _n_converged >= n_wanted;
+    }
+
+    /**
+     * @brief Lowest eigenvalues in ascending order.
+     */
+    inline const RealVector& eigenvalues() const noexcept { return _eigenvalues; }
+    /**
+     * @brief Eigenvectors belonging to eigenvalues(), one per column.
+     */
+    inline const EigenvectorMatrix& eigenvectors() const noexcept { return _eigenvectors; }
+    /**
+     * @brief Residual norms ||A x - lambda x|| of the eigenpairs.
+     */
+    inline const RealVector& residuals() const noexcept { return _residuals; }
+    /**
+     * @brief Number of converged eigenpairs.
+     */
+    inline int n_converged() const noexcept { return _n_converged; }
+    /**
+     * @brief Number of restarts of the last computation.
+     */
+    inline int n_restarts() const noexcept { return _n_restarts; }
+    /**
+     * @brief Number of operator applications of the last computation.
+     */
+    inline int n_operator_applications() const noexcept { return _n_operator_applications; }
+
+private:
+    void finalize(const detail::KrylovBasis<EigenVectorType>& basis,
+                  const RealMatrix& T,
+                  Eigen::Index n_locked,
+                  Eigen::Index n_newly_locked,
+                  Eigen::Index n_wanted,
+                  const RealVector& theta,
+                  const RealMatrix& Y,
+                  const RealVector& residuals) {
+        const Eigen::Index n_active = T.rows() - n_locked;
+        const Eigen::Index n_from_active = std::min(n_wanted - n_locked, n_active);
+        const Eigen::Index n_found = n_locked + n_from_active;
+
+        RealVector eigenvalues(n_found);
+        EigenvectorMatrix eigenvectors(basis.dimension(), n_found);
+        RealVector eigen_residuals = RealVector::Zero(n_found);
+        eigenvalues.head(n_locked) = T.diagonal().head(n_locked);
+        eigenvectors.leftCols(n_locked) = basis.active().leftCols(n_locked);
+        eigenvalues.tail(n_from_active) = theta.head(n_from_active);
+        eigenvectors.rightCols(n_from_active).noalias() =
+            basis.active().middleCols(n_locked, n_active) * Y.leftCols(n_from_active).template cast<Scalar>();
+        eigen_residuals.tail(n_from_active) = residuals.head(n_from_active);
+        _n_converged = static_cast<int>(n_locked + n_newly_locked);
+
+        // Locked values are not necessarily below the remaining ones
+        std::vector<Eigen::Index> order(n_found);
+        std::iota(order.begin(), order.end(), Eigen::Index{});
+        std::stable_sort(order.begin(), order.end(),
+                         [&](Eigen::Index a, Eigen::Index b) { return eigenvalues(a) < eigenvalues(b); });
+        _eigenvalues.resize(n_found);
+        _eigenvectors.resize(basis.dimension(), n_found);
+        _residuals.resize(n_found);
+        for (Eigen::Index i = 0; i < n_found; ++i) {
+            _eigenvalues(i) = eigenvalues(order[i]);
+            _eigenvectors.col(i) = eigenvectors.col(order[i]);
+            _residuals(i) = eigen_residuals(order[i]);
+        }
+    }
+};
+}  // namespace mrock::iEoM
+#endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_THICKRESTARTLANCZOS_HPP
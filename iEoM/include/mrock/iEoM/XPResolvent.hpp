@@ -1,10 +1,17 @@
 #ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_XPRESOLVENT_HPP
 #define MROCK_IEOM_INCLUDE_MROCK_IEOM_XPRESOLVENT_HPP
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
+#include <exception>
+#include <limits>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <numbers>
+#include <optional>
 #include <type_traits>
 
 #ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
@@ -15,9 +22,18 @@
 #endif  // ifndef _OPENMP
 #endif  // ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
 
+#include "BisectionEigenSolver.hpp"
+#include "BlockResolvent.hpp"
+#include "MemoryReport.hpp"
 #include "Resolvent.hpp"
+#include "SolverMatrixCache.hpp"
+#include "ThickRestartLanczos.hpp"
 #include "XPStartingState.hpp"
+#include "detail/Hermiticity.hpp"
+#include "detail/InPlaceProduct.hpp"
 #include "detail/PivotToBlockStructure.hpp"
+#include "detail/PositiveDefinite.hpp"
+#include "detail/SymmetricProduct.hpp"
 #include "detail/constexpr_power.hpp"
 #include "detail/internal_functions.hpp"
 #include "detail/xp_internal.hpp"
@@ -41,14 +57,25 @@ namespace mrock::iEoM {
  * @tparam n_residuals Number of residual eigenvectors to retain in full diagonalization
  * @tparam check_qr If true, validates QR decomposition accuracy via error norms
  *
- * @note Uses OpenMP for parallel eigenvalue solving of K_plus and K_minus when not disabled
+ * @note Uses OpenMP tasks for the pipeline (K eigensolves, solver matrices, Lanczos runs or diagonalization of
+ *       both channels) when not disabled; its memory footprint can be bounded via memory_limit
  * @note Maintains timing information for performance profiling via set_begin() and print_duration()
  * @note Supports optional Hermiticity checking for K_plus and K_minus matrices
+ * @note Setting lean diagonalizes in place and releases inputs early to lower the peak memory;
+ *       memory_report() returns the per-phase high-water marks of the last computation
+ * @note Eigenvectors are transformed back in batches; transforms with full column rank reuse the eigendecomposition
+ *       of K_plus or K_minus instead of a QR decomposition
+ * @note Positive definite K_plus and K_minus are Cholesky-factorized instead of diagonalized, and definiteness
+ *       checks try a Cholesky decomposition before an eigendecomposition
+ * @note Repeated parameter points can reuse their solver matrices via solver_matrix_cache
  *
  * Public Methods:
  * - compute_collective_modes(): Computes resolvent functions via Lanczos iteration
+ * - compute_collective_modes_block(): Same as compute_collective_modes() but advances all starting states of a
+ *   channel together via block Lanczos
  * - compute_collective_modes_with_residuals(): Extends computation with residual eigenvector information
  * - full_diagonalization(): Performs complete eigenvalue decomposition retaining first n_residuals eigenvectors
+ * - partial_diagonalization(): Same as full_diagonalization() but only for the lowest eigenpairs
  * - dynamic_matrix_is_negative(): Checks for negative eigenvalues in diagonal matrices
  *
  * Member Variables:
@@ -75,6 +102,7 @@ protected:
     using const_amplitude_it = detail::ConstAmplitudeIterator<RealType>;
 
     using StartingState = XPStartingState<RealType>;
+    using CacheEntry = SolverMatrixCacheEntry<RealType>;
 
     using TransformQR = std::conditional_t<!check_qr,
                                            Eigen::CompleteOrthogonalDecomposition<Eigen::Ref<Matrix>>,
@@ -88,7 +116,10 @@ private:
     const int _hermitian_size{};
     const int _antihermitian_size{};
     const bool _pivot{};
-    bool compute_transform{true};
+    SolverMatrixCacheKey _cache_key;
+    // Sizes of the phase and amplitude solver matrices, i.e., L.rows() and L.cols()
+    std::array<std::size_t, 2> _dimensions{};
+    mutable detail::MemoryTracker _memory;
 
     std::chrono::time_point<std::chrono::steady_clock> begin;
     std::chrono::time_point<std::chrono::steady_clock> end;
@@ -186,106 +217,183 @@ private:
     }
 
     /**
-     * @brief Diagonalize the K_plus and K_minus dynamical matrices.
+     * @brief Print the time elapsed since @p start.
+     *
+     * Unlike print_duration(), this does not touch any member and may be called from concurrent tasks.
+     */
+    static void print_elapsed(const char* message, const std::chrono::time_point<std::chrono::steady_clock>& start) {
+        std::cout << message
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start)
+                         .count()
+                  << "[ms]" << std::endl;
+    }
+
+    /**
+     * @brief Runs @p function with a budget of @p n_threads threads for Eigen's internal parallelization.
+     *
+     * Eigen runs its products sequentially if it is called from a parallel region with more than one thread,
+     * i.e., from within a pipeline task. Therefore, @p function is executed in a nested region of a single thread
+     * whose thread count is set to the budget, so that Eigen opens its own team of @p n_threads threads.
+     * This requires max-active-levels >= 2, see run_pipeline().
+     * @p function must not spawn tasks, as these would be bound to the single-thread region.
+     */
+    template <class Function>
+    static void with_thread_budget(int n_threads, Function&& function) {
+#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
+        omp_set_num_threads(std::max(n_threads, 1));
+#pragma omp parallel num_threads(1)
+        function();
+#else
+        function();
+#endif
+    }
+
+    /**
+     * @brief Fills the matrices and starting states and looks up the solver matrix cache.
      *
      * This function delegates to the derived class to fill the matrix blocks and
-     * to create starting states, optionally performs a Hermiticity check (when
-     * `CheckHermitian>0`), and then computes eigen-decompositions of both
-     * `K_plus` and `K_minus`. Eigen-solves are executed in parallel where
-     * permitted. After decomposition the on-device `K_plus` and `K_minus` storage
-     * is released (resized to 0).
+     * to create starting states, and optionally performs a Hermiticity check (when
+     * `CheckHermitian>0`).
+     * If solver_matrix_cache contains an entry for the current matrices, the on-device `K_plus` and `K_minus`
+     * storage is released (resized to 0) and the cached entry is returned.
+     * Starts a new memory report.
      *
      * @tparam CheckHermitian If positive, enable an additional Hermiticity
      *                        verification using a precision threshold of
      *                        10^-CheckHermitian.
-     * @return An array with two `detail::matrix_wrapper<Matrix>` entries holding
-     *         the eigenvalues and eigenvectors for `K_plus` (index 0) and
-     *         `K_minus` (index 1) respectively.
+     * @return The cached entry, or an empty entry that is filled by the pipeline.
      */
     template <int CheckHermitian = -1>
-    std::array<detail::matrix_wrapper<Matrix>, 2> diagonalize_K_matrices() {
+    std::shared_ptr<CacheEntry> prepare_entry() {
         set_begin();
+        _memory.reset();
+        const std::size_t filling = _memory.begin_phase("filling of M and N");
         fill_matrices();
         create_starting_states();
+        _dimensions = {static_cast<std::size_t>(L.rows()), static_cast<std::size_t>(L.cols())};
+        _memory.allocate(bytes(K_plus) + bytes(K_minus) + bytes(L));
 
         if constexpr (CheckHermitian > 0) {
-            if ((K_plus - K_plus.adjoint()).norm() >
-                detail::constexpr_power<-CheckHermitian, RealType, RealType>(10.)) {
+            if (!detail::is_hermitian(K_plus, detail::constexpr_power<-CheckHermitian, RealType, RealType>(10.))) {
                 throw std::runtime_error("K_plus is not Hermitian!");
             }
-            if ((K_minus - K_minus.adjoint()).norm() >
-                detail::constexpr_power<-CheckHermitian, RealType, RealType>(10.)) {
+            if (!detail::is_hermitian(K_minus, detail::constexpr_power<-CheckHermitian, RealType, RealType>(10.))) {
                 throw std::runtime_error("K_minus is not Hermitian!");
             }
         }
 
         print_duration("Time for filling of M and N: ");
-        std::array<detail::matrix_wrapper<Matrix>, 2> k_solutions;
-
-#ifdef _OPENMP
-        omp_set_nested(2);
-        Eigen::initParallel();
-#endif
-
-#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
-#pragma omp parallel sections
-#endif
-        {
-#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
-#pragma omp section
-#endif
-            {
-                set_begin();
-                if (_pivot) {
-                    k_solutions[0] = detail::matrix_wrapper<Matrix>::pivot_and_solve(K_plus);
-                } else {
-                    k_solutions[0] = detail::matrix_wrapper<Matrix>::only_solve(K_plus);
-                }
-                this->_internal.template apply_matrix_operation<detail::iEoM_operation::NONE>(
-                    k_solutions[0].eigenvalues, "K_+");
-                print_duration("Time for solving K_+: ", false);
-                // free the allocated memory
+        if (solver_matrix_cache) {
+            _cache_key = SolverMatrixCache<RealType>::key(K_plus, K_minus, L, _internal._sqrt_precision, _pivot,
+                                                          _internal._negative_matrix_is_error);
+            if (std::shared_ptr<CacheEntry> entry = solver_matrix_cache->find(_cache_key)) {
+                _memory.release(bytes(K_plus) + bytes(K_minus));
                 K_plus.resize(0, 0);
-            }
-#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
-#pragma omp section
-#endif
-            {
-                set_begin();
-                if (_pivot) {
-                    k_solutions[1] = detail::matrix_wrapper<Matrix>::pivot_and_solve(K_minus);
-                } else {
-                    k_solutions[1] = detail::matrix_wrapper<Matrix>::only_solve(K_minus);
-                }
-                this->_internal.template apply_matrix_operation<detail::iEoM_operation::NONE>(
-                    k_solutions[1].eigenvalues, "K_-");
-                print_duration("Time for solving K_-: ", false);
-                // free the allocated memory
                 K_minus.resize(0, 0);
+                _memory.allocate(entry->memory_usage());
+                _memory.end_phase(filling);
+                print_duration("Time for solver matrix cache lookup (hit): ");
+                return entry;
             }
         }
-        return k_solutions;
+        _memory.end_phase(filling);
+        return std::make_shared<CacheEntry>();
     }
 
     /**
-     * @brief Computes the solver matrix using eigen-decomposed K matrices.
+     * @brief Bytes of a dense matrix, see MemoryReport.
+     */
+    template <class Derived>
+    static std::size_t bytes(const Eigen::DenseBase<Derived>& matrix) noexcept {
+        return detail::MemoryTracker::bytes(matrix);
+    }
+
+    /**
+     * @brief Solves a symmetric matrix, in place if lean is set.
+     *
+     * @param matrix Matrix to solve; empty afterwards if lean is set.
+     */
+    detail::matrix_wrapper<Matrix> solve_symmetric(Matrix& matrix) {
+        const std::size_t matrix_bytes = bytes(matrix);
+        if (lean) {
+            if (_pivot) {
+                // The eigenvectors take over the storage of the matrix
+                return detail::matrix_wrapper<Matrix>::pivot_and_solve_in_place(matrix);
+            }
+            // The eigensolver's working copy becomes the eigenvectors once the matrix is released
+            _memory.allocate(matrix_bytes);
+            auto solution = detail::matrix_wrapper<Matrix>::solve_in_place(matrix);
+            _memory.release(matrix_bytes);
+            return solution;
+        }
+        // The eigensolver works on a copy of the matrix, whose eigenvectors are copied into the result
+        _memory.allocate(2U * matrix_bytes);
+        auto solution = _pivot ? detail::matrix_wrapper<Matrix>::pivot_and_solve(matrix)
+                               : detail::matrix_wrapper<Matrix>::only_solve(matrix);
+        _memory.release(matrix_bytes);
+        return solution;
+    }
+
+    /**
+     * @brief Decomposes K_plus (index 0) or K_minus (index 1) and releases its storage afterwards.
+     *
+     * If all eigenvalues of K exceed the pseudo-inverse threshold, the in-place Cholesky factor replaces
+     * the eigendecomposition, see SolverMatrixCacheEntry::k_cholesky. Otherwise, K is diagonalized,
+     * which also detects negative eigenvalues.
+     *
+     * @param entry Receives the decomposition in `k_solutions[index]`.
+     */
+    template <std::size_t index>
+    void solve_K(CacheEntry& entry) {
+        const auto start = std::chrono::steady_clock::now();
+        const std::size_t phase = _memory.begin_phase(index == 0 ? "K_+ eigensolve" : "K_- eigensolve");
+        Matrix& K = index == 0 ? K_plus : K_minus;
+        const std::size_t K_bytes = bytes(K);
+        entry.k_cholesky[index] = detail::cholesky_in_place_if_above(K, _internal._sqrt_precision);
+        if (entry.k_cholesky[index]) {
+            // The factor takes over the storage of K
+            entry.k_solutions[index].eigenvalues = Vector::Ones(K.rows());
+            entry.k_solutions[index].eigenvectors = std::move(K);
+            K.resize(0, 0);
+            print_elapsed(index == 0 ? "Time for factorizing K_+: " : "Time for factorizing K_-: ", start);
+            _memory.end_phase(phase);
+            return;
+        }
+        entry.k_solutions[index] = solve_symmetric(K);
+        this->_internal.template apply_matrix_operation<detail::iEoM_operation::NONE>(
+            entry.k_solutions[index].eigenvalues, index == 0 ? "K_+" : "K_-");
+        print_elapsed(index == 0 ? "Time for solving K_+: " : "Time for solving K_-: ", start);
+        if (!lean) {
+            // free the allocated memory
+            K.resize(0, 0);
+            _memory.release(K_bytes);
+        }
+        _memory.end_phase(phase);
+    }
+
+    /**
+     * @brief Computes N_new^(-1/2) of a channel.
+     *
+     * N_new = (L V) K_EV^(-1) (L V)^T and its inverse square root are formed by symmetric rank-k updates.
+     * Only needs the decomposition of the K matrix with index @p minus_index. For a Cholesky factor C,
+     * L V K_EV^(-1/2) = L C^(-T) is a triangular solve instead.
      *
      * @tparam plus_index Index of the K matrix corresponding to the Hermitian block in the assembled solver.
      * @tparam minus_index Index of the K matrix corresponding to the anti-Hermitian block in the assembled solver.
-     * @tparam StateTransformPolicy Transformation functor applied to each starting state.
      *
-     * @param k_solutions Eigen-decomposed K_plus and K_minus wrapped matrices.
-     * @param solver_matrix Output matrix that will contain the computed solver matrix.
-     * @param transform Functor used to transform each starting state with the computed N_new matrix.
+     * @param entry Holds the decompositions of K_plus and K_minus.
+     * @param full_column_rank Receives whether rank(N_new) equals the size of K_minus, i.e., whether the transform
+     *                         N_new^(-1/2) L has full column rank, see with_transform_solver().
+     * @return N_new^(-1/2), stored in full.
      *
      * To compute the Hermitian solver part use plus_index = 0 and minus_index = 1.
      * To compute the anti-Hermitian solver part use plus_index = 1 and minus_index = 0.
      */
-    template <std::size_t plus_index, std::size_t minus_index, class StateTransformPolicy>
-    void compute_solver_matrix_impl(const std::array<detail::matrix_wrapper<Matrix>, 2>& k_solutions,
-                                    Matrix& solver_matrix,
-                                    StateTransformPolicy&& transform) {
-        set_begin();
+    template <std::size_t plus_index, std::size_t minus_index>
+    Matrix inverse_sqrt_N_new(const CacheEntry& entry, bool& full_column_rank) {
+        const auto& k_solutions = entry.k_solutions;
+        auto start = std::chrono::steady_clock::now();
+        const std::size_t phase = _memory.begin_phase(plus_index == 0 ? "phase N_new" : "amplitude N_new");
         Vector K_EV = k_solutions[minus_index].eigenvalues;
         _internal.template apply_matrix_operation<detail::iEoM_operation::INVERSE>(K_EV,
                                                                                    plus_index == 1 ? "K_+" : "K_-");
@@ -296,88 +404,543 @@ private:
                 return (L);
         }();
 
-        const auto buffer_matrix = L_view * k_solutions[minus_index].eigenvectors;
-        Matrix N_new = buffer_matrix * K_EV.asDiagonal() * buffer_matrix.adjoint();
-
-        print_duration("Time for computing N_new: ");
+        // N_new = (L V) K_EV (L V)^T; both N_new and solver_matrix are formed by symmetric rank-k updates
+        Matrix N_new;
         {
-            auto n_solution = _pivot ? detail::matrix_wrapper<Matrix>::pivot_and_solve(N_new)
-                                     : detail::matrix_wrapper<Matrix>::only_solve(N_new);
-            _internal.template apply_matrix_operation<detail::iEoM_operation::INVERSE_SQRT>(
-                n_solution.eigenvalues, plus_index == 1 ? "+: N_new" : "-: N_new");
-            // Starting here, N_new = 1/sqrt(N_new)
-            // I forego another matrix to save some memory
-            N_new.noalias() =
-                n_solution.eigenvectors * n_solution.eigenvalues.asDiagonal() * n_solution.eigenvectors.adjoint();
-            for (auto& starting_state : starting_states) {
-                if (starting_state[plus_index].size() > 0U) {
-                    transform(starting_state[plus_index], N_new);
+            Matrix factor;
+            if (entry.k_cholesky[minus_index]) {
+                factor = L_view;
+                k_solutions[minus_index]
+                    .eigenvectors.transpose()
+                    .template triangularView<Eigen::Upper>()
+                    .template solveInPlace<Eigen::OnTheRight>(factor);
+            } else {
+                factor.noalias() = L_view * k_solutions[minus_index].eigenvectors;
+            }
+            _memory.allocate(bytes(factor) + _dimensions[plus_index] * _dimensions[plus_index] * sizeof(RealType));
+            detail::symmetric_product_lower(N_new, factor, K_EV);
+            _memory.release(bytes(factor));
+        }
+        const std::size_t N_bytes = bytes(N_new);
+        if (_pivot) {
+            // Pivoting needs the full matrix, whereas only_solve() only reads the lower triangle
+            detail::mirror_lower_triangle(N_new);
+        }
+
+        print_elapsed("Time for computing N_new: ", start);
+        start = std::chrono::steady_clock::now();
+        auto n_solution = solve_symmetric(N_new);
+        if (lean) {
+            // N_new^(-1/2) needs its own storage again
+            _memory.allocate(N_bytes);
+        }
+        _internal.template apply_matrix_operation<detail::iEoM_operation::INVERSE_SQRT>(
+            n_solution.eigenvalues, plus_index == 1 ? "+: N_new" : "-: N_new");
+        full_column_rank = (n_solution.eigenvalues.array() != RealType{}).count() ==
+                           static_cast<Eigen::Index>(_dimensions[minus_index]);
+        // Starting here, N_new = 1/sqrt(N_new)
+        // I forego another matrix to save some memory
+        detail::symmetric_product_lower(N_new, n_solution.eigenvectors, n_solution.eigenvalues);
+        detail::mirror_lower_triangle(N_new);
+        _memory.release(bytes(n_solution.eigenvectors));
+        print_elapsed("Time for adjusting N_new: ", start);
+        _memory.end_phase(phase);
+        return N_new;
+    }
+
+    /**
+     * @brief Transforms the starting states of a channel, |s> -> N_new^(-1/2) L |s>.
+     *
+     * @param inverse_sqrt_N N_new^(-1/2) of the channel.
+     * @param transform_matrix If not nullptr, receives N_new^(-1/2) L, which then transforms the states.
+     *                         Otherwise, L and N_new^(-1/2) are applied one after the other.
+     */
+    template <std::size_t plus_index, std::size_t minus_index>
+    void transform_starting_states(const Matrix& inverse_sqrt_N, Matrix* transform_matrix) {
+        if (transform_matrix) {
+            if constexpr (minus_index == 0) {
+                transform_matrix->noalias() = inverse_sqrt_N * L.transpose();
+            } else {
+                transform_matrix->noalias() = inverse_sqrt_N * L;
+            }
+            _memory.allocate(bytes(*transform_matrix));
+            apply_transform<plus_index>(*transform_matrix);
+            return;
+        }
+        for (auto& starting_state : starting_states) {
+            if (starting_state[plus_index].size() > 0U) {
+                if constexpr (minus_index == 0) {
+                    starting_state[plus_index].applyOnTheLeft(L.transpose());
+                } else {
+                    starting_state[plus_index].applyOnTheLeft(L);
                 }
+                starting_state[plus_index].applyOnTheLeft(inverse_sqrt_N);
             }
         }
-        print_duration("Time for adjusting N_new: ");
-        N_new *= k_solutions[plus_index].eigenvectors;
-        solver_matrix.noalias() = N_new * k_solutions[plus_index].eigenvalues.asDiagonal() * N_new.adjoint();
+    }
 
-        print_duration("Time for computing solver_matrix: ");
+    /**
+     * @brief Applies the (cached) transform matrix to the starting states of a channel.
+     */
+    template <std::size_t channel>
+    void apply_transform(const Matrix& transform_matrix) {
+        for (auto& starting_state : starting_states) {
+            if (starting_state[channel].size() > 0U) {
+                starting_state[channel].applyOnTheLeft(transform_matrix);
+            }
+        }
     }
 
     /**
-     * @brief Computes solver_matrix and applies the standard state transformation.
+     * @brief Forms the solver matrix N_new^(-1/2) V K_EV V^T N_new^(-1/2) of a channel by a symmetric rank-k update.
      *
-     * @tparam plus_index Index of the Hermitian block within the assembled solver.
-     * @tparam minus_index Index of the anti-Hermitian block within the assembled solver.
+     * The solver matrix takes over the storage of N_new^(-1/2).
      *
-     * @param k_solutions Eigen-decomposed K_plus and K_minus wrapped matrices.
-     * @param solver_matrix Output matrix populated by the solver computation.
+     * @tparam plus_index Index of the K matrix corresponding to the Hermitian block in the assembled solver.
      *
-     * Uses the standard state transform path for phase and amplitude states.
+     * @param inverse_sqrt_N N_new^(-1/2) of the channel; empty afterwards.
+     * @param k_solution Eigen-decomposition of the K matrix with index @p plus_index.
+     * @param solver_matrix Output matrix that will contain the computed solver matrix.
+     * @param consume_eigenvectors If true, @p k_solution is overwritten in place and released afterwards.
      */
-    template <std::size_t plus_index, std::size_t minus_index>
-    void compute_solver_matrix(const std::array<detail::matrix_wrapper<Matrix>, 2>& k_solutions,
-                               Matrix& solver_matrix) {
-        compute_solver_matrix_impl<plus_index, minus_index>(k_solutions, solver_matrix,
-                                                            [this](Vector& state, const Matrix& N_new) {
-                                                                if constexpr (minus_index == 0) {
-                                                                    state.applyOnTheLeft(L.transpose());
-                                                                } else {
-                                                                    state.applyOnTheLeft(L);
-                                                                }
-                                                                state.applyOnTheLeft(N_new);
-                                                            });
+    template <std::size_t plus_index>
+    void form_solver_matrix(Matrix& inverse_sqrt_N,
+                            detail::matrix_wrapper<Matrix>& k_solution,
+                            Matrix& solver_matrix,
+                            bool consume_eigenvectors) {
+        const auto start = std::chrono::steady_clock::now();
+        const std::size_t phase =
+            _memory.begin_phase(plus_index == 0 ? "phase solver matrix" : "amplitude solver matrix");
+        if (consume_eigenvectors) {
+            detail::multiply_on_the_left_in_place(inverse_sqrt_N, k_solution.eigenvectors);
+            detail::symmetric_product_lower(inverse_sqrt_N, k_solution.eigenvectors, k_solution.eigenvalues);
+            _memory.release(bytes(k_solution.eigenvectors));
+            k_solution = detail::matrix_wrapper<Matrix>{};
+        } else {
+            Matrix factor = inverse_sqrt_N * k_solution.eigenvectors;
+            _memory.allocate(bytes(factor));
+            detail::symmetric_product_lower(inverse_sqrt_N, factor, k_solution.eigenvalues);
+            _memory.release(bytes(factor));
+        }
+        // The Lanczos iterations need the full matrix
+        detail::mirror_lower_triangle(inverse_sqrt_N);
+        solver_matrix = std::move(inverse_sqrt_N);
+        inverse_sqrt_N.resize(0, 0);
+        print_elapsed("Time for computing solver_matrix: ", start);
+        _memory.end_phase(phase);
+    }
+
+    /**
+     * @brief Marks one use of the decomposition of K_plus (index 0) or K_minus (index 1) as done.
+     *
+     * After the last use, the decomposition is released unless it is cached.
+     */
+    void release_k_solution(CacheEntry& entry, std::atomic<int>& remaining_uses, std::size_t index) {
+        if (--remaining_uses > 0 || solver_matrix_cache)
+            return;
+        std::lock_guard<std::mutex> lock(entry.mutex);
+        _memory.release(bytes(entry.k_solutions[index].eigenvectors));
+        entry.k_solutions[index] = detail::matrix_wrapper<Matrix>{};
+    }
+
+    /**
+     * @brief Shared state of the tasks created by run_pipeline().
+     */
+    struct PipelineState {
+        std::shared_ptr<CacheEntry> entry;
+        std::array<Matrix, 2> inverse_sqrt_N;
+        std::array<Matrix, 2> solver_matrices;
+        std::array<Matrix, 2> transform_matrices;
+        // Sentinels of the task dependencies
+        std::array<char, 2> k_ready{};
+        std::array<char, 2> inverse_ready{};
+        std::array<char, 2> channel_done{};
+        char no_dependency{};
+        // Number of channels that still need the decomposition of K_plus and K_minus, and L, respectively
+        std::array<std::atomic<int>, 2> k_uses{};
+        std::atomic<int> L_uses{};
+        std::array<bool, 2> full_column_rank{};
+        // The first exception thrown by a task; the remaining tasks are skipped
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        std::atomic<bool> failed{false};
+        bool with_transform{};
+        // Whether the channel work solves with the transform, which may need the decomposition of K_(1-c)
+        bool transform_solves{};
+        bool concurrent_channels{true};
+        int n_threads{1};
+    };
+
+    /**
+     * @brief Runs @p function unless a previous task failed, and records its exception otherwise.
+     */
+    template <class Function>
+    static void run_task(PipelineState* state, Function&& function) {
+        if (state->failed)
+            return;
+        try {
+            function();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(state->error_mutex);
+            if (!state->error) {
+                state->error = std::current_exception();
+            }
+            state->failed = true;
+        }
+    }
+
+    /**
+     * @brief Creates the task that diagonalizes K_plus (index 0) or K_minus (index 1).
+     */
+    template <std::size_t index>
+    void schedule_K(PipelineState* state) {
+        [[maybe_unused]] char* k_ready = state->k_ready.data();
+#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
+#pragma omp task depend(out : k_ready[index : 1])
+#endif
+        run_task(state, [this, state]() {
+            with_thread_budget(state->n_threads / 2, [this, state]() { solve_K<index>(*state->entry); });
+        });
+    }
+
+    /**
+     * @brief Creates the tasks of a channel, see run_pipeline().
+     */
+    template <std::size_t plus_index, std::size_t minus_index, class ChannelWork>
+    void schedule_channel(PipelineState* state, ChannelWork* channel_work) {
+        [[maybe_unused]] char* k_ready = state->k_ready.data();
+        [[maybe_unused]] char* inverse_ready = state->inverse_ready.data();
+        [[maybe_unused]] char* channel_done = state->channel_done.data();
+        // Without enough memory for both channels at once, the amplitude channel waits for the phase channel
+        [[maybe_unused]] char* wait_for =
+            (plus_index == 1 && !state->concurrent_channels) ? channel_done : &state->no_dependency;
+        const int n_threads = state->concurrent_channels ? state->n_threads / 2 : state->n_threads;
+
+#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
+#pragma omp task depend(in : k_ready[minus_index : 1], wait_for[0 : 1]) depend(out : inverse_ready[plus_index : 1])
+#endif
+        run_task(state, [this, state, n_threads]() {
+            CacheEntry& entry = *state->entry;
+            std::unique_lock<std::mutex> lock(entry.mutex);
+            if (entry.has_channel(plus_index)) {
+                apply_transform<plus_index>(entry.transform_matrices[plus_index]);
+                state->full_column_rank[plus_index] = entry.full_column_rank[plus_index];
+                lock.unlock();
+            } else {
+                lock.unlock();
+                with_thread_budget(n_threads, [&]() {
+                    state->inverse_sqrt_N[plus_index] = inverse_sqrt_N_new<plus_index, minus_index>(
+                        entry, state->full_column_rank[plus_index]);
+                    transform_starting_states<plus_index, minus_index>(
+                        state->inverse_sqrt_N[plus_index],
+                        state->with_transform ? &state->transform_matrices[plus_index] : nullptr);
+                });
+                release_k_solution(entry, state->k_uses[minus_index], minus_index);
+            }
+            if (state->transform_solves && !state->full_column_rank[plus_index]) {
+                // The channel work solves with a QR decomposition instead
+                release_k_solution(entry, state->k_uses[minus_index], minus_index);
+            }
+            if (--state->L_uses == 0 && lean) {
+                // L is only needed for the transformation of the starting states
+                _memory.release(bytes(L));
+                L.resize(0, 0);
+            }
+        });
+
+#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
+#pragma omp task depend(in : k_ready[plus_index : 1], inverse_ready[plus_index : 1]) \
+    depend(out : channel_done[plus_index : 1])
+#endif
+        run_task(state, [this, state, n_threads, channel_work]() {
+            CacheEntry& entry = *state->entry;
+            if (state->inverse_sqrt_N[plus_index].size() > 0) {
+                // In lean mode, the last user of the eigenvectors of K_c overwrites them
+                const bool consume = lean && !solver_matrix_cache && state->k_uses[plus_index] == 1;
+                with_thread_budget(n_threads, [&]() {
+                    form_solver_matrix<plus_index>(state->inverse_sqrt_N[plus_index], entry.k_solutions[plus_index],
+                                                   state->solver_matrices[plus_index], consume);
+                });
+                release_k_solution(entry, state->k_uses[plus_index], plus_index);
+                std::lock_guard<std::mutex> lock(entry.mutex);
+                // Another object sharing the entry may have been faster; both results are identical
+                if (!entry.has_channel(plus_index)) {
+                    entry.solver_matrices[plus_index] = std::move(state->solver_matrices[plus_index]);
+                    entry.transform_matrices[plus_index] = std::move(state->transform_matrices[plus_index]);
+                    entry.full_column_rank[plus_index] = state->full_column_rank[plus_index];
+                    entry.modified = entry.modified || static_cast<bool>(solver_matrix_cache);
+                }
+            }
+            const std::size_t phase = _memory.begin_phase(plus_index == 0 ? "phase work" : "amplitude work");
+            (*channel_work)(std::integral_constant<std::size_t, plus_index>{}, entry, n_threads);
+            _memory.end_phase(phase);
+            if (state->transform_solves && state->full_column_rank[plus_index]) {
+                release_k_solution(entry, state->k_uses[minus_index], minus_index);
+            }
+            finish_channel(entry, plus_index);
+        });
     }
 
     /**
-     * @brief Computes solver_matrix and applies a custom transformation matrix.
+     * @brief Runs the XPResolvent pipeline as a graph of dependent OpenMP tasks.
      *
-     * @tparam plus_index Index of the Hermitian block within the assembled solver.
-     * @tparam minus_index Index of the anti-Hermitian block within the assembled solver.
+     * The tasks and their dependencies are, for the phase channel (c = 0) and the amplitude channel (c = 1),
+     *  - the diagonalization of K_+ and of K_-,
+     *  - N_new^(-1/2) of channel c and the transformation of its starting states; needs K_(1-c), i.e., it overlaps
+     *    with the diagonalization of K_c,
+     *  - the solver matrix of channel c followed by @p channel_work; needs K_c.
+     *    @p channel_work may spawn further tasks, e.g., one per starting state, see spawn_state_tasks().
+     * Cached parts are skipped. The dense-algebra tasks share the threads for Eigen's internal parallelization,
+     * see with_thread_budget(). If memory_limit does not allow both channels at once or in lean mode, the
+     * amplitude channel is only started once the phase channel is done; it then gets all threads.
+     * Decompositions are released after their last use unless they are cached; if @p channel_work solves with the
+     * transform, this includes the solves, see with_transform_solver().
+     * Without OpenMP, the tasks run sequentially in the order given above.
      *
-     * @param k_solutions Eigen-decomposed K_plus and K_minus wrapped matrices.
-     * @param solver_matrix Output matrix populated by the solver computation.
-     * @param transform_matrix Matrix used to transform each state before applying it to the solver.
+     * @tparam CheckHermitian If >0, enables runtime Hermiticity checks against precision 10^-CheckHermitian.
+     * @param with_transform Whether @p channel_work needs `entry.transform_matrices`, i.e., calls
+     *                       with_transform_solver().
+     * @param channel_work Callable `(std::integral_constant<std::size_t, c>, CacheEntry& entry, int n_threads)`,
+     *                     where `entry.solver_matrices[c]` holds the solver matrix and @p n_threads is the budget
+     *                     for dense algebra.
+     */
+    template <int CheckHermitian, class ChannelWork>
+    void run_pipeline(bool with_transform, ChannelWork&& channel_work) {
+        PipelineState state;
+        state.entry = prepare_entry<CheckHermitian>();
+        state.with_transform = with_transform || static_cast<bool>(solver_matrix_cache);
+        const bool solve_k = state.entry->k_solutions[0].eigenvalues.size() == 0;
+        state.concurrent_channels =
+            !lean &&
+            (memory_limit == 0U || resident_memory() + formation_memory(0) + formation_memory(1) <= memory_limit);
+        // K_c is used by N_new of channel 1-c and by the solver matrix of channel c
+        const int n_channels =
+            static_cast<int>(phase_size(starting_states) > 0) + static_cast<int>(amplitude_size(starting_states) > 0);
+        state.k_uses[0] = n_channels;
+        state.k_uses[1] = n_channels;
+        state.L_uses = n_channels;
+        // Without residuals, with_transform_solver() never solves
+        state.transform_solves = with_transform && n_residuals > 0;
+        if (state.transform_solves) {
+            // ... and channel c may solve with the transform using K_(1-c)
+            state.k_uses[1] += static_cast<int>(phase_size(starting_states) > 0);
+            state.k_uses[0] += static_cast<int>(amplitude_size(starting_states) > 0);
+        }
+
+#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
+        Eigen::initParallel();
+        // Eigen's parallel regions are nested into the pipeline's region; the caller's setting is restored afterwards
+        const int previous_max_active_levels = omp_get_max_active_levels();
+        if (previous_max_active_levels < 2) {
+            omp_set_max_active_levels(2);
+        }
+        state.n_threads = omp_get_max_threads();
+#endif
+        set_begin();
+        PipelineState* state_ptr = &state;
+        auto* work_ptr = &channel_work;
+#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
+#pragma omp parallel
+#pragma omp single
+#endif
+        {
+            if (solve_k) {
+                schedule_K<0>(state_ptr);
+                schedule_K<1>(state_ptr);
+            }
+            if (phase_size(starting_states) > 0) {
+                schedule_channel<0, 1>(state_ptr, work_ptr);
+            }
+            if (amplitude_size(starting_states) > 0) {
+                schedule_channel<1, 0>(state_ptr, work_ptr);
+            }
+        }
+#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
+        omp_set_max_active_levels(previous_max_active_levels);
+#endif
+        if (state.error) {
+            std::rethrow_exception(state.error);
+        }
+        print_duration("Time for the pipeline: ");
+        store_in_cache(state.entry);
+    }
+
+    /**
+     * @brief Runs @p function(i) for i in [0, n_states) as tasks and waits for them.
+     *
+     * At most as many tasks as memory_limit allows run at once, i.e., the states are distributed round-robin
+     * over these tasks. As in run_task(), the first exception skips the remaining states; it is rethrown once all
+     * tasks are done, so that it reaches the enclosing pipeline task.
      *
-     * Uses a precomputed transformation matrix to update the solver state vectors.
+     * @param bytes_per_state Estimated memory of one call.
      */
-    template <std::size_t plus_index, std::size_t minus_index>
-    void compute_solver_matrix(const std::array<detail::matrix_wrapper<Matrix>, 2>& k_solutions,
-                               Matrix& solver_matrix,
-                               Matrix& transform_matrix) {
-        compute_transform = true;
-        compute_solver_matrix_impl<plus_index, minus_index>(
-            k_solutions, solver_matrix, [this, &transform_matrix](Vector& state, const Matrix& N_new) {
-                if (!compute_transform) {
-                    state.applyOnTheLeft(transform_matrix);
-                    return;
-                }
+    template <class Function>
+    void spawn_state_tasks(int n_states, std::size_t bytes_per_state, const Function& function) const {
+        int n_tasks = n_states;
+        if (memory_limit > 0U && bytes_per_state > 0U) {
+            const std::size_t available = memory_limit > resident_memory() ? memory_limit - resident_memory() : 0U;
+            n_tasks = static_cast<int>(std::clamp<std::size_t>(available / bytes_per_state, 1U,
+                                                               static_cast<std::size_t>(std::max(n_states, 1))));
+        }
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        std::atomic<bool> failed{false};
 
-                if constexpr (minus_index == 0) {
-                    transform_matrix.noalias() = N_new * L.transpose();
-                } else {
-                    transform_matrix.noalias() = N_new * L;
+        _memory.allocate(static_cast<std::size_t>(n_tasks) * bytes_per_state);
+        for (int task = 0; task < n_tasks; ++task) {
+#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
+#pragma omp task firstprivate(task) shared(error, error_mutex, failed)
+#endif
+            for (int i = task; i < n_states && !failed; i += n_tasks) {
+                try {
+                    function(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                    failed = true;
                 }
-                state.applyOnTheLeft(transform_matrix);
-            });
+            }
+        }
+#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
+#pragma omp taskwait
+#endif
+        _memory.release(static_cast<std::size_t>(n_tasks) * bytes_per_state);
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    /**
+     * @brief Size of the solver matrix of a channel.
+     */
+    std::size_t channel_dimension(std::size_t channel) const noexcept {
+        return _dimensions[channel];
+    }
+
+    /**
+     * @brief Estimated memory that is occupied during the whole pipeline, i.e., by the K eigenvectors and the
+     * solver matrices.
+     */
+    std::size_t resident_memory() const noexcept {
+        return 2U * (channel_dimension(0) * channel_dimension(0) + channel_dimension(1) * channel_dimension(1)) *
+               sizeof(RealType);
+    }
+
+    /**
+     * @brief Estimated peak memory of the formation of the solver matrix of a channel.
+     */
+    std::size_t formation_memory(std::size_t channel) const noexcept {
+        const std::size_t n = channel_dimension(channel);
+        return (3U * n * n + 2U * n * channel_dimension(1 - channel)) * sizeof(RealType);
+    }
+
+    /**
+     * @brief Estimated memory of the Lanczos iterations for one starting state of a channel.
+     */
+    std::size_t lanczos_memory(std::size_t channel, unsigned int n_lanczos_iterations) const noexcept {
+        return (n_lanczos_iterations + 4U) * channel_dimension(channel) * sizeof(RealType);
+    }
+
+    /**
+     * @brief Resolvents of the (transformed) starting states of a channel.
+     */
+    template <std::size_t channel>
+    std::vector<Resolvent<Matrix, Vector>> channel_resolvents() const {
+        using iterator_type = std::conditional_t<channel == 0, const_phase_it, const_amplitude_it>;
+        std::vector<Resolvent<Matrix, Vector>> resolvents(channel == 0 ? phase_size(starting_states)
+                                                                       : amplitude_size(starting_states));
+        auto resolvent_it = resolvents.begin();
+        for (iterator_type it = iterator_type::begin(starting_states); it != iterator_type::end(starting_states);
+             ++resolvent_it, ++it) {
+            resolvent_it->set_starting_state(it.state());
+            if (resolvent_it->data.name.empty())
+                resolvent_it->data.name = (channel == 0 ? "phase_" : "amplitude_") + it->name;
+        }
+        return resolvents;
+    }
+
+    /**
+     * @brief Least-squares solver of T x = u for a transform T = N_new^(-1/2) L with full column rank.
+     *
+     * With the decomposition K = V diag(lambda) V^T of the K matrix of the other channel,
+     * T K^(-1) T^T = N_new^(-1/2) N_new N_new^(-1/2) is the projector onto the range of T. Hence,
+     * x = V diag(1/lambda) V^T T^T u fulfills the normal equations, which have a unique solution for full column
+     * rank. This costs four matrix products instead of the O(n^3) QR decomposition of T.
+     * For a Cholesky factor K = C C^T, x = C^(-T) C^(-1) T^T u are two triangular solves instead.
+     */
+    struct FactorTransformSolver {
+        const Matrix* transform_matrix{};
+        const Matrix* eigenvectors{};
+        Vector inverse_eigenvalues;
+        bool cholesky{};
+
+        template <class Rhs>
+        Matrix solve(const Eigen::MatrixBase<Rhs>& rhs) const {
+            if (cholesky) {
+                Matrix x = transform_matrix->transpose() * rhs;
+                eigenvectors->template triangularView<Eigen::Lower>().solveInPlace(x);
+                eigenvectors->transpose().template triangularView<Eigen::Upper>().solveInPlace(x);
+                return x;
+            }
+            const Matrix projected = eigenvectors->transpose() * (transform_matrix->transpose() * rhs);
+            return *eigenvectors * (inverse_eigenvalues.asDiagonal() * projected);
+        }
+    };
+
+    /**
+     * @brief Calls @p function with a solver of the least-squares problems T x = u of the transform T of a channel.
+     *
+     * The solver provides `solve(rhs)` for a whole matrix of right-hand sides.
+     * If T has full column rank, it reuses the decomposition of the K matrix of the other channel,
+     * see FactorTransformSolver. Otherwise, the minimum-norm solutions require a complete orthogonal
+     * decomposition of T. With a cache, the decomposition is kept in the entry. Otherwise, it is a temporary,
+     * which decomposes the transform matrix in place unless check_qr is set.
+     * The decomposition is computed with a budget of @p n_threads threads, see with_thread_budget().
+     */
+    template <std::size_t channel, class Function>
+    void with_transform_solver(CacheEntry& entry, int n_threads, Function&& function) {
+        if (n_residuals == 0 || entry.full_column_rank[channel]) {
+            // Without residuals, the solver is never used
+            FactorTransformSolver solver{&entry.transform_matrices[channel],
+                                         &entry.k_solutions[1 - channel].eigenvectors,
+                                         entry.k_solutions[1 - channel].eigenvalues,
+                                         entry.k_cholesky[1 - channel]};
+            _internal.template apply_matrix_operation<detail::iEoM_operation::INVERSE>(
+                solver.inverse_eigenvalues, channel == 0 ? "K_-" : "K_+");
+            function(solver);
+        } else if (solver_matrix_cache) {
+            std::unique_lock<std::mutex> lock(entry.mutex);
+            const typename CacheEntry::TransformQR* qr{};
+            with_thread_budget(n_threads, [&]() { qr = &entry.transform_qr(channel); });
+            lock.unlock();
+            function(*qr);
+        } else {
+            std::optional<TransformQR> qr;
+            with_thread_budget(n_threads, [&]() { qr.emplace(entry.transform_matrices[channel]); });
+            function(*qr);
+        }
+    }
+
+    /**
+     * @brief Frees the matrices of a channel once they are no longer needed, unless they are cached.
+     */
+    void finish_channel(CacheEntry& entry, std::size_t channel) const {
+        if (!solver_matrix_cache) {
+            std::lock_guard<std::mutex> lock(entry.mutex);
+            _memory.release(bytes(entry.solver_matrices[channel]) + bytes(entry.transform_matrices[channel]));
+            entry.release_channel(channel);
+        }
+    }
+
+    /**
+     * @brief Stores the entry in solver_matrix_cache, if there is one.
+     */
+    void store_in_cache(const std::shared_ptr<CacheEntry>& entry) {
+        if (solver_matrix_cache) {
+            solver_matrix_cache->insert(_cache_key, entry);
+        }
     }
 
     /**
@@ -387,7 +950,7 @@ private:
      * numerically zero. However, at least one eigenvector from the nullspace is preserved by
      * decrementing the count if any zero eigenvalues were found.
      *
-     * @param solver The Eigen::SelfAdjointEigenSolver containing the computed eigenvalues and eigenvectors.
+     * @param eigenvalues The computed eigenvalues in ascending order.
      *
      * @return The number of zero eigenvalues to exclude, with a minimum of zero ensuring
      *         at least one nullspace vector is retained when zero eigenvalues exist.
@@ -395,9 +958,9 @@ private:
      * @note This function assumes eigenvalues are sorted in ascending order, which Eigen does by default.
      * @note The precision threshold is obtained from _internal._precision.
      */
-    Eigen::Index get_number_of_zero_eigenvalues(const Eigen::SelfAdjointEigenSolver<Matrix>& solver) const noexcept {
+    Eigen::Index get_number_of_zero_eigenvalues(const Vector& eigenvalues) const noexcept {
         Eigen::Index n_zero{};
-        while (n_zero < solver.eigenvalues().size() && solver.eigenvalues()(n_zero) < _internal._precision) {
+        while (n_zero < eigenvalues.size() && eigenvalues(n_zero) < _internal._precision) {
             ++n_zero;
         }
         if (n_zero > 0)
@@ -409,43 +972,46 @@ private:
      * @brief Sets full diagonal data for the resolvent calculation.
      *
      * This function prepares and organizes eigenvalue decomposition data along with computed weights for a given state.
-     * It performs QR-based transformations on eigenvectors and computes weights as squared projections of the state
-     * onto the eigenvector subspace.
+     * It transforms the first eigenvectors back with the transform and computes weights as squared projections of
+     * the state onto the eigenvector subspace.
      * TODO: The transformation of the eigenvectors is yet to be published.
      *
-     * @param solver A SelfAdjointEigenSolver containing the eigendecomposition of the system matrix.
-     * @param qr A QR decomposition object used to solve linear systems for eigenvector transformation.
+     * @param eigenvalues Eigenvalues of the system matrix in ascending order; all or only the lowest ones.
+     * @param eigenvectors Eigenvectors belonging to @p eigenvalues, one per column.
+     * @param transform_solver Solver of the transform, see with_transform_solver(); all first eigenvectors are
+     *                         transformed in one call.
      * @param n_non_zero The number of non-zero eigenvalues and corresponding eigenvectors to process.
-     * @param transform_matrix The transformation matrix used for QR error checking (if enabled).
      *
      * @tparam iterator_type The type of state iterator (const_phase_it or const_amplitude_it) used to traverse starting
      * states.
      *
      * @return FullDiagData A structure containing:
-     *         - first_eigenvectors: Transformed eigenvectors obtained via QR solve
+     *         - first_eigenvectors: Transformed eigenvectors, i.e., least-squares solutions of T x = u_j
      *         - eigenvalues: Square root (because the algorithm works in omega^2) of the non-zero eigenvalues
      *         - weights: Squared projections of the state onto the eigenvector subspace,
      *                    computed as |<u_j | N^{-1/2} L | state>|^2
      *
-     * @details If check_qr is true (compile-time constant), the residual error of each
-     *          QR solution is printed for debugging purposes.
+     * @details The overlaps of all states with all eigenvectors are one matrix product, States^T V.
+     *          Degenerate eigenvalues form contiguous segments of the sorted eigenvalues, whose squared overlaps
+     *          are summed in a single pass.
      *
      * @note The state vector is assumed to be pre-transformed. The weights represent
      *       probabilities (squared amplitudes) in the eigenvector basis.
      */
-    template <detail::ConstStateIterator iterator_type>
-    FullDiagData set_full_diag_data(const Eigen::SelfAdjointEigenSolver<Matrix>& solver,
-                                    const TransformQR& qr,
+    template <detail::ConstStateIterator iterator_type, class TransformSolver>
+    FullDiagData set_full_diag_data(const Vector& eigenvalues,
+                                    const Matrix& eigenvectors,
+                                    const TransformSolver& transform_solver,
                                     const std::size_t& n_non_zero) const {
         static_assert(std::is_same_v<iterator_type, detail::ConstAmplitudeIterator<RealType>> ||
                       (std::is_same_v<iterator_type, detail::ConstPhaseIterator<RealType>>));
 
-        if (_internal.contains_negative(solver.eigenvalues())) {
+        if (_internal.contains_negative(eigenvalues)) {
             if (_internal._negative_matrix_is_error) {
-                throw MatrixIsNegativeException<RealType>(solver.eigenvalues().minCoeff(), "in set_full_diag data");
+                throw MatrixIsNegativeException<RealType>(eigenvalues.minCoeff(), "in set_full_diag data");
             } else {
                 std::cerr << "Warning: The dynamical matrix in set_full_diag_data is negative with min(ev) = "
-                          << solver.eigenvalues().minCoeff() << std::endl;
+                          << eigenvalues.minCoeff() << std::endl;
             }
         }
         FullDiagData data;
@@ -461,36 +1027,41 @@ private:
             weight_vec.reserve(n_non_zero);
         }
 
-        int eigenvector_count{};
-        for (Eigen::Index i = 0; i < solver.eigenvalues().size(); ++i) {
-            const RealType eigen_val = std::sqrt(std::abs(solver.eigenvalues()(i)));
-
-            if (data.eigenvalues.empty() || std::abs(data.eigenvalues.back() - eigen_val) >=
-                                                std::numbers::sqrt2_v<RealType> * _internal._sqrt_precision) {
-                data.eigenvalues.emplace_back(eigen_val);
-                if (eigenvector_count < n_residuals) {
-                    Vector buffer = qr.solve(solver.eigenvectors().col(i));
-                    data.first_eigenvectors[eigenvector_count++] =
-                        std::vector<RealType>(buffer.data(), buffer.data() + buffer.size());
-                }
+        // The states are already transformed; thus, the overlaps are
+        // <u_j | N^{-1/2} L | original_amplitude_state> and, analogously, <u_j | N^{-1/2} L^+ | original_phase_state>
+        Matrix states(eigenvectors.rows(), static_cast<Eigen::Index>(data.weights.size()));
+        for (iterator_type it = iterator_type::begin(starting_states); it != iterator_type::end(starting_states);
+             ++it) {
+            states.col(it.get_state_number()) = it.state();
+        }
+        const std::size_t overlap_bytes = bytes(states) + data.weights.size() * eigenvalues.size() * sizeof(RealType);
+        _memory.allocate(overlap_bytes);
+        const Matrix squared_overlaps =
+            (states.transpose() * eigenvectors.leftCols(eigenvalues.size())).cwiseAbs2();
+        const Vector frequencies = eigenvalues.cwiseAbs().cwiseSqrt();
 
-                for (iterator_type it = iterator_type::begin(starting_states);
-                     it != iterator_type::end(starting_states); ++it) {
-                    const auto state_index = it.get_state_number();
-                    // state is already transformed; this line computes
-                    // sum_j <u_j| transform_matrix | original_amplitude_state>
-                    //      = sum_j <u_j | N^{-1/2} L | original_amplitude_state>
-                    // The analog also applies to phase states:
-                    //      sum_j <u_j | N^{-1/2} L^+ | original_phase_state>
-                    data.weights[state_index].emplace_back(it.state().dot(solver.eigenvectors().col(i)));
-                    data.weights[state_index].back() *= data.weights[state_index].back();
-                }
-            } else {
-                for (iterator_type it = iterator_type::begin(starting_states);
-                     it != iterator_type::end(starting_states); ++it) {
-                    const auto buffer = it.state().dot(solver.eigenvectors().col(i));
-                    data.weights[it.get_state_number()].back() += buffer * buffer;
-                }
+        // The first eigenvectors are transformed together after the reduction
+        std::vector<Eigen::Index> first_columns;
+        first_columns.reserve(static_cast<std::size_t>(n_residuals));
+        const RealType degeneracy_threshold = std::numbers::sqrt2_v<RealType> * _internal._sqrt_precision;
+        for (Eigen::Index begin = 0, end = 0; begin < frequencies.size(); begin = end) {
+            while (end < frequencies.size() && std::abs(frequencies(end) - frequencies(begin)) < degeneracy_threshold) {
+                ++end;
+            }
+            data.eigenvalues.emplace_back(frequencies(begin));
+            if (first_columns.size() < static_cast<std::size_t>(n_residuals)) {
+                first_columns.push_back(begin);
+            }
+            for (std::size_t s = 0U; s < data.weights.size(); ++s) {
+                data.weights[s].emplace_back(squared_overlaps.row(s).segment(begin, end - begin).sum());
+            }
+        }
+        _memory.release(overlap_bytes);
+        if (!first_columns.empty()) {
+            const Matrix solutions = transform_solver.solve(Matrix(eigenvectors(Eigen::all, first_columns)));
+            for (std::size_t k = 0U; k < first_columns.size(); ++k) {
+                data.first_eigenvectors[k] = std::vector<RealType>(solutions.col(k).data(),
+                                                                   solutions.col(k).data() + solutions.rows());
             }
         }
         return data;
@@ -502,33 +1073,47 @@ private:
      *
      * This function computes the eigenvalues and eigenvectors of the solver matrix using
      * Lanczos iteration with residual information. It then transforms the eigenvectors
-     * using QR decomposition and takes the square root of the eigenvalues.
+     * with the transform and takes the square root of the eigenvalues.
      *
      * @param resolvent Reference to the Resolvent object used to compute eigendecomposition.
      * @param n_lanczos_iterations Number of Lanczos iterations to perform.
-     * @param qr The QR transformation used to solve for the transformed eigenvectors.
-     * @param transform_matrix The transformation matrix used for QR error checking (if enabled).
+     * @param transform_solver Solver of the transform, see with_transform_solver(); all eigenvectors are
+     *                         transformed in one call.
+     * @param two_pass If true, uses Resolvent::compute_with_residuals_two_pass(), which needs O(n) memory.
      *
      * @return ResidualData Structure containing the transformed eigenvectors and computed eigenvalues.
-     *         - eigenvectors: QR-transformed eigenvectors (empty vectors are skipped)
+     *         - eigenvectors: Transformed eigenvectors (empty vectors are skipped)
      *         - eigenvalues: Square roots of the computed eigenvalues
      *
-     * @note If check_qr is true at compile-time, outputs the residual error ||AX - B|| for each eigenvector.
      * @note Eigenvalues are assumed to be in z^2 form and are converted to z via std::sqrt().
      */
+    template <class TransformSolver>
     ResidualData set_residual_data(Resolvent<Matrix, Vector>& resolvent,
                                    int n_lanczos_iterations,
                                    const Matrix& solver_matrix,
-                                   const TransformQR& qr,
-                                   const Matrix& transform_matrix) const {
+                                   const TransformSolver& transform_solver,
+                                   bool two_pass) const {
         ResidualData residual_info =
-            resolvent.template compute_with_residuals<n_residuals>(solver_matrix, n_lanczos_iterations);
-        for (auto& vj : residual_info.eigenvectors) {
-            if (vj.empty())
-                continue;
-            Eigen::Map<Vector> vj_eigen(vj.data(), vj.size());
-            Vector buffer = qr.solve(vj_eigen);
-            vj = std::vector<RealType>(buffer.data(), buffer.data() + buffer.size());
+            two_pass
+                ? resolvent.template compute_with_residuals_two_pass<n_residuals>(solver_matrix, n_lanczos_iterations)
+                : resolvent.template compute_with_residuals<n_residuals>(solver_matrix, n_lanczos_iterations);
+        // Transform all non-empty eigenvectors at once
+        std::vector<std::size_t> filled;
+        for (std::size_t j = 0U; j < residual_info.eigenvectors.size(); ++j) {
+            if (!residual_info.eigenvectors[j].empty())
+                filled.push_back(j);
+        }
+        if (!filled.empty()) {
+            Matrix right_hand_sides(solver_matrix.rows(), static_cast<Eigen::Index>(filled.size()));
+            for (std::size_t k = 0U; k < filled.size(); ++k) {
+                right_hand_sides.col(k) = Eigen::Map<const Vector>(residual_info.eigenvectors[filled[k]].data(),
+                                                                   residual_info.eigenvectors[filled[k]].size());
+            }
+            const Matrix solutions = transform_solver.solve(right_hand_sides);
+            for (std::size_t k = 0U; k < filled.size(); ++k) {
+                residual_info.eigenvectors[filled[k]] =
+                    std::vector<RealType>(solutions.col(k).data(), solutions.col(k).data() + solutions.rows());
+            }
         }
         for (auto& ev : residual_info.eigenvalues) {
             // The eigenvalue is in z^2
@@ -538,6 +1123,39 @@ private:
     }
 
 public:
+    /**
+     * @brief Optional cache of the solver matrices, which may be shared between several objects.
+     *
+     * If set, repeated parameter points and points that only differ in their starting states skip everything
+     * but the Lanczos stage, see SolverMatrixCache. Disabled by default.
+     */
+    std::shared_ptr<SolverMatrixCache<RealType>> solver_matrix_cache;
+
+    /**
+     * @brief Approximate memory ceiling of the pipeline in bytes; 0 (default) means unlimited.
+     *
+     * If the estimated memory of forming both solver matrices at once exceeds the limit, the channels are processed
+     * one after the other, each with all threads. Likewise, fewer Lanczos runs are executed at once.
+     * The estimates cover the dense matrices of the pipeline, not the matrices filled by the derived class.
+     */
+    std::size_t memory_limit{};
+
+    /**
+     * @brief Trade some speed for a lower peak memory; disabled by default.
+     *
+     * In lean mode, K_plus, K_minus and N_new are diagonalized in place, i.e., their eigenvectors take over their
+     * storage (without pivoting, the eigensolver still needs one working copy while it runs), the last user of the eigenvectors of K_plus or K_minus overwrites them with the factor of the
+     * solver matrix, L is released after the starting states are transformed, and the channels are processed
+     * one after the other. The results agree with the default mode up to rounding.
+     * Note that K_plus, K_minus and L are empty after a computation in lean mode.
+     */
+    bool lean{};
+
+    /**
+     * @brief The high-water marks of the last computation, per phase; see MemoryReport.
+     */
+    MemoryReport memory_report() const { return _memory.report(); }
+
     /**
      * @brief Create a starting state containing only an amplitude component.
      *
@@ -628,54 +1246,92 @@ public:
      * to obtain resolvent data for all configured starting states.
      *
      * @tparam CheckHermitian If >0, enables runtime Hermiticity checks against precision 10^-CheckHermitian.
-     * @param n_lanczos_iterations Number of Lanczos iterations used for each resolvent.
+     * @param n_lanczos_iterations Maximum number of Lanczos iterations used for each resolvent.
+     * @param termination Adaptive stopping criterion; disabled by default. The probe grid refers to omega^2.
      * @return A vector of `ResolventReturnData` containing resolvent results for
      *         phase followed by amplitude starting states.
      */
     template <int CheckHermitian = -1>
-    std::vector<ResolventReturnData> compute_collective_modes(unsigned int n_lanczos_iterations) {
-        auto k_solutions = this->diagonalize_K_matrices<CheckHermitian>();
-        Matrix solver_matrix;
+    std::vector<ResolventReturnData> compute_collective_modes(
+        unsigned int n_lanczos_iterations, const TerminationCriterion<RealType>& termination = {}) {
+        std::array<std::vector<Resolvent<Matrix, Vector>>, 2> resolvents;
 
-        set_begin();
-        const int N_RESOLVENT_TYPES = total_size(starting_states);
-        std::vector<Resolvent<Matrix, Vector>> resolvents(N_RESOLVENT_TYPES);
-        auto resolvent_it = resolvents.begin();
+        run_pipeline<CheckHermitian>(false, [&](auto channel, CacheEntry& entry, int) {
+            constexpr std::size_t c = decltype(channel)::value;
+            const auto start = std::chrono::steady_clock::now();
+            const Matrix& solver_matrix = entry.solver_matrices[c];
+            resolvents[c] = channel_resolvents<c>();
+            for (auto& resolvent : resolvents[c]) {
+                resolvent.termination = termination;
+            }
+            spawn_state_tasks(static_cast<int>(resolvents[c].size()), lanczos_memory(c, n_lanczos_iterations),
+                              [&resolvents, &solver_matrix, n_lanczos_iterations](int i) {
+                                  resolvents[c][i].compute_with_reorthogonalization(solver_matrix,
+                                                                                    n_lanczos_iterations);
+                              });
+            print_elapsed(c == 0 ? "Time for phase resolvents: " : "Time for amplitude resolvents: ", start);
+        });
 
-        compute_solver_matrix<0, 1>(k_solutions, solver_matrix);
-        for (phase_it it = phase_it::begin(starting_states); it != phase_it::end(starting_states);
-             ++resolvent_it, ++it) {
-            resolvent_it->set_starting_state(it->phase_state);
-            if (resolvent_it->data.name.empty())
-                resolvent_it->data.name = "phase_" + it->name;
-        }
-#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
-#pragma omp parallel for
-#endif
-        for (int i = 0; i < phase_size(starting_states); ++i) {
-            resolvents[i].compute_with_reorthogonalization(solver_matrix, n_lanczos_iterations);
+        std::vector<ResolventReturnData> ret;
+        ret.reserve(resolvents[0].size() + resolvents[1].size());
+        for (const auto& channel_resolvents : resolvents) {
+            for (const auto& re : channel_resolvents) {
+                ret.push_back(re.get_data());
+            }
         }
+        return ret;
+    };
 
-        compute_solver_matrix<1, 0>(k_solutions, solver_matrix);
-        for (amplitude_it it = amplitude_it::begin(starting_states); it != amplitude_it::end(starting_states);
-             ++resolvent_it, ++it) {
-            resolvent_it->set_starting_state(it->amplitude_state);
-            if (resolvent_it->data.name.empty())
-                resolvent_it->data.name = "amplitude_" + it->name;
-        }
-#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
-#pragma omp parallel for
-#endif
-        for (int i = phase_size(starting_states); i < phase_size(starting_states) + amplitude_size(starting_states);
-             ++i) {
-            resolvents[i].compute_with_reorthogonalization(solver_matrix, n_lanczos_iterations);
-        }
-        print_duration("Time for resolvents: ");
+    /**
+     * @brief Compute collective-mode resolvents using block Lanczos iteration.
+     *
+     * Equivalent to `compute_collective_modes()`, but all starting states of a channel are
+     * advanced together by a BlockResolvent. Each iteration then streams the solver matrix only once
+     * (one GEMM instead of one GEMV per starting state), which pays off for several starting states.
+     * The continued-fraction coefficients are extracted from the resulting block tridiagonal matrix.
+     * Unlike compute_collective_modes(), there is no adaptive termination: the starting states share one block
+     * Krylov space, so the iteration always runs for @p n_lanczos_iterations iterations (unless the space is
+     * exhausted).
+     *
+     * @tparam CheckHermitian If >0, enables runtime Hermiticity checks against precision 10^-CheckHermitian.
+     * @param n_lanczos_iterations Number of Lanczos iterations used for each resolvent.
+     * @param cross_terms If true, appends the resolvents of 0.5 * (s_i + s_j) for each pair of starting states
+     *                    within a channel; they are named "<channel>_<name_i>+<channel>_<name_j>".
+     * @return A vector of `ResolventReturnData` containing resolvent results for
+     *         phase followed by amplitude starting states, followed by the cross terms if requested.
+     */
+    template <int CheckHermitian = -1>
+    std::vector<ResolventReturnData> compute_collective_modes_block(unsigned int n_lanczos_iterations,
+                                                                    bool cross_terms = false) {
+        std::array<std::vector<ResolventReturnData>, 2> channel_ret;
+        std::array<std::vector<ResolventReturnData>, 2> channel_cross_ret;
+
+        run_pipeline<CheckHermitian>(false, [&](auto channel, CacheEntry& entry, int n_threads) {
+            constexpr std::size_t c = decltype(channel)::value;
+            using iterator_type = std::conditional_t<c == 0, const_phase_it, const_amplitude_it>;
+            const auto start = std::chrono::steady_clock::now();
+            std::vector<Vector> states;
+            std::vector<std::string> names;
+            for (iterator_type it = iterator_type::begin(starting_states); it != iterator_type::end(starting_states);
+                 ++it) {
+                states.push_back(it.state());
+                names.push_back((c == 0 ? "phase_" : "amplitude_") + it->name);
+            }
+            BlockResolvent<Matrix, Vector> block_resolvent(states, names);
+            with_thread_budget(n_threads, [&]() {
+                block_resolvent.compute_with_reorthogonalization(entry.solver_matrices[c], n_lanczos_iterations,
+                                                                 cross_terms);
+            });
+            const auto& block_data = block_resolvent.get_data();
+            channel_ret[c].assign(block_data.begin(), block_data.begin() + states.size());
+            channel_cross_ret[c].assign(block_data.begin() + states.size(), block_data.end());
+            print_elapsed(c == 0 ? "Time for phase block resolvents: " : "Time for amplitude block resolvents: ",
+                          start);
+        });
 
         std::vector<ResolventReturnData> ret;
-        ret.reserve(resolvents.size());
-        for (const auto& re : resolvents) {
-            ret.push_back(re.get_data());
+        for (const auto& data : {channel_ret[0], channel_ret[1], channel_cross_ret[0], channel_cross_ret[1]}) {
+            ret.insert(ret.end(), data.begin(), data.end());
         }
         return ret;
     };
@@ -688,71 +1344,56 @@ public:
      * detailed residual eigenvector data for post-analysis.
      *
      * @tparam CheckHermitian If >0, enables runtime Hermiticity checks against precision 10^-CheckHermitian.
-     * @param n_lanczos_iterations Number of Lanczos iterations used for each resolvent.
+     * @param n_lanczos_iterations Maximum number of Lanczos iterations used for each resolvent.
+     * @param two_pass If true, each resolvent keeps only three Lanczos vectors in memory and reconstructs
+     *                 the Ritz vectors in a second Lanczos pass, see Resolvent::compute_with_residuals_two_pass().
+     *                 This roughly doubles the number of matrix-vector products but makes the memory per
+     *                 starting state independent of @p n_lanczos_iterations.
+     * @param termination Adaptive stopping criterion; disabled by default, see compute_collective_modes().
      * @return A pair where the first element is a vector of `ResolventReturnData`
      *         and the second element is a `std::list` of `ResidualData` entries
      *         containing eigenvectors and eigenvalues extracted from Lanczos residuals.
      */
     template <int CheckHermitian = -1>
     std::pair<std::vector<ResolventReturnData>, std::list<ResidualData>> compute_collective_modes_with_residuals(
-        unsigned int n_lanczos_iterations) {
-        auto k_solutions = this->diagonalize_K_matrices<CheckHermitian>();
-        Matrix solver_matrix, transform_matrix;
-
-        std::pair<std::vector<ResolventReturnData>, std::list<ResidualData>> return_data;
-        std::list<ResidualData>& residual_infos = return_data.second;
+        unsigned int n_lanczos_iterations,
+        bool two_pass = false,
+        const TerminationCriterion<RealType>& termination = {}) {
+        std::array<std::vector<Resolvent<Matrix, Vector>>, 2> resolvents;
+        std::array<std::vector<ResidualData>, 2> residual_infos;
 
-        set_begin();
-        const int N_RESOLVENT_TYPES = total_size(starting_states);
-        std::vector<Resolvent<Matrix, Vector>> resolvents(N_RESOLVENT_TYPES);
-        auto resolvent_it = resolvents.begin();
-
-        // No need to do anything if there are no starting states for the phase channel
-        if (phase_size(starting_states) > 0U) {
-            compute_solver_matrix<0, 1>(k_solutions, solver_matrix, transform_matrix);
-            TransformQR qr(transform_matrix);  // Curly braces to free memory after usage
-            print_duration("Time for second QR decomp: ");
-            for (phase_it it = phase_it::begin(starting_states); it != phase_it::end(starting_states);
-                 ++resolvent_it, ++it) {
-                resolvent_it->set_starting_state(it->phase_state);
-                if (resolvent_it->data.name.empty())
-                    resolvent_it->data.name = "phase_" + it->name;
+        run_pipeline<CheckHermitian>(true, [&](auto channel, CacheEntry& entry, int n_threads) {
+            constexpr std::size_t c = decltype(channel)::value;
+            const auto start = std::chrono::steady_clock::now();
+            const Matrix& solver_matrix = entry.solver_matrices[c];
+            resolvents[c] = channel_resolvents<c>();
+            for (auto& resolvent : resolvents[c]) {
+                resolvent.termination = termination;
             }
-#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
-#pragma omp parallel for
-#endif
-            for (int i = 0; i < phase_size(starting_states); ++i) {
-                residual_infos.emplace_back(
-                    set_residual_data(resolvents[i], n_lanczos_iterations, solver_matrix, qr, transform_matrix));
-            }
-        }
+            residual_infos[c].resize(resolvents[c].size());
+            with_transform_solver<c>(entry, n_threads, [&](const auto& transform_solver) {
+                print_elapsed(c == 0 ? "Time for first transform solver: " : "Time for second transform solver: ",
+                              start);
+                spawn_state_tasks(static_cast<int>(resolvents[c].size()),
+                                  lanczos_memory(c, two_pass ? 0U : n_lanczos_iterations), [&](int i) {
+                                      residual_infos[c][i] =
+                                          set_residual_data(resolvents[c][i], n_lanczos_iterations, solver_matrix,
+                                                            transform_solver, two_pass);
+                                  });
+            });
+            print_elapsed(c == 0 ? "Time for phase resolvents: " : "Time for amplitude resolvents: ", start);
+        });
 
-        // No need to do anything if there are no starting states for the amplitude channel
-        if (amplitude_size(starting_states) > 0) {
-            compute_solver_matrix<1, 0>(k_solutions, solver_matrix, transform_matrix);
-            TransformQR qr(transform_matrix);  // Curly braces to free memory after usage
-            print_duration("Time for second QR decomp: ");
-            for (amplitude_it it = amplitude_it::begin(starting_states); it != amplitude_it::end(starting_states);
-                 ++resolvent_it, ++it) {
-                resolvent_it->set_starting_state(it->amplitude_state);
-                if (resolvent_it->data.name.empty())
-                    resolvent_it->data.name = "amplitude_" + it->name;
+        std::pair<std::vector<ResolventReturnData>, std::list<ResidualData>> return_data;
+        return_data.first.reserve(resolvents[0].size() + resolvents[1].size());
+        for (std::size_t c = 0U; c < 2U; ++c) {
+            for (const auto& re : resolvents[c]) {
+                return_data.first.push_back(re.get_data());
             }
-#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
-#pragma omp parallel for
-#endif
-            for (int i = phase_size(starting_states); i < phase_size(starting_states) + amplitude_size(starting_states);
-                 ++i) {
-                residual_infos.emplace_back(
-                    set_residual_data(resolvents[i], n_lanczos_iterations, solver_matrix, qr, transform_matrix));
+            for (auto& residual_info : residual_infos[c]) {
+                return_data.second.push_back(std::move(residual_info));
             }
         }
-        print_duration("Time for resolvents: ");
-
-        return_data.first.reserve(resolvents.size());
-        for (const auto& re : resolvents) {
-            return_data.first.push_back(re.get_data());
-        }
         return return_data;
     };
 
@@ -766,66 +1407,149 @@ public:
      */
     template <int CheckHermitian = -1>
     std::pair<FullDiagData, FullDiagData> full_diagonalization() {
-        auto k_solutions = this->diagonalize_K_matrices<CheckHermitian>();
-        Matrix solver_matrix, transform_matrix;
-
         Eigen::SelfAdjointEigenSolver<Matrix> solver;
+        return diagonalize_channels<CheckHermitian>(solver);
+    }
+
+    /**
+     * @brief Same as full_diagonalization(), but only for the lowest eigenpairs of the dynamical matrices.
+     * Uses a thick-restart Lanczos eigensolver, i.e., O(n^2 * max_basis_size) work and O(n * max_basis_size)
+     * memory instead of O(n^3) and O(n^2) per Lanczos run. There is one run per starting state of a channel and one
+     * from a generic vector, whose results are combined, see ThickRestartLanczos::compute_from_states(). Thus,
+     * eigenvalues, first eigenvectors and weights agree with the lowest ones of full_diagonalization(), also for
+     * degenerate eigenvalues. Use lowest_diagonalization() for many starting states or if modes without weight in
+     * any starting state must not be missed with certainty.
+     * Note that eigenvalues from the nullspace count towards n_eigenpairs.
+     * @param n_eigenpairs Number of lowest eigenpairs of each solver matrix; should be at least n_residuals.
+     * @param max_basis_size Maximum number of Lanczos vectors, see ThickRestartLanczos.
+     * @return A pair of FullDiagData objects, the first for the phase states, the second for the amplitude states.
+     */
+    template <int CheckHermitian = -1>
+    std::pair<FullDiagData, FullDiagData> partial_diagonalization(int n_eigenpairs, int max_basis_size = 0) {
+        ThickRestartLanczos<Matrix, Vector> solver(n_eigenpairs, max_basis_size);
+        return diagonalize_channels<CheckHermitian>(solver);
+    }
+
+    /**
+     * @brief Same as full_diagonalization(), but only for the modes with omega_min <= omega < omega_max,
+     * e.g., to discard everything above the continuum edge.
+     * The solver matrices are reduced to tridiagonal form, and only the eigenpairs inside the window are computed
+     * by bisection and inverse iteration, see BisectionEigenSolver. Eigenvalues, first eigenvectors and weights are
+     * identical to those of full_diagonalization() inside the window; a group of degenerate eigenvalues that
+     * straddles a boundary is only partially contained.
+     * @return A pair of FullDiagData objects, the first for the phase states, the second for the amplitude states.
+     */
+    template <int CheckHermitian = -1>
+    std::pair<FullDiagData, FullDiagData> window_diagonalization(RealType omega_min, RealType omega_max) {
+        // The solver matrices are in omega^2
+        const RealType lower =
+            omega_min > RealType{} ? omega_min * omega_min : -std::numeric_limits<RealType>::infinity();
+        return diagonalize_channels<CheckHermitian>(BisectionEigenSolver<Matrix>::window(lower, omega_max * omega_max));
+    }
+
+    /**
+     * @brief Dense counterpart of partial_diagonalization(): the lowest eigenpairs from a Householder reduction
+     * to tridiagonal form followed by bisection and inverse iteration, see BisectionEigenSolver.
+     * The result does not depend on the starting states, so modes without weight in them are never missed.
+     * This costs O(n^3) work and O(n^2) memory, compared to the O(n^2 * max_basis_size) work per Lanczos run
+     * of partial_diagonalization(), but saves the accumulation of all eigenvectors of full_diagonalization().
+     * Note that eigenvalues from the nullspace count towards n_eigenpairs.
+     * @param n_eigenpairs Number of lowest eigenpairs of each solver matrix.
+     * @return A pair of FullDiagData objects, the first for the phase states, the second for the amplitude states.
+     */
+    template <int CheckHermitian = -1>
+    std::pair<FullDiagData, FullDiagData> lowest_diagonalization(int n_eigenpairs) {
+        return diagonalize_channels<CheckHermitian>(BisectionEigenSolver<Matrix>::lowest(n_eigenpairs));
+    }
+
+private:
+    /**
+     * @brief Diagonalizes the solver matrices of both channels and collects eigenvalues, eigenvectors and weights.
+     *
+     * @param prototype An Eigen::SelfAdjointEigenSolver, a ThickRestartLanczos or a BisectionEigenSolver;
+     *                  each channel uses a copy.
+     */
+    template <int CheckHermitian, class EigenSolver>
+    std::pair<FullDiagData, FullDiagData> diagonalize_channels(const EigenSolver& prototype) {
         std::pair<FullDiagData, FullDiagData> return_data;
 
-        // No need to do anything if there are no starting states for the phase channel
-        if (phase_size(starting_states) > 0) {
-            compute_solver_matrix<0, 1>(k_solutions, solver_matrix, transform_matrix);
-            set_begin();
-            solver.compute(solver_matrix);
-            print_duration("Time for first ED: ");
-            TransformQR qr(transform_matrix);
-            print_duration("Time for first QR decomp: ");
-            const std::size_t n_zero = get_number_of_zero_eigenvalues(solver);
-            const std::size_t n_non_zero = solver.eigenvalues().size() - n_zero;
-            return_data.first = set_full_diag_data<const_phase_it>(solver, qr, n_non_zero);
+        run_pipeline<CheckHermitian>(true, [&](auto channel, CacheEntry& entry, int n_threads) {
+            constexpr std::size_t c = decltype(channel)::value;
+            using iterator_type = std::conditional_t<c == 0, const_phase_it, const_amplitude_it>;
+            const Matrix& solver_matrix = entry.solver_matrices[c];
+            FullDiagData& data = std::get<c>(return_data);
+            EigenSolver solver = prototype;
+
+            auto start = std::chrono::steady_clock::now();
+            with_thread_budget(n_threads, [&]() {
+                run_eigensolver<iterator_type>(solver, solver_matrix);
+            });
+            print_elapsed(c == 0 ? "Time for first ED: " : "Time for second ED: ", start);
+            _memory.allocate(bytes(solver.eigenvectors()));
+            start = std::chrono::steady_clock::now();
+            with_transform_solver<c>(entry, n_threads, [&](const auto& transform_solver) {
+                print_elapsed(c == 0 ? "Time for first transform solver: " : "Time for second transform solver: ",
+                              start);
+                const std::size_t n_zero = get_number_of_zero_eigenvalues(solver.eigenvalues());
+                const std::size_t n_non_zero = solver.eigenvalues().size() - n_zero;
+                data = set_full_diag_data<iterator_type>(solver.eigenvalues(), solver.eigenvectors(), transform_solver,
+                                                          n_non_zero);
+            });
             if constexpr (check_qr) {
-                for (std::size_t i = 0U; i < n_residuals; ++i) {
-                    Eigen::Map<Vector> _eigen(return_data.first.first_eigenvectors[i].data(),
-                                              return_data.first.first_eigenvectors[i].size());
-                    const auto reconstructed = transform_matrix * _eigen;
-                    std::cout
-                        << "|solve_matrix * reconstructed eigenvector - eigenvalue * reconstructed eigenvector| = "
-                        << (solver_matrix * reconstructed -
-                            return_data.first.eigenvalues[i] * return_data.first.eigenvalues[i] * reconstructed)
-                               .norm()
-                        << std::endl;
-                }
+                print_qr_check(data, solver_matrix, entry.transform_matrices[c]);
             }
+            _memory.release(bytes(solver.eigenvectors()));
+        });
+
+        return return_data;
+    }
+
+    /**
+     * @brief Prints the residuals of the first eigenvectors after transforming them back with @p transform_matrix.
+     */
+    static void print_qr_check(const FullDiagData& data, const Matrix& solver_matrix, const Matrix& transform_matrix) {
+        for (std::size_t i = 0U; i < n_residuals; ++i) {
+            Eigen::Map<const Vector> _eigen(data.first_eigenvectors[i].data(), data.first_eigenvectors[i].size());
+            const auto reconstructed = transform_matrix * _eigen;
+            std::cout << "|solve_matrix * reconstructed eigenvector - eigenvalue * reconstructed eigenvector| = "
+                      << (solver_matrix * reconstructed - data.eigenvalues[i] * data.eigenvalues[i] * reconstructed)
+                             .norm()
+                      << std::endl;
         }
+    }
 
-        // No need to do anything if there are no starting states for the amplitude channel
-        if (amplitude_size(starting_states) > 0) {
-            compute_solver_matrix<1, 0>(k_solutions, solver_matrix, transform_matrix);
-            set_begin();
-            solver.compute(solver_matrix);
-            print_duration("Time for second ED: ");
-            TransformQR qr(transform_matrix);
-            const std::size_t n_zero = get_number_of_zero_eigenvalues(solver);
-            const std::size_t n_non_zero = solver.eigenvalues().size() - n_zero;
+    /**
+     * @brief The (transformed) starting states of a channel, one per column.
+     *
+     * Used as starting vectors of the iterative eigensolver, so that its Krylov spaces contain the projection
+     * of each starting state onto every eigenspace.
+     *
+     * @param dimension Dimension of the channel's solver matrix.
+     */
+    template <detail::ConstStateIterator iterator_type>
+    Matrix channel_starting_states(Eigen::Index dimension) const {
+        const int n_states = std::is_same_v<iterator_type, const_phase_it> ? phase_size(starting_states)
+                                                                           : amplitude_size(starting_states);
+        Matrix states(dimension, n_states);
+        Eigen::Index column{};
+        for (iterator_type it = iterator_type::begin(starting_states); it != iterator_type::end(starting_states);
+             ++it) {
+            states.col(column++) = it.state();
+        }
+        return states;
+    }
 
-            print_duration("Time for second QR decomp: ");
-            return_data.second = set_full_diag_data<const_amplitude_it>(solver, qr, n_non_zero);
-            if constexpr (check_qr) {
-                for (std::size_t i = 0U; i < n_residuals; ++i) {
-                    Eigen::Map<Vector> _eigen(return_data.second.first_eigenvectors[i].data(),
-                                              return_data.second.first_eigenvectors[i].size());
-                    const auto reconstructed = transform_matrix * _eigen;
-                    std::cout
-                        << "|solve_matrix * reconstructed eigenvector - eigenvalue * reconstructed eigenvector| = "
-                        << (solver_matrix * reconstructed -
-                            return_data.second.eigenvalues[i] * return_data.second.eigenvalues[i] * reconstructed)
-                               .norm()
-                        << std::endl;
-                }
+    template <detail::ConstStateIterator iterator_type, class EigenSolver>
+    void run_eigensolver(EigenSolver& solver, const Matrix& solver_matrix) const {
+        if constexpr (std::is_same_v<decltype(solver.compute(solver_matrix)), bool>) {
+            if (!solver.compute_from_states(solver_matrix,
+                                            channel_starting_states<iterator_type>(solver_matrix.rows()))) {
+                std::cerr << "Warning: Only " << solver.n_converged() << " eigenpairs converged after "
+                          << solver.n_restarts() << " restarts!" << std::endl;
             }
+        } else {
+            solver.compute(solver_matrix);
         }
-
-        return return_data;
     }
 };
 }  // namespace mrock::iEoM
@@ -1,9 +1,13 @@
 #ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_BLOCKDIAGONALMATRIX_HPP
 #define MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_BLOCKDIAGONALMATRIX_HPP
+#include "SymmetricProduct.hpp"
 #include "UnderlyingRealType.hpp"
 
 #include <Eigen/Dense>
 
+#include <algorithm>
+#include <cassert>
+#include <iterator>
 #include <type_traits>
 #include <vector>
 
@@ -19,13 +23,6 @@ using MatrixN = Eigen::Matrix<Number, Eigen::Dynamic, Eigen::Dynamic>;
 template <class EigenMatrixType>
 using RealScalar = UnderlyingRealType_t<typename EigenMatrixType::Scalar>;
 
-template <class _base, class _other_base>
-using addition_result = decltype(std::declval<_base>() + std::declval<_other_base>());
-template <class _base, class _other_base>
-using substraction_result = decltype(std::declval<_base>() - std::declval<_other_base>());
-template <class _base, class _other_base>
-using multiplication_result = decltype(std::declval<_base>() * std::declval<_other_base>());
-
 template <class _matrix>
 using diagonal_segment_type =
     decltype(std::declval<Eigen::DiagonalWrapper<_matrix>>().diagonal().segment(0, 1).asDiagonal());
@@ -41,6 +38,25 @@ struct HermitianBlock {
     Eigen::Index size{};
 };
 
+/**
+ * @brief Lazy block diagonal matrix whose blocks are computed one at a time by a callable.
+ *
+ * Assigning the expression to a BlockDiagonalMatrix with packed blocks evaluates the whole chain of operations
+ * of each block in one pass, while its operands are in cache, and without intermediate block diagonal matrices.
+ * Like Eigen's expressions, it refers to its operands, which must outlive it; see, e.g., congruence().
+ *
+ * @tparam Function Callable `function(i, block, workspace)` that writes the i-th block into the map `block`.
+ *                  `workspace` is a scratch vector of at least workspace_size entries, one per thread.
+ */
+template <class Function>
+struct BlockWiseExpression {
+    /** Positions and sizes of the resulting (square) blocks. */
+    std::vector<HermitianBlock> layout;
+    /** Scratch entries needed by a single call of function. */
+    Eigen::Index workspace_size{};
+    Function function;
+};
+
 /**
  * @brief Stream output helper for HermitianBlock.
  *
@@ -100,6 +116,127 @@ struct base_traits {
         std::conditional_t<std::is_const_v<_matrix_base>, std::add_const_t<mutable_vector>, mutable_vector>;
 };
 
+/**
+ * @brief Contiguous storage of the dense blocks of a BlockDiagonalMatrix.
+ *
+ * All blocks live back to back in a single aligned arena. Each block starts at a precomputed offset,
+ * which is padded to Eigen's maximal alignment, and is accessed through an Eigen::Map.
+ * Compared to one allocation per block, many small blocks cost a single allocation and are traversed in memory order.
+ * The interface mirrors the parts of std::vector used by BlockDiagonalMatrix, but the blocks are returned as maps,
+ * i.e., by value. Their sizes are fixed by allocate().
+ *
+ * @tparam Scalar Scalar type of the blocks.
+ */
+template <class Scalar>
+class PackedBlocks {
+public:
+    using value_type = Eigen::Map<MatrixN<Scalar>, Eigen::AlignedMax>;
+    using const_value_type = Eigen::Map<const MatrixN<Scalar>, Eigen::AlignedMax>;
+
+private:
+    static constexpr Eigen::Index alignment =
+        std::max<Eigen::Index>(EIGEN_MAX_ALIGN_BYTES / static_cast<Eigen::Index>(sizeof(Scalar)), 1);
+
+    Eigen::Vector<Scalar, Eigen::Dynamic> _arena;
+    std::vector<Eigen::Index> _offsets;
+    std::vector<Eigen::Index> _rows;
+    std::vector<Eigen::Index> _cols;
+
+    template <bool is_const>
+    class Iterator {
+        using Container = std::conditional_t<is_const, const PackedBlocks, PackedBlocks>;
+        Container* _blocks{};
+        std::size_t _index{};
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = std::conditional_t<is_const, PackedBlocks::const_value_type, PackedBlocks::value_type>;
+
+        Iterator(Container* blocks, std::size_t index) : _blocks(blocks), _index(index) {}
+        value_type operator*() const { return (*_blocks)[_index]; }
+        Iterator& operator++() {
+            ++_index;
+            return *this;
+        }
+        bool operator==(const Iterator& other) const noexcept { return _index == other._index; }
+    };
+
+public:
+    PackedBlocks() = default;
+
+    /**
+     * @brief Allocates uninitialized blocks; block i has the size @p rows[i] x @p cols[i].
+     */
+    void allocate(std::vector<Eigen::Index> rows, std::vector<Eigen::Index> cols) {
+        assert(rows.size() == cols.size());
+        _rows = std::move(rows);
+        _cols = std::move(cols);
+        _offsets.resize(_rows.size());
+        Eigen::Index size{};
+        for (std::size_t i = 0U; i < _rows.size(); ++i) {
+            _offsets[i] = size;
+            size += (_rows[i] * _cols[i] + alignment - 1) / alignment * alignment;
+        }
+        _arena.resize(size);
+    }
+
+    inline std::size_t size() const noexcept { return _rows.size(); }
+    inline bool empty() const noexcept { return _rows.empty(); }
+
+    inline value_type operator[](std::size_t i) {
+        return value_type(_arena.data() + _offsets[i], _rows[i], _cols[i]);
+    }
+    inline const_value_type operator[](std::size_t i) const {
+        return const_value_type(_arena.data() + _offsets[i], _rows[i], _cols[i]);
+    }
+
+    inline value_type front() { return (*this)[0U]; }
+    inline const_value_type front() const { return (*this)[0U]; }
+    inline value_type back() { return (*this)[size() - 1U]; }
+    inline const_value_type back() const { return (*this)[size() - 1U]; }
+
+    inline Iterator<false> begin() { return {this, 0U}; }
+    inline Iterator<false> end() { return {this, size()}; }
+    inline Iterator<true> begin() const { return {this, 0U}; }
+    inline Iterator<true> end() const { return {this, size()}; }
+};
+
+/**
+ * @brief Storage of the blocks of a BlockDiagonalMatrix.
+ *
+ * Dense matrices are packed into one arena, see PackedBlocks; other block types,
+ * e.g., the lazy expressions created by the arithmetic operators, are kept in a std::vector.
+ */
+template <class _matrix_base>
+struct block_storage {
+    using type = typename base_traits<_matrix_base>::as_is_vector;
+    using block_type = _matrix_base;
+    static constexpr bool is_packed = false;
+};
+
+template <class Scalar>
+struct block_storage<MatrixN<Scalar>> {
+    using type = PackedBlocks<Scalar>;
+    using block_type = typename PackedBlocks<Scalar>::const_value_type;
+    static constexpr bool is_packed = true;
+};
+
+/**
+ * @brief Type of the blocks of a BlockDiagonalMatrix<_matrix_base> as seen by expressions.
+ * Expressions only read their operands, so packed blocks appear as read-only maps.
+ */
+template <class _matrix_base>
+using block_type_t = typename block_storage<_matrix_base>::block_type;
+
+template <class _base, class _other_base>
+using addition_result = decltype(std::declval<block_type_t<_base>>() + std::declval<block_type_t<_other_base>>());
+template <class _base, class _other_base>
+using substraction_result = decltype(std::declval<block_type_t<_base>>() - std::declval<block_type_t<_other_base>>());
+template <class _base, class _other_base>
+using multiplication_result =
+    decltype(std::declval<block_type_t<_base>>() * std::declval<block_type_t<_other_base>>());
+
 /**
  * @brief Concept requiring two types to be different.
  */
@@ -119,12 +256,79 @@ struct BlockDiagonalMatrix {
     using InternalBase = _matrix_base;
     using Scalar = InternalBase::Scalar;
     using ConstructedMatrix = MatrixN<Scalar>;
+    using BlockType = block_type_t<_matrix_base>;
+    /** Whether the blocks are stored in one arena, see PackedBlocks. */
+    static constexpr bool is_packed = block_storage<_matrix_base>::is_packed;
 
-    typename base_traits<_matrix_base>::as_is_vector blocks;
+    typename block_storage<_matrix_base>::type blocks;
+    /** Prefix offsets, i.e., the row and column of the reconstructed matrix at which each block starts. */
     std::vector<Eigen::Index> blocks_begin;
 
-    using adjoint_view = decltype(blocks.front().adjoint());
-    using eval_result = decltype(blocks.front().eval());
+    using adjoint_view = decltype(std::declval<BlockType&>().adjoint());
+    using eval_result = std::remove_cvref_t<decltype(std::declval<BlockType&>().eval())>;
+
+private:
+    /**
+     * @brief Allocates the arena for blocks of the given sizes, see PackedBlocks.
+     */
+    template <class RowSize, class ColSize>
+    void allocate(std::size_t n_blocks, RowSize&& row_size, ColSize&& col_size) {
+        std::vector<Eigen::Index> rows(n_blocks), cols(n_blocks);
+        for (std::size_t i = 0U; i < n_blocks; ++i) {
+            rows[i] = row_size(i);
+            cols[i] = col_size(i);
+        }
+        blocks.allocate(std::move(rows), std::move(cols));
+    }
+
+public:
+    /**
+     * @brief Proxy returned by noalias(), see there.
+     */
+    struct NoAlias {
+        BlockDiagonalMatrix& matrix;
+
+        template <class _other_base>
+        BlockDiagonalMatrix& operator=(BlockDiagonalMatrix<_other_base> const& other) {
+            assert(matrix.blocks.size() == other.blocks.size());
+#ifdef MROCK_IEOM_PARALLELIZE_BLOCKMATRIX
+#pragma omp parallel for
+#endif
+            for (std::size_t i = 0U; i < other.blocks.size(); ++i) {
+                matrix.blocks[i].noalias() = other.blocks[i];
+            }
+            return matrix;
+        }
+
+        template <class Function>
+        BlockDiagonalMatrix& operator=(BlockWiseExpression<Function> const& expression) {
+            assert(matrix.blocks.size() == expression.layout.size());
+            matrix.evaluate(expression);
+            return matrix;
+        }
+    };
+
+private:
+    /**
+     * @brief Evaluates @p expression block by block into the existing blocks; each thread owns one workspace.
+     */
+    template <class Function>
+    void evaluate(BlockWiseExpression<Function> const& expression) {
+#ifdef MROCK_IEOM_PARALLELIZE_BLOCKMATRIX
+#pragma omp parallel
+#endif
+        {
+            Eigen::Vector<Scalar, Eigen::Dynamic> workspace(expression.workspace_size);
+#ifdef MROCK_IEOM_PARALLELIZE_BLOCKMATRIX
+#pragma omp for schedule(dynamic)
+#endif
+            for (std::size_t i = 0U; i < blocks.size(); ++i) {
+                expression.function(i, blocks[i], workspace);
+            }
+        }
+    }
+
+public:
 
     BlockDiagonalMatrix() = default;
 
@@ -135,13 +339,24 @@ struct BlockDiagonalMatrix {
      * @param block_indizes Block descriptors indicating positions and sizes.
      */
     BlockDiagonalMatrix(const ConstructedMatrix& matrix, const std::vector<HermitianBlock>& block_indizes) {
-        blocks.reserve(block_indizes.size());
         blocks_begin.reserve(block_indizes.size());
         for (const auto& block_index : block_indizes) {
-            blocks.push_back(
-                matrix.block(block_index.position, block_index.position, block_index.size, block_index.size));
             blocks_begin.push_back(block_index.position);
         }
+        if constexpr (is_packed) {
+            const auto size = [&block_indizes](std::size_t i) { return block_indizes[i].size; };
+            allocate(block_indizes.size(), size, size);
+            for (std::size_t i = 0U; i < block_indizes.size(); ++i) {
+                blocks[i] = matrix.block(block_indizes[i].position, block_indizes[i].position, block_indizes[i].size,
+                                         block_indizes[i].size);
+            }
+        } else {
+            blocks.reserve(block_indizes.size());
+            for (const auto& block_index : block_indizes) {
+                blocks.push_back(
+                    matrix.block(block_index.position, block_index.position, block_index.size, block_index.size));
+            }
+        }
     }
 
     /**
@@ -149,15 +364,23 @@ struct BlockDiagonalMatrix {
      *
      * @param matrix Full matrix to analyze and partition.
      */
-    explicit BlockDiagonalMatrix(const ConstructedMatrix& matrix) {
-        const std::vector<HermitianBlock>& block_indizes = identify_hermitian_blocks(matrix);
-        blocks.reserve(block_indizes.size());
+    explicit BlockDiagonalMatrix(const ConstructedMatrix& matrix)
+        : BlockDiagonalMatrix(matrix, identify_hermitian_blocks(matrix)) {}
+
+    /**
+     * @brief Construct uninitialized square blocks with the given positions and sizes.
+     *
+     * @param block_indizes Block descriptors, e.g., layout() of another block diagonal matrix.
+     */
+    explicit BlockDiagonalMatrix(const std::vector<HermitianBlock>& block_indizes)
+        requires is_packed
+    {
         blocks_begin.reserve(block_indizes.size());
         for (const auto& block_index : block_indizes) {
-            blocks.push_back(
-                matrix.block(block_index.position, block_index.position, block_index.size, block_index.size));
             blocks_begin.push_back(block_index.position);
         }
+        const auto size = [&block_indizes](std::size_t i) { return block_indizes[i].size; };
+        allocate(block_indizes.size(), size, size);
     }
 
     /**
@@ -168,35 +391,72 @@ struct BlockDiagonalMatrix {
      */
     BlockDiagonalMatrix(typename base_traits<_matrix_base>::mutable_vector&& _blocks,
                         std::vector<Eigen::Index> const& _blocks_begin)
+        requires(!is_packed)
         : blocks(std::move(_blocks)), blocks_begin(_blocks_begin){};
 
+    /**
+     * @brief Same as above, but the blocks are copied into the arena.
+     */
+    BlockDiagonalMatrix(typename base_traits<_matrix_base>::mutable_vector&& _blocks,
+                        std::vector<Eigen::Index> const& _blocks_begin)
+        requires is_packed
+        : blocks_begin(_blocks_begin) {
+        allocate(
+            _blocks.size(), [&_blocks](std::size_t i) { return _blocks[i].rows(); },
+            [&_blocks](std::size_t i) { return _blocks[i].cols(); });
+        for (std::size_t i = 0U; i < _blocks.size(); ++i) {
+            blocks[i] = _blocks[i];
+        }
+    };
+
     /**
      * @brief Construct from another BlockDiagonalMatrix with a different block type.
      *
+     * Packed blocks are evaluated directly into the arena.
+     *
      * @tparam _other_base Block matrix type of the source object.
      * @param other Source block diagonal matrix.
      */
     template <not_same_as<_matrix_base> _other_base>
-    BlockDiagonalMatrix(BlockDiagonalMatrix<_other_base> const& other)
-        : blocks(other.blocks.size()), blocks_begin(other.blocks_begin) {
+    BlockDiagonalMatrix(BlockDiagonalMatrix<_other_base> const& other) : blocks_begin(other.blocks_begin) {
+        if constexpr (is_packed) {
+            allocate(
+                other.blocks.size(), [&other](std::size_t i) { return other.blocks[i].rows(); },
+                [&other](std::size_t i) { return other.blocks[i].cols(); });
+            noalias() = other;
+        } else {
+            blocks.resize(other.blocks.size());
 #ifdef MROCK_IEOM_PARALLELIZE_BLOCKMATRIX
 #pragma omp parallel for
 #endif
-        for (std::size_t i = 0U; i < other.blocks.size(); ++i) {
-            this->blocks[i] = other.blocks[i].eval();
+            for (std::size_t i = 0U; i < other.blocks.size(); ++i) {
+                this->blocks[i] = other.blocks[i].eval();
+            }
         }
     }
 
     /**
      * @brief Assign from another BlockDiagonalMatrix with a different block type.
      *
+     * @p other may refer to this object; if the block sizes agree, packed blocks keep their storage.
+     *
      * @tparam _other_base Block matrix type of the source object.
      * @param other Source block diagonal matrix.
      * @return Reference to this object.
      */
     template <not_same_as<_matrix_base> _other_base>
     BlockDiagonalMatrix& operator=(BlockDiagonalMatrix<_other_base> const& other) {
-        this->blocks.resize(other.blocks.size());
+        if constexpr (is_packed) {
+            bool same_layout = blocks.size() == other.blocks.size();
+            for (std::size_t i = 0U; same_layout && i < blocks.size(); ++i) {
+                same_layout = blocks[i].rows() == other.blocks[i].rows() && blocks[i].cols() == other.blocks[i].cols();
+            }
+            if (!same_layout) {
+                return *this = BlockDiagonalMatrix(other);
+            }
+        } else {
+            this->blocks.resize(other.blocks.size());
+        }
         this->blocks_begin = other.blocks_begin;
 #ifdef MROCK_IEOM_PARALLELIZE_BLOCKMATRIX
 #pragma omp parallel for
@@ -207,6 +467,60 @@ struct BlockDiagonalMatrix {
         return *this;
     }
 
+    /**
+     * @brief Evaluate a block-wise expression, e.g., congruence(), into newly allocated blocks.
+     */
+    template <class Function>
+    BlockDiagonalMatrix(BlockWiseExpression<Function> const& expression)
+        requires(is_packed)
+        : BlockDiagonalMatrix(expression.layout) {
+        evaluate(expression);
+    }
+
+    /**
+     * @brief Evaluate a block-wise expression; the existing blocks are reused if the layouts agree.
+     *
+     * Whether @p expression may refer to this object is stated by the function that created it.
+     */
+    template <class Function>
+    BlockDiagonalMatrix& operator=(BlockWiseExpression<Function> const& expression)
+        requires is_packed
+    {
+        bool same_layout = blocks.size() == expression.layout.size();
+        for (std::size_t i = 0U; same_layout && i < blocks.size(); ++i) {
+            same_layout = blocks_begin[i] == expression.layout[i].position &&
+                          blocks[i].rows() == expression.layout[i].size && blocks[i].cols() == blocks[i].rows();
+        }
+        if (!same_layout) {
+            return *this = BlockDiagonalMatrix(expression);
+        }
+        evaluate(expression);
+        return *this;
+    }
+
+    /**
+     * @brief Evaluate into the existing blocks without temporaries, e.g., `C.noalias() = A * B;`.
+     *
+     * The block sizes must agree, and the right-hand side must not refer to this object.
+     * Together with the in-place operators, this allows arithmetic without allocating any blocks.
+     */
+    NoAlias noalias()
+        requires is_packed
+    {
+        return NoAlias{*this};
+    }
+
+    /**
+     * @brief Positions and sizes of the (square) blocks.
+     */
+    std::vector<HermitianBlock> layout() const {
+        std::vector<HermitianBlock> block_indizes(blocks.size());
+        for (std::size_t i = 0U; i < blocks.size(); ++i) {
+            block_indizes[i] = {blocks_begin[i], blocks[i].rows()};
+        }
+        return block_indizes;
+    }
+
     /**
      * @brief Reconstruct the full matrix from its diagonal blocks.
      *
@@ -259,7 +573,7 @@ struct BlockDiagonalMatrix {
      * @return Reference to this object.
      */
     BlockDiagonalMatrix& adjointInPlace() {
-        for (auto& block : this->blocks) {
+        for (auto&& block : this->blocks) {
             block.adjointInPlace();
         }
         return *this;
@@ -271,38 +585,70 @@ struct BlockDiagonalMatrix {
      * @param i Zero-based block index.
      * @return Const reference to the requested block.
      */
-    inline const InternalBase& block(std::size_t i) const { return blocks[i]; }
+    inline decltype(auto) block(std::size_t i) const { return blocks[i]; }
     /**
      * @brief Access a block by index.
      *
      * @param i Zero-based block index.
      * @return Reference to the requested block.
      */
-    inline InternalBase& block(std::size_t i) { return blocks[i]; }
+    inline decltype(auto) block(std::size_t i) { return blocks[i]; }
 
     /**
      * @brief Total row dimension of the reconstructed matrix.
      *
-     * @return Sum of the row sizes of all blocks.
+     * @return Sum of the row sizes of all blocks, read off the prefix offsets.
      */
     inline Eigen::Index rows() const {
-        Eigen::Index __rows{};
-        for (const auto& block : blocks) {
-            __rows += block.rows();
-        }
-        return __rows;
+        return blocks.empty() ? Eigen::Index{} : blocks_begin.back() + blocks.back().rows();
     }
     /**
      * @brief Total column dimension of the reconstructed matrix.
      *
-     * @return Sum of the column sizes of all blocks.
+     * @return Sum of the column sizes of all blocks, read off the prefix offsets.
      */
     inline Eigen::Index cols() const {
-        Eigen::Index __cols{};
-        for (const auto& block : blocks) {
-            __cols += block.cols();
+        return blocks.empty() ? Eigen::Index{} : blocks_begin.back() + blocks.back().cols();
+    }
+
+    /**
+     * @brief Compute out = A in block by block, O(sum_i b_i^2) per column of @p in and without temporaries.
+     *
+     * Makes the block diagonal matrix a LinearOperator, so that Resolvent applies it without forming the full matrix.
+     * The blocks are split into contiguous ranges of about equal cost, one per thread, so that a few large blocks
+     * do not serialize the product. Small products run on the calling thread.
+     *
+     * @param in Vector or matrix with cols() rows; must not alias @p out.
+     * @param out Output with rows() rows and as many columns as @p in; overwritten.
+     */
+    template <class In, class Out>
+    void apply(const In& in, Out&& out) const {
+        assert(in.rows() == cols() && out.rows() == rows() && in.cols() == out.cols());
+        Eigen::Index total_cost{};
+        for (std::size_t i = 0U; i < blocks.size(); ++i) {
+            total_cost += blocks[i].rows() * blocks[i].cols();
         }
-        return __cols;
+        // Each thread takes the blocks whose cost midpoints fall into its share of the total cost
+        const auto apply_range = [&](Eigen::Index thread, Eigen::Index n_threads) {
+            Eigen::Index cost{};
+            for (std::size_t i = 0U; i < blocks.size(); ++i) {
+                const Eigen::Index block_cost = blocks[i].rows() * blocks[i].cols();
+                const Eigen::Index owner = std::min(
+                    n_threads - 1, ((2 * cost + block_cost) * n_threads) / (2 * std::max<Eigen::Index>(total_cost, 1)));
+                cost += block_cost;
+                if (owner == thread) {
+                    out.middleRows(blocks_begin[i], blocks[i].rows()).noalias() =
+                        blocks[i] * in.middleRows(blocks_begin[i], blocks[i].cols());
+                }
+            }
+        };
+#if defined(MROCK_IEOM_PARALLELIZE_BLOCKMATRIX) && defined(_OPENMP)
+        constexpr Eigen::Index min_parallel_cost = Eigen::Index{1} << 15;
+#pragma omp parallel if (total_cost * in.cols() >= min_parallel_cost)
+        apply_range(omp_get_thread_num(), omp_get_num_threads());
+#else
+        apply_range(0, 1);
+#endif
     }
 
     /**
@@ -325,7 +671,7 @@ struct BlockDiagonalMatrix {
 
     BlockDiagonalMatrix operator-() const {
         BlockDiagonalMatrix copy(*this);
-        for (auto& block : copy.blocks) {
+        for (auto&& block : copy.blocks) {
             block *= Scalar{-1.};
         }
         return copy;
@@ -370,17 +716,34 @@ struct BlockDiagonalMatrix {
     /**
      * @brief Multiply each corresponding block by another block matrix.
      *
+     * Packed blocks are multiplied into a per-thread workspace and copied back, see evaluate(),
+     * instead of into a temporary per block.
+     *
      * @tparam _other_base Block matrix type of the right-hand side.
      * @param rhs Matrix to multiply.
      * @return Reference to this object.
      */
     template <class _other_base>
     BlockDiagonalMatrix& operator*=(const BlockDiagonalMatrix<_other_base>& rhs) {
+        if constexpr (block_storage<_matrix_base>::is_packed) {
+            Eigen::Index workspace_size{};
+            for (std::size_t i = 0U; i < blocks.size(); ++i) {
+                workspace_size = std::max(workspace_size, blocks[i].rows() * rhs.blocks[i].cols());
+            }
+            auto function = [&rhs](std::size_t i, auto block, auto& workspace) {
+                Eigen::Map<MatrixN<Scalar>> product(workspace.data(), block.rows(), rhs.blocks[i].cols());
+                product.noalias() = block * rhs.blocks[i];
+                block = product;
+            };
+            // The layout is only needed to assign the expression to another matrix
+            evaluate(BlockWiseExpression<decltype(function)>{{}, workspace_size, std::move(function)});
+        } else {
 #ifdef MROCK_IEOM_PARALLELIZE_BLOCKMATRIX
 #pragma omp parallel for
 #endif
-        for (std::size_t i = 0U; i < blocks.size(); ++i) {
-            this->blocks[i] *= rhs.blocks[i];
+            for (std::size_t i = 0U; i < blocks.size(); ++i) {
+                this->blocks[i] *= rhs.blocks[i];
+            }
         }
         return *this;
     }
@@ -538,23 +901,20 @@ EigenMatrixType operator*(EigenMatrixType basic_matrix, const BlockDiagonalMatri
 /**
  * @brief Multiply a block diagonal matrix on the left by a dense matrix.
  *
- * @tparam EigenMatrixType Dense Eigen matrix type.
+ * The product is evaluated into the result directly, see BlockDiagonalMatrix::apply().
+ *
+ * @tparam EigenMatrixType Dense Eigen matrix or expression type.
  * @tparam _base Block type of the block diagonal matrix.
  * @param block_matrix Block diagonal matrix on the left.
  * @param basic_matrix Dense matrix on the right.
  * @return Result of the multiplication.
  */
 template <class EigenMatrixType, class _base>
-EigenMatrixType operator*(const BlockDiagonalMatrix<_base>& block_matrix, EigenMatrixType basic_matrix) {
-    assert(block_matrix.cols() == basic_matrix.rows());
-#ifdef MROCK_IEOM_PARALLELIZE_BLOCKMATRIX
-#pragma omp parallel for
-#endif
-    for (std::size_t i = 0U; i < block_matrix.blocks.size(); ++i) {
-        basic_matrix.block(block_matrix.blocks_begin[i], 0, block_matrix.blocks[i].rows(), basic_matrix.cols())
-            .applyOnTheLeft(block_matrix.blocks[i]);
-    }
-    return basic_matrix;
+typename EigenMatrixType::PlainObject operator*(const BlockDiagonalMatrix<_base>& block_matrix,
+                                               const EigenMatrixType& basic_matrix) {
+    typename EigenMatrixType::PlainObject result(block_matrix.rows(), basic_matrix.cols());
+    block_matrix.apply(basic_matrix, result);
+    return result;
 }
 
 /*
@@ -637,5 +997,61 @@ BlockDiagonalMatrix<multiplication_result<_matrix_base, diagonal_segment_type<__
     return BlockDiagonalMatrix<multiplication_result<_matrix_base, diagonal_segment_type<__matrix__>>>(
         std::move(new_blocks), lhs.blocks_begin);
 }
+/*
+ *   Fused block-wise products
+ */
+
+/**
+ * @brief Lazy F diag(d) F^H, evaluated per block with one symmetric rank-k update, see symmetric_product_lower().
+ *
+ * Each block F_i is evaluated once into the workspace, even if it is itself a lazy product such as `N * V`,
+ * whereas `F * d.asDiagonal() * F.adjoint()` would evaluate it twice. The result is Hermitian and stored in full.
+ *
+ * @param factor Block diagonal matrix F; must outlive the returned expression, which must not be assigned to it.
+ * @param d Diagonal of the inner matrix, e.g., eigenvalues with a lazily applied function; must outlive
+ *          the returned expression.
+ * @return BlockWiseExpression to assign to a BlockDiagonalMatrix.
+ */
+template <class _base, class VectorType>
+auto congruence(BlockDiagonalMatrix<_base> const& factor, VectorType const& d) {
+    using Scalar = typename BlockDiagonalMatrix<_base>::Scalar;
+    std::vector<HermitianBlock> layout(factor.blocks.size());
+    Eigen::Index workspace_size{};
+    for (std::size_t i = 0U; i < factor.blocks.size(); ++i) {
+        layout[i] = {factor.blocks_begin[i], factor.blocks[i].rows()};
+        workspace_size = std::max(workspace_size, factor.blocks[i].rows() * factor.blocks[i].cols());
+    }
+    auto function = [&factor, &d](std::size_t i, auto block, auto& workspace) {
+        Eigen::Map<MatrixN<Scalar>> scaled(workspace.data(), factor.blocks[i].rows(), factor.blocks[i].cols());
+        scaled.noalias() = factor.blocks[i];
+        symmetric_product_lower(block, scaled, d.segment(factor.blocks_begin[i], factor.blocks[i].cols()));
+        mirror_lower_triangle(block);
+    };
+    return BlockWiseExpression<decltype(function)>{std::move(layout), workspace_size, std::move(function)};
+}
+
+/**
+ * @brief Lazy F M F^H, evaluated per block as two products through the workspace.
+ *
+ * @param factor Block diagonal matrix F; must outlive the returned expression, which must not be assigned to it.
+ * @param inner Block diagonal matrix M; must outlive the returned expression, which may be assigned to it.
+ * @return BlockWiseExpression to assign to a BlockDiagonalMatrix.
+ */
+template <class _base, class _inner_base>
+auto congruence(BlockDiagonalMatrix<_base> const& factor, BlockDiagonalMatrix<_inner_base> const& inner) {
+    using Scalar = typename BlockDiagonalMatrix<_base>::Scalar;
+    std::vector<HermitianBlock> layout(factor.blocks.size());
+    Eigen::Index workspace_size{};
+    for (std::size_t i = 0U; i < factor.blocks.size(); ++i) {
+        layout[i] = {factor.blocks_begin[i], factor.blocks[i].rows()};
+        workspace_size = std::max(workspace_size, factor.blocks[i].rows() * inner.blocks[i].cols());
+    }
+    auto function = [&factor, &inner](std::size_t i, auto block, auto& workspace) {
+        Eigen::Map<MatrixN<Scalar>> left(workspace.data(), factor.blocks[i].rows(), inner.blocks[i].cols());
+        left.noalias() = factor.blocks[i] * inner.blocks[i];
+        block.noalias() = left * factor.blocks[i].adjoint();
+    };
+    return BlockWiseExpression<decltype(function)>{std::move(layout), workspace_size, std::move(function)};
+}
 }  // namespace mrock::iEoM::detail
 #endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_BLOCKDIAGONALMATRIX_HPP
@@ -36,6 +36,46 @@ public:
         return vector;
     };
 
+    /**
+     * @brief Orthogonalize a vector against the columns of an orthonormal panel.
+     *
+     * Two passes of classical Gram-Schmidt ("twice is enough"): each pass computes all
+     * projections at once as h = Q^H v and removes them as v -= Q h, i.e., two GEMVs.
+     * The second pass restores the orthogonality lost to cancellation in the first one.
+     *
+     * @param vector Vector to be orthogonalized in place.
+     * @param panel Matrix whose columns form an orthonormal basis.
+     * @param coefficients Workspace of size panel.cols() for the projection coefficients.
+     */
+    template <class VectorDerived, class PanelDerived>
+    static void orthogonalize_against_panel(Eigen::MatrixBase<VectorDerived>& vector,
+                                            const Eigen::MatrixBase<PanelDerived>& panel,
+                                            Eigen::Ref<vector_t> coefficients) {
+        for (int pass = 0; pass < 2; ++pass) {
+            coefficients.noalias() = panel.adjoint() * vector;
+            vector.noalias() -= panel * coefficients;
+        }
+    };
+
+    /**
+     * @brief Orthogonalize all columns of a block against the columns of an orthonormal panel.
+     *
+     * Block analog of orthogonalize_against_panel(); each of the two passes consists of two GEMMs.
+     * The columns of @p block are not orthogonalized among each other.
+     *
+     * @param block Block whose columns are orthogonalized in place.
+     * @param panel Matrix whose columns form an orthonormal basis.
+     */
+    template <class BlockDerived, class PanelDerived>
+    static void orthogonalize_block_against_panel(Eigen::MatrixBase<BlockDerived>& block,
+                                                  const Eigen::MatrixBase<PanelDerived>& panel) {
+        Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> coefficients(panel.cols(), block.cols());
+        for (int pass = 0; pass < 2; ++pass) {
+            coefficients.noalias() = panel.adjoint() * block;
+            block.noalias() -= panel * coefficients;
+        }
+    };
+
     /**
      * @brief Compute an orthonormal basis from the input vectors.
      *
@@ -0,0 +1,62 @@
+#ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_HERMITICITY_HPP
+#define MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_HERMITICITY_HPP
+#include "UnderlyingRealType.hpp"
+
+#include <Eigen/Dense>
+#include <Eigen/SparseCore>
+
+#include <cmath>
+#include <complex>
+
+namespace mrock::iEoM::detail {
+/**
+ * @brief Frobenius norm of M - M^+ for a dense matrix.
+ *
+ * Compares each pair of off-diagonal entries once instead of materializing M - M^+,
+ * which would require a second n x n matrix.
+ *
+ * @param matrix Square matrix to check.
+ * @return ||M - M^+||_F
+ */
+template <class Derived>
+UnderlyingRealType_t<typename Derived::Scalar> hermiticity_error(const Eigen::MatrixBase<Derived>& matrix) {
+    using RealType = UnderlyingRealType_t<typename Derived::Scalar>;
+    using std::conj;
+    using std::norm;
+    RealType off_diagonal{};
+    RealType diagonal{};
+    for (Eigen::Index j = 0; j < matrix.cols(); ++j) {
+        for (Eigen::Index i = 0; i < j; ++i) {
+            off_diagonal += norm(matrix(i, j) - conj(matrix(j, i)));
+        }
+        diagonal += norm(matrix(j, j) - conj(matrix(j, j)));
+    }
+    return std::sqrt(RealType{2} * off_diagonal + diagonal);
+}
+
+/**
+ * @brief Frobenius norm of M - M^+ for a sparse matrix; O(nnz).
+ *
+ * @param matrix Square matrix to check.
+ * @return ||M - M^+||_F
+ */
+template <class Derived>
+UnderlyingRealType_t<typename Derived::Scalar> hermiticity_error(const Eigen::SparseMatrixBase<Derived>& matrix) {
+    // Eigen requires the same storage order on both sides, thus the adjoint is evaluated first
+    const typename Derived::PlainObject adjoint = matrix.adjoint();
+    return (matrix.derived() - adjoint).norm();
+}
+
+/**
+ * @brief Check whether a dense or sparse matrix is Hermitian.
+ *
+ * @param matrix Square matrix to check.
+ * @param tolerance Maximum allowed ||M - M^+||_F.
+ * @return true if the matrix is Hermitian within @p tolerance.
+ */
+template <class MatrixType>
+inline bool is_hermitian(const MatrixType& matrix, UnderlyingRealType_t<typename MatrixType::Scalar> tolerance) {
+    return matrix.rows() == matrix.cols() && hermiticity_error(matrix) <= tolerance;
+}
+}  // namespace mrock::iEoM::detail
+#endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_HERMITICITY_HPP
@@ -0,0 +1,28 @@
+#ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_INPLACEPRODUCT_HPP
+#define MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_INPLACEPRODUCT_HPP
+#include <Eigen/Dense>
+
+#include <algorithm>
+
+namespace mrock::iEoM::detail {
+/**
+ * @brief Overwrite @p right by left * right, one panel of columns at a time.
+ *
+ * Needs a temporary of left.rows() x panel_width instead of a full copy of the product.
+ * The panels are wide enough for Eigen's GEMM to run at full speed.
+ *
+ * @param left Square matrix.
+ * @param right Matrix with left.cols() rows; overwritten by the product.
+ * @param panel_width Number of columns per panel.
+ */
+template <class MatrixType>
+void multiply_on_the_left_in_place(const MatrixType& left, MatrixType& right, Eigen::Index panel_width = 256) {
+    MatrixType panel(left.rows(), std::min(panel_width, right.cols()));
+    for (Eigen::Index begin = 0; begin < right.cols(); begin += panel_width) {
+        const Eigen::Index width = std::min(panel_width, right.cols() - begin);
+        panel.leftCols(width).noalias() = left * right.middleCols(begin, width);
+        right.middleCols(begin, width) = panel.leftCols(width);
+    }
+}
+}  // namespace mrock::iEoM::detail
+#endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_INPLACEPRODUCT_HPP
@@ -0,0 +1,179 @@
+#ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_KRYLOVBASIS_HPP
+#define MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_KRYLOVBASIS_HPP
+#include "GramSchmidt.hpp"
+
+#include <Eigen/Dense>
+
+#include <cassert>
+
+namespace mrock::iEoM::detail {
+/**
+ * @brief Krylov basis stored as one preallocated column-major panel.
+ *
+ * All basis vectors live back to back in a single n x capacity matrix, so that
+ * projections onto the whole basis are matrix-vector (GEMV) and reconstructions
+ * from the basis are matrix-matrix (GEMM) products instead of loops over
+ * individually allocated vectors.
+ *
+ * @tparam EigenVectorType Vector type of the basis vectors.
+ */
+template <class EigenVectorType>
+class KrylovBasis {
+public:
+    using Scalar = typename EigenVectorType::Scalar;
+    using Panel = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+    using CoefficientVector = Eigen::Vector<Scalar, Eigen::Dynamic>;
+
+private:
+    Panel _panel;
+    Eigen::Index _size{};
+    CoefficientVector _coefficients;
+
+public:
+    KrylovBasis() = default;
+    /**
+     * @brief Allocate storage for a basis of at most @p capacity vectors.
+     *
+     * @param dimension Length of each basis vector.
+     * @param capacity Maximum number of basis vectors.
+     */
+    KrylovBasis(Eigen::Index dimension, Eigen::Index capacity)
+        : _panel(dimension, capacity), _coefficients(capacity){};
+
+    /**
+     * @brief Number of vectors currently stored.
+     */
+    inline Eigen::Index size() const noexcept { return _size; }
+    /**
+     * @brief Maximum number of vectors that fit into the panel.
+     */
+    inline Eigen::Index capacity() const noexcept { return _panel.cols(); }
+    /**
+     * @brief Length of each basis vector.
+     */
+    inline Eigen::Index dimension() const noexcept { return _panel.rows(); }
+
+    /**
+     * @brief View of the i-th basis vector.
+     */
+    inline auto operator[](Eigen::Index i) const { return _panel.col(i); }
+    /**
+     * @brief View of the most recently appended basis vector.
+     */
+    inline auto back() const { return _panel.col(_size - 1); }
+    /**
+     * @brief View of all stored basis vectors, one per column.
+     */
+    inline auto active() const { return _panel.leftCols(_size); }
+    /**
+     * @brief View of the j-th block of @p block_size consecutive basis vectors.
+     */
+    inline auto block(Eigen::Index j, Eigen::Index block_size) const {
+        return _panel.middleCols(j * block_size, block_size);
+    }
+
+    /**
+     * @brief Append a vector to the basis.
+     *
+     * @param vector Vector to append; it is copied into the next free column.
+     */
+    template <class Derived>
+    inline void push_back(const Eigen::MatrixBase<Derived>& vector) {
+        assert(_size < capacity());
+        _panel.col(_size++) = vector;
+    }
+
+    /**
+     * @brief Orthogonalize a vector against all stored basis vectors.
+     *
+     * Uses two passes of classical Gram-Schmidt, see GramSchmidt::orthogonalize_against_panel().
+     *
+     * @param vector Vector to be orthogonalized in place.
+     */
+    template <class Derived>
+    inline void orthogonalize(Eigen::MatrixBase<Derived>& vector) {
+        GramSchmidt<Scalar>::orthogonalize_against_panel(vector, active(), _coefficients.head(_size));
+    }
+    /**
+     * @brief Orthogonalize a vector against the basis vectors [begin, begin + count).
+     *
+     * Used by partial reorthogonalization, which only restores orthogonality against
+     * the vectors it has been lost to.
+     *
+     * @param vector Vector to be orthogonalized in place.
+     * @param begin Index of the first basis vector.
+     * @param count Number of consecutive basis vectors.
+     */
+    template <class Derived>
+    inline void orthogonalize(Eigen::MatrixBase<Derived>& vector, Eigen::Index begin, Eigen::Index count) {
+        assert(begin + count <= _size);
+        GramSchmidt<Scalar>::orthogonalize_against_panel(vector, _panel.middleCols(begin, count),
+                                                         _coefficients.segment(begin, count));
+    }
+    /**
+     * @brief Orthogonalize a vector against all stored basis vectors in the inner product <x|S|y>.
+     *
+     * The basis has to be S-orthonormal and @p metric_basis has to hold the images S|v_i>.
+     * The coefficients are <v_i|S|x> = (S|v_i>)^+ |x>, and S|x> is updated alongside |x>,
+     * so that the metric itself is never applied. Two passes as in orthogonalize().
+     *
+     * @param vector Vector to be orthogonalized in place.
+     * @param metric_vector Image S * vector; updated in place.
+     * @param metric_basis Images of the basis vectors under S, in the same order.
+     */
+    template <class Derived, class MetricDerived>
+    inline void orthogonalize_in_metric(Eigen::MatrixBase<Derived>& vector,
+                                        Eigen::MatrixBase<MetricDerived>& metric_vector,
+                                        const KrylovBasis& metric_basis) {
+        assert(metric_basis.size() == _size);
+        auto coefficients = _coefficients.head(_size);
+        for (int pass = 0; pass < 2; ++pass) {
+            coefficients.noalias() = metric_basis.active().adjoint() * vector;
+            vector.noalias() -= active() * coefficients;
+            metric_vector.noalias() -= metric_basis.active() * coefficients;
+        }
+    }
+    /**
+     * @brief Orthogonalize all columns of a block against all stored basis vectors.
+     *
+     * @param block Block whose columns are orthogonalized in place.
+     */
+    template <class Derived>
+    inline void orthogonalize_block(Eigen::MatrixBase<Derived>& block) const {
+        GramSchmidt<Scalar>::orthogonalize_block_against_panel(block, active());
+    }
+
+    /**
+     * @brief Reconstruct vectors in the original space from their coefficients in the basis.
+     *
+     * @param coefficients Matrix whose columns are expansion coefficients with respect to
+     *                     the first coefficients.rows() basis vectors.
+     * @return Matrix whose columns are the reconstructed vectors (one GEMM).
+     */
+    template <class Derived>
+    inline Panel reconstruct(const Eigen::MatrixBase<Derived>& coefficients) const {
+        Panel result(dimension(), coefficients.cols());
+        result.noalias() = _panel.leftCols(coefficients.rows()) * coefficients;
+        return result;
+    }
+
+    /**
+     * @brief Replace trailing basis vectors by linear combinations of themselves, e.g., for a thick restart.
+     *
+     * Afterwards, the vectors begin, ..., begin + coefficients.cols() - 1 are the columns of
+     * [v_begin, ..., v_(begin + coefficients.rows() - 1)] * coefficients, and
+     * size() == begin + coefficients.cols(). The vectors before @p begin are untouched.
+     *
+     * @param begin Index of the first vector to replace.
+     * @param coefficients Expansion coefficients; requires coefficients.cols() <= coefficients.rows().
+     */
+    template <class Derived>
+    void compress(Eigen::Index begin, const Eigen::MatrixBase<Derived>& coefficients) {
+        assert(coefficients.cols() <= coefficients.rows() && begin + coefficients.rows() <= _size);
+        const Panel compressed = _panel.middleCols(begin, coefficients.rows()) * coefficients;
+        _panel.middleCols(begin, coefficients.cols()) = compressed;
+        _size = begin + coefficients.cols();
+    }
+};
+}  // namespace mrock::iEoM::detail
+#endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_KRYLOVBASIS_HPP
@@ -0,0 +1,41 @@
+#ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_LOWERPRECISION_HPP
+#define MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_LOWERPRECISION_HPP
+#include <complex>
+#include <type_traits>
+
+namespace mrock::iEoM::detail {
+
+/**
+ * @brief Determine the next lower floating point precision of a scalar type.
+ *
+ * double maps to float and long double to double; float is kept as is.
+ * For std::complex types, the underlying real type is lowered.
+ *
+ * @tparam T Input scalar type.
+ */
+template <class T>
+struct LowerPrecision : std::type_identity<T> {};
+
+template <>
+struct LowerPrecision<double> : std::type_identity<float> {};
+
+template <>
+struct LowerPrecision<long double> : std::type_identity<double> {};
+
+/**
+ * @brief Specialization for std::complex types.
+ *
+ * @tparam T Underlying real component type.
+ */
+template <class T>
+struct LowerPrecision<std::complex<T>> : std::type_identity<std::complex<typename LowerPrecision<T>::type>> {};
+
+/**
+ * @brief Helper alias for obtaining the lower precision type.
+ *
+ * @tparam T Input scalar type, with cv/ref qualifiers removed.
+ */
+template <class T>
+using LowerPrecision_t = typename LowerPrecision<std::remove_cvref_t<T>>::type;
+}  // namespace mrock::iEoM::detail
+#endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_LOWERPRECISION_HPP
@@ -0,0 +1,112 @@
+#ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_MAPPEDFILE_HPP
+#define MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_MAPPEDFILE_HPP
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#if __has_include(<sys/mman.h>) && __has_include(<unistd.h>)
+#define MROCK_IEOM_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mrock::iEoM::detail {
+/**
+ * @brief Read-only view of a whole file.
+ *
+ * On POSIX systems, the file is memory-mapped, i.e., pages are only read from disk when they are accessed.
+ * Elsewhere, the file is read into a buffer.
+ */
+class MappedFile {
+private:
+    const char* _data{};
+    std::size_t _size{};
+#ifdef MROCK_IEOM_HAS_MMAP
+    void* _mapping{MAP_FAILED};
+#endif
+    std::vector<char> _buffer;
+
+public:
+    /**
+     * @brief Map the file at @p path; check is_open() afterwards.
+     */
+    explicit MappedFile(const std::filesystem::path& path) {
+#ifdef MROCK_IEOM_HAS_MMAP
+        const int file_descriptor = ::open(path.c_str(), O_RDONLY);
+        if (file_descriptor < 0)
+            return;
+        struct stat file_status;
+        if (::fstat(file_descriptor, &file_status) == 0 && file_status.st_size > 0) {
+            _size = static_cast<std::size_t>(file_status.st_size);
+            _mapping = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+            if (_mapping == MAP_FAILED) {
+                _size = 0U;
+            } else {
+                _data = static_cast<const char*>(_mapping);
+            }
+        }
+        ::close(file_descriptor);
+#else
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+            return;
+        _buffer.resize(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        if (file.read(_buffer.data(), _buffer.size())) {
+            _data = _buffer.data();
+            _size = _buffer.size();
+        }
+#endif
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() {
+#ifdef MROCK_IEOM_HAS_MMAP
+        if (_mapping != MAP_FAILED)
+            ::munmap(_mapping, _size);
+#endif
+    }
+
+    inline bool is_open() const noexcept { return _data != nullptr; }
+    inline const char* data() const noexcept { return _data; }
+    inline std::size_t size() const noexcept { return _size; }
+};
+
+/**
+ * @brief Sequential reader of trivially copyable values from a MappedFile.
+ */
+class MappedFileReader {
+private:
+    const MappedFile& _file;
+    std::size_t _position{};
+
+public:
+    explicit MappedFileReader(const MappedFile& file) : _file(file){};
+
+    /**
+     * @brief Number of bytes that have not been read yet.
+     */
+    inline std::size_t remaining() const noexcept { return _file.size() - _position; }
+
+    /**
+     * @brief Copy @p count values to @p destination.
+     *
+     * @return false if the file is too short.
+     */
+    template <class T>
+    bool read(T* destination, std::size_t count = 1U) {
+        // Compared by division, so that a corrupted count cannot overflow
+        if (count > remaining() / sizeof(T))
+            return false;
+        const std::size_t n_bytes = count * sizeof(T);
+        std::memcpy(destination, _file.data() + _position, n_bytes);
+        _position += n_bytes;
+        return true;
+    }
+};
+}  // namespace mrock::iEoM::detail
+#endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_MAPPEDFILE_HPP
@@ -0,0 +1,151 @@
+#ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_OMEGARECURRENCE_HPP
+#define MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_OMEGARECURRENCE_HPP
+#include <Eigen/Core>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace mrock::iEoM::detail {
+/**
+ * @brief Estimates the loss of orthogonality in the Lanczos recurrence.
+ *
+ * Implements the omega recurrence of H. D. Simon, Math. Comp. 42, 115 (1984),
+ * which tracks omega_{j,k} ~ <q_j|q_k> using only the recurrence coefficients.
+ * Whenever an estimate exceeds sqrt(eps), the new Lanczos vector has to be
+ * reorthogonalized against the affected vectors, i.e., all vectors around the peak
+ * whose estimate exceeds eps^(3/4). As the previous vector is contaminated as well,
+ * the following Lanczos vector is reorthogonalized against the same vectors.
+ *
+ * Indexing follows the storage in Resolvent: alphas[k] belongs to q_k and betas[k]
+ * (k >= 1) couples q_(k-1) and q_k; betas[0] is a dummy entry.
+ *
+ * @tparam RealType Floating point type of the recurrence coefficients.
+ */
+template <class RealType>
+class OmegaRecurrence {
+public:
+    using Interval = std::pair<Eigen::Index, Eigen::Index>;  // begin, size
+
+private:
+    std::vector<RealType> _omega_previous;  // omega_{j-1, k}
+    std::vector<RealType> _omega_current;   // omega_{j, k}
+    std::vector<RealType> _omega_next;      // omega_{j+1, k}
+    std::vector<Interval> _intervals;
+
+    const RealType _eps1;
+    const RealType _sqrt_eps;
+    const RealType _eta;
+    RealType _norm_estimate{};
+    bool _second_pass{};
+
+    inline RealType coupling(const std::vector<RealType>& betas, Eigen::Index k) const {
+        return k > 0 ? betas[k] : RealType{};
+    }
+
+    void determine_intervals(Eigen::Index j) {
+        _intervals.clear();
+        Eigen::Index k = 0;
+        while (k <= j) {
+            if (std::abs(_omega_next[k]) < _sqrt_eps) {
+                ++k;
+                continue;
+            }
+            Eigen::Index begin = k;
+            while (begin > 0 && std::abs(_omega_next[begin - 1]) >= _eta) {
+                --begin;
+            }
+            Eigen::Index end = k + 1;
+            while (end <= j && std::abs(_omega_next[end]) >= _eta) {
+                ++end;
+            }
+            if (!_intervals.empty() && _intervals.back().first + _intervals.back().second >= begin) {
+                _intervals.back().second = end - _intervals.back().first;
+            } else {
+                _intervals.emplace_back(begin, end - begin);
+            }
+            k = end;
+        }
+    }
+
+public:
+    /**
+     * @brief Prepare the estimator.
+     *
+     * @param dimension Dimension of the operator.
+     * @param capacity Maximum number of Lanczos vectors.
+     */
+    OmegaRecurrence(Eigen::Index dimension, Eigen::Index capacity)
+        : _omega_previous(capacity + 1),
+          _omega_current(capacity + 1),
+          _omega_next(capacity + 1),
+          _eps1(std::numeric_limits<RealType>::epsilon() * std::sqrt(static_cast<RealType>(dimension))),
+          _sqrt_eps(std::sqrt(std::numeric_limits<RealType>::epsilon())),
+          _eta(std::pow(std::numeric_limits<RealType>::epsilon(), RealType{0.75})) {
+        _omega_current[0] = RealType{1};
+    };
+
+    /**
+     * @brief Compute the estimates omega_{j+1, k} for the new Lanczos vector q_(j+1).
+     *
+     * @param alphas Diagonal recurrence coefficients alpha_0 ... alpha_j.
+     * @param betas Off-diagonal recurrence coefficients, where betas[j+1] is the norm of the new residual.
+     * @return true if q_(j+1) must be reorthogonalized against intervals().
+     */
+    bool update(const std::vector<RealType>& alphas, const std::vector<RealType>& betas) {
+        const Eigen::Index j = static_cast<Eigen::Index>(alphas.size()) - 1;
+        const RealType beta_next = betas[j + 1];
+        _norm_estimate = std::max(_norm_estimate, std::abs(alphas[j]) + beta_next + coupling(betas, j));
+
+        for (Eigen::Index k = 0; k < j; ++k) {
+            RealType omega = coupling(betas, k + 1) * _omega_current[k + 1] +
+                             (alphas[k] - alphas[j]) * _omega_current[k] - coupling(betas, j) * _omega_previous[k];
+            if (k > 0) {
+                omega += coupling(betas, k) * _omega_current[k - 1];
+            }
+            // Rounding errors are accounted for with a bound of the same sign
+            const RealType rounding = _eps1 * (std::hypot(alphas[k] - alphas[j], coupling(betas, k + 1)) +
+                                               std::hypot(coupling(betas, k), coupling(betas, j)) + _norm_estimate);
+            _omega_next[k] = (omega + std::copysign(rounding, omega)) / beta_next;
+        }
+        _omega_next[j] = _eps1 * _norm_estimate / beta_next;
+        _omega_next[j + 1] = RealType{1};
+
+        if (_second_pass) {
+            return true;
+        }
+        if (std::any_of(_omega_next.begin(), _omega_next.begin() + j + 1,
+                        [this](RealType omega) { return std::abs(omega) >= _sqrt_eps; })) {
+            determine_intervals(j);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Vectors (as [begin, begin + size) intervals) against which q_(j+1) must be reorthogonalized.
+     */
+    inline const std::vector<Interval>& intervals() const noexcept { return _intervals; }
+
+    /**
+     * @brief Register that q_(j+1) has been reorthogonalized against intervals().
+     */
+    void reorthogonalized() {
+        for (const auto& [begin, size] : _intervals) {
+            std::fill_n(_omega_next.begin() + begin, size, _eps1);
+        }
+        _second_pass = !_second_pass;
+    }
+
+    /**
+     * @brief Shift the estimates by one Lanczos step.
+     */
+    void advance() {
+        std::swap(_omega_previous, _omega_current);
+        std::swap(_omega_current, _omega_next);
+    }
+};
+}  // namespace mrock::iEoM::detail
+#endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_OMEGARECURRENCE_HPP
@@ -1,20 +1,127 @@
 #ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_PIVOTTOBLOCKSTRUCTURE_HPP
 #define MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_PIVOTTOBLOCKSTRUCTURE_HPP
 #include "BlockDiagonalMatrix.hpp"
+#include "PositiveDefinite.hpp"
 #include "UnderlyingRealType.hpp"
 
 #include <Eigen/Dense>
 
+#include <algorithm>
 #include <cstddef>
+#include <numeric>
+#include <stdexcept>
 #include <vector>
 
 namespace mrock::iEoM::detail {
+/**
+ * @brief Disjoint sets of the indices 0, ..., n-1 (union-find) with path halving and union by size.
+ */
+class DisjointSets {
+private:
+    std::vector<Eigen::Index> _parents;
+    std::vector<Eigen::Index> _sizes;
+
+public:
+    explicit DisjointSets(Eigen::Index n) : _parents(static_cast<std::size_t>(n)), _sizes(_parents.size(), 1) {
+        std::iota(_parents.begin(), _parents.end(), Eigen::Index{});
+    }
+
+    /**
+     * @brief Representative of the set containing @p i.
+     */
+    Eigen::Index find(Eigen::Index i) noexcept {
+        while (_parents[i] != i) {
+            _parents[i] = _parents[_parents[i]];
+            i = _parents[i];
+        }
+        return i;
+    }
+
+    /**
+     * @brief Merges the sets containing @p i and @p j.
+     */
+    void unite(Eigen::Index i, Eigen::Index j) noexcept {
+        i = find(i);
+        j = find(j);
+        if (i == j)
+            return;
+        if (_sizes[i] < _sizes[j])
+            std::swap(i, j);
+        _parents[j] = i;
+        _sizes[i] += _sizes[j];
+    }
+};
+
+/**
+ * @brief Permutation to block diagonal form together with the resulting blocks.
+ *
+ * P^T M P is block diagonal with the diagonal blocks `blocks`, i.e., P.indices()(i) is the original index
+ * of the i-th row and column of the pivoted matrix.
+ */
+struct BlockStructure {
+    Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic> permutation;
+    std::vector<HermitianBlock> blocks;
+};
+
+/**
+ * @brief Find the blocks shared by one or more Hermitian matrices.
+ *
+ * The blocks are the connected components of the graph whose edges are the entries above @p epsilon
+ * in any of the matrices. They are found by union-find in a single pass over the lower triangles,
+ * O(n^2) for dense matrices, and ordered by their smallest index, with the indices of each block in ascending order.
+ *
+ * @param epsilon Tolerance below which entries are treated as zero.
+ * @param matrix First matrix to analyze; only its lower triangle is read.
+ * @param others Further matrices of the same dimension, e.g., the norm matrix; only their lower triangles are read.
+ * @return The permutation and the blocks of the pivoted matrices.
+ */
+template <class EigenMatrixType, class... OtherMatrixTypes>
+BlockStructure find_block_structure(const detail::RealScalar<EigenMatrixType> epsilon,
+                                    const EigenMatrixType& matrix,
+                                    const OtherMatrixTypes&... others) {
+    const Eigen::Index n = matrix.rows();
+    DisjointSets components(n);
+    auto add_edges = [&components, epsilon, n](const auto& pattern) {
+        for (Eigen::Index j = 0; j < n; ++j) {
+            for (Eigen::Index i = j + 1; i < n; ++i) {
+                if (abs(pattern.coeff(i, j)) > epsilon) {
+                    components.unite(i, j);
+                }
+            }
+        }
+    };
+    add_edges(matrix);
+    (add_edges(others), ...);
+
+    // Counting sort of the indices by component; components are numbered in the order of their smallest index
+    std::vector<Eigen::Index> block_of(static_cast<std::size_t>(n), -1);
+    BlockStructure structure;
+    for (Eigen::Index i = 0; i < n; ++i) {
+        const Eigen::Index root = components.find(i);
+        if (block_of[root] < 0) {
+            block_of[root] = static_cast<Eigen::Index>(structure.blocks.size());
+            structure.blocks.push_back({Eigen::Index{}, Eigen::Index{}});
+        }
+        ++structure.blocks[block_of[root]].size;
+    }
+    std::vector<Eigen::Index> next(structure.blocks.size());
+    for (std::size_t b = 1U; b < structure.blocks.size(); ++b) {
+        structure.blocks[b].position = structure.blocks[b - 1U].position + structure.blocks[b - 1U].size;
+        next[b] = structure.blocks[b].position;
+    }
+    structure.permutation.resize(n);
+    for (Eigen::Index i = 0; i < n; ++i) {
+        structure.permutation.indices()(next[block_of[components.find(i)]]++) = static_cast<int>(i);
+    }
+    return structure;
+}
+
 /**
  * @brief Compute a permutation that groups zero off-diagonal blocks.
  *
  * The returned permutation reorders rows and columns such that
  * contiguous zero off-diagonal regions in the matrix become block
- * diagonal structure.
+ * diagonal structure, see find_block_structure().
  *
  * @tparam EigenMatrixType Matrix type to analyze.
  * @param matrix Input matrix.
@@ -25,25 +132,21 @@ template <class EigenMatrixType>
 Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic> pivot_to_block_structure(
     const EigenMatrixType& matrix,
     const detail::RealScalar<EigenMatrixType> epsilon = 1e-12) {
-    Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic> P(matrix.rows());
-    P.setIdentity();
-
-    auto permuted_matrix_element = [&matrix, &P](Eigen::Index i, Eigen::Index j) {
-        return matrix.coeffRef(P.indices()(i), P.indices()(j));
-    };
-
-    for (Eigen::Index i = 0; i < matrix.rows(); ++i) {
-        int offset = 1;
-        for (Eigen::Index j = i + 1; j < matrix.cols(); ++j) {
-            if (abs(permuted_matrix_element(i, j)) > epsilon) {
-                P.applyTranspositionOnTheRight(j, i + offset);
-                ++offset;
-            }
-        }
-    }
-    return P;
+    return find_block_structure(epsilon, matrix).permutation;
 };
 
+/**
+ * @brief Overwrites @p matrix by P^T matrix P without temporaries.
+ *
+ * Rows and columns are permuted in place along the cycles of the permutation.
+ */
+template <class EigenMatrixType>
+void permute_in_place(EigenMatrixType& matrix,
+                      const Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic>& permutation) {
+    matrix.applyOnTheLeft(permutation.transpose());
+    matrix.applyOnTheRight(permutation);
+}
+
 /**
  * @brief Wrapper for eigenvector and eigenvalue results.
  *
@@ -118,11 +221,10 @@ struct matrix_wrapper {
      * @return matrix_wrapper containing the eigenpairs of the original matrix.
      */
     static matrix_wrapper pivot_and_solve(MatrixType& toSolve) {
-        auto pivot = pivot_to_block_structure(toSolve);
-        toSolve = pivot.transpose() * toSolve * pivot;
-        const auto blocks = identify_hermitian_blocks(toSolve);
-        auto solution = solve_block_diagonal_matrix(toSolve, blocks);
-        solution.eigenvectors.applyOnTheLeft(pivot);
+        const auto structure = find_block_structure(RealType(1e-12), toSolve);
+        permute_in_place(toSolve, structure.permutation);
+        auto solution = solve_block_diagonal_matrix(toSolve, structure.blocks);
+        solution.eigenvectors.applyOnTheLeft(structure.permutation);
         return solution;
     };
 
@@ -134,29 +236,104 @@ struct matrix_wrapper {
      */
     static matrix_wrapper only_solve(MatrixType& toSolve) {
         Eigen::SelfAdjointEigenSolver<MatrixType> solver(toSolve);
-        matrix_wrapper solution(toSolve.rows());
+        matrix_wrapper solution;
         solution.eigenvalues = solver.eigenvalues();
         solution.eigenvectors = solver.eigenvectors();
         return solution;
     };
 
+    /**
+     * @brief Same as only_solve(), but the matrix is released before the eigenvectors are moved out of the solver.
+     *
+     * Needs one additional n x n matrix, the solver's working copy, instead of two. Eigen's in-place
+     * tridiagonalization would avoid even that, but it is internal API whose signature differs between releases.
+     *
+     * Throws std::runtime_error if the eigensolver does not converge.
+     *
+     * @param toSolve Matrix to diagonalize; only its lower triangle is read. Empty afterwards.
+     * @return matrix_wrapper containing eigenpairs.
+     */
+    static matrix_wrapper solve_in_place(MatrixType& toSolve) {
+        Eigen::SelfAdjointEigenSolver<MatrixType> solver(toSolve);
+        toSolve.resize(0, 0);
+        if (solver.info() != Eigen::Success) {
+            throw std::runtime_error("The in-place eigensolver did not converge!");
+        }
+        matrix_wrapper solution;
+        solution.eigenvalues = solver.eigenvalues();
+        // The solver is discarded, so its eigenvectors may be taken over instead of copied
+        solution.eigenvectors = std::move(const_cast<MatrixType&>(solver.eigenvectors()));
+        return solution;
+    }
+
+    /**
+     * @brief Same as pivot_and_solve(), but the storage of the matrix is reused for the eigenvectors.
+     *
+     * The matrix is permuted in place and each block is overwritten by its eigenvectors, so that only
+     * the eigensolver of the largest block needs additional memory. Throws std::runtime_error if the eigensolver
+     * does not converge for some block.
+     *
+     * @param toSolve Matrix to solve. Empty afterwards.
+     * @return matrix_wrapper containing the eigenpairs of the original matrix.
+     */
+    static matrix_wrapper pivot_and_solve_in_place(MatrixType& toSolve) {
+        const auto structure = find_block_structure(RealType(1e-12), toSolve);
+        const auto& pivot = structure.permutation;
+        const auto& blocks = structure.blocks;
+        permute_in_place(toSolve, pivot);
+
+        matrix_wrapper solution;
+        solution.eigenvalues.resize(toSolve.rows());
+        // Exceptions must not leave the parallel region
+        bool converged = true;
+#ifdef MROCK_IEOM_PARALLELIZE_BLOCKMATRIX
+#pragma omp parallel for reduction(&& : converged)
+#endif
+        for (std::size_t i = 0; i < blocks.size(); ++i) {
+            auto block = toSolve.block(blocks[i].position, blocks[i].position, blocks[i].size, blocks[i].size);
+            Eigen::SelfAdjointEigenSolver<MatrixType> solver(block);
+            converged = converged && solver.info() == Eigen::Success;
+            solution.eigenvalues.segment(blocks[i].position, blocks[i].size) = solver.eigenvalues();
+            block = solver.eigenvectors();
+        }
+        if (!converged) {
+            toSolve.resize(0, 0);
+            throw std::runtime_error("The in-place eigensolver did not converge!");
+        }
+        // The couplings between the blocks are below the pivoting threshold; the eigenvectors do not contain them
+        for (const auto& block : blocks) {
+            toSolve.middleRows(block.position, block.size).leftCols(block.position).setZero();
+            toSolve.middleRows(block.position, block.size).rightCols(toSolve.cols() - block.position - block.size)
+                .setZero();
+        }
+        solution.eigenvectors = std::move(toSolve);
+        toSolve.resize(0, 0);
+        solution.eigenvectors.applyOnTheLeft(pivot);
+        return solution;
+    }
+
     /**
      * @brief Test whether the matrix is non-negative definite.
      *
-     * The matrix is pivoted to block diagonal form, and each block's
-     * smallest eigenvalue is compared against -EPSILON.
+     * A Cholesky decomposition of the shifted matrix accepts the matrix directly
+     * if its eigenvalues exceed -EPSILON / 2. Only otherwise, the blocks of the
+     * matrix are identified, see find_block_structure(), and each block's smallest eigenvalue is compared
+     * against -EPSILON.
      *
-     * @param toSolve Matrix to test.
+     * @param toSolve Matrix to test; unchanged on return.
      * @param EPSILON Tolerance for negative eigenvalues.
      * @return True if the matrix is non-negative definite.
      */
     static bool is_non_negative(MatrixType& toSolve, const RealType EPSILON) {
-        auto pivot = pivot_to_block_structure(toSolve);
-        toSolve = pivot.transpose() * toSolve * pivot;
-        auto blocks = identify_hermitian_blocks(toSolve);
-        for (const auto& block : blocks) {
-            Eigen::SelfAdjointEigenSolver<MatrixType> solver(
-                toSolve.block(block.position, block.position, block.size, block.size), Eigen::EigenvaluesOnly);
+        // A Cholesky decomposition of toSolve + EPSILON / 2 decides the common case at a fraction of the cost
+        if (eigenvalues_exceed(toSolve, -EPSILON / 2))
+            return true;
+        // The blocks are gathered one at a time; the matrix itself is not permuted
+        const auto structure = find_block_structure(RealType(1e-12), toSolve);
+        for (const auto& block : structure.blocks) {
+            const auto indices = structure.permutation.indices().segment(block.position, block.size);
+            Eigen::SelfAdjointEigenSolver<MatrixType> solver(MatrixType(toSolve(indices, indices)),
+                                                             Eigen::EigenvaluesOnly);
 
             if ((solver.eigenvalues().array() < -EPSILON).any()) {
                 return false;
@@ -205,8 +382,7 @@ struct matrix_wrapper<BlockDiagonalMatrix<detail::MatrixN<Number>>,
     static matrix_wrapper solve_block_diagonal_matrix(const BlockDiagonalMatrix<detail::MatrixN<Number>>& toSolve) {
         matrix_wrapper solution;
         solution.eigenvalues = Eigen::Vector<UnderlyingRealType_t<Number>, Eigen::Dynamic>::Zero(toSolve.rows());
-        solution.eigenvectors.blocks.resize(toSolve.blocks.size());
-        solution.eigenvectors.blocks_begin = toSolve.blocks_begin;
+        solution.eigenvectors = BlockDiagonalMatrix<detail::MatrixN<Number>>(toSolve.layout());
 #ifdef MROCK_IEOM_PARALLELIZE_BLOCKMATRIX
 #pragma omp parallel for
 #endif
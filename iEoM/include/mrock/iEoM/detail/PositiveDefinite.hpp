@@ -0,0 +1,72 @@
+#ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_POSITIVEDEFINITE_HPP
+#define MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_POSITIVEDEFINITE_HPP
+#include "UnderlyingRealType.hpp"
+
+#include <Eigen/Dense>
+
+namespace mrock::iEoM::detail {
+/**
+ * @brief Restores a Hermitian matrix from its strictly upper triangle and its @p diagonal.
+ */
+template <class MatrixType, class DiagonalType>
+void restore_from_upper_triangle(MatrixType& matrix, const DiagonalType& diagonal) {
+    matrix.diagonal() = diagonal;
+    for (Eigen::Index j = 0; j + 1 < matrix.cols(); ++j) {
+        matrix.col(j).tail(matrix.rows() - j - 1) = matrix.row(j).tail(matrix.cols() - j - 1).adjoint();
+    }
+}
+
+/**
+ * @brief Whether all eigenvalues of the Hermitian @p matrix exceed @p lower_bound.
+ *
+ * Attempts the Cholesky decomposition of matrix - lower_bound, which exists iff the statement is true
+ * (up to rounding). This costs n^3 / 3 flops instead of an eigendecomposition and needs no additional memory:
+ * the decomposition only overwrites the lower triangle, which is restored from the strictly upper triangle
+ * and the saved diagonal afterwards.
+ *
+ * @param matrix Full Hermitian matrix; unchanged on return.
+ * @param lower_bound Bound for the eigenvalues; may be negative.
+ */
+template <class MatrixType>
+bool eigenvalues_exceed(MatrixType& matrix, UnderlyingRealType_t<typename MatrixType::Scalar> lower_bound) {
+    const Eigen::Vector<typename MatrixType::Scalar, Eigen::Dynamic> diagonal = matrix.diagonal();
+    matrix.diagonal().array() -= lower_bound;
+    const bool success = Eigen::LLT<Eigen::Ref<MatrixType>>(matrix).info() == Eigen::Success;
+    restore_from_upper_triangle(matrix, diagonal);
+    return success;
+}
+
+/**
+ * @brief Overwrites @p matrix by its Cholesky factor C, matrix = C C^H, if all eigenvalues exceed @p lower_bound.
+ *
+ * With a positive @p lower_bound, the factor is as well conditioned as the eigendecomposition of the matrix,
+ * whose eigenvalues would all pass a pseudo-inverse with threshold @p lower_bound. Then, the factor can replace
+ * the eigendecomposition whenever only the inverse or a similarity transform is needed.
+ *
+ * The matrix is factorized only once (n^3 / 3 flops). The smallest eigenvalue is then bounded from the factor
+ * in O(n^2) by 1 / ||matrix^(-1)||_1 <= 1 / ||matrix^(-1)||_2 = lambda_min, where ||matrix^(-1)||_1 is
+ * LLT::rcond()'s estimate. The bound is conservative by the ratio of the two norms, at most sqrt(n): a matrix whose
+ * smallest eigenvalue is close above @p lower_bound may be rejected, which only costs the speed-up.
+ *
+ * @param matrix Full Hermitian matrix; on success, C in the lower triangle and zeros above it; unchanged otherwise.
+ * @param lower_bound Bound for the eigenvalues; for a non-positive bound, the matrix only has to be positive definite.
+ * @return Whether @p matrix has been factorized.
+ */
+template <class MatrixType>
+bool cholesky_in_place_if_above(MatrixType& matrix, UnderlyingRealType_t<typename MatrixType::Scalar> lower_bound) {
+    using RealType = UnderlyingRealType_t<typename MatrixType::Scalar>;
+    if (matrix.rows() == 0)
+        return true;
+    const Eigen::Vector<typename MatrixType::Scalar, Eigen::Dynamic> diagonal = matrix.diagonal();
+    // The 1-norm of the matrix, which rcond() refers to
+    const RealType norm = matrix.cwiseAbs().colwise().sum().maxCoeff();
+    const Eigen::LLT<Eigen::Ref<MatrixType>> cholesky(matrix);
+    if (cholesky.info() != Eigen::Success || (lower_bound > RealType{} && cholesky.rcond() * norm <= lower_bound)) {
+        restore_from_upper_triangle(matrix, diagonal);
+        return false;
+    }
+    matrix.template triangularView<Eigen::StrictlyUpper>().setZero();
+    return true;
+}
+}  // namespace mrock::iEoM::detail
+#endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_POSITIVEDEFINITE_HPP
@@ -0,0 +1,139 @@
+#ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_RITZTRACKER_HPP
+#define MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_RITZTRACKER_HPP
+#include "SymmetricTridiagonal.hpp"
+
+#include <Eigen/Core>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace mrock::iEoM::detail {
+/**
+ * @brief Tracks the lowest Ritz values of a growing Lanczos tridiagonal matrix.
+ *
+ * Instead of diagonalizing the whole m x m tridiagonal matrix T_m, the requested eigenvalues are
+ * found by Sturm sequence bisection, O(m) per bisection step, and the corresponding eigenvectors
+ * of T_m by inverse iteration, O(m) each, see SymmetricTridiagonal.
+ * Thus, one update costs O(k m) for the lowest k values.
+ * The bisection is warm-started from the previous update via Cauchy interlacing:
+ * adding c rows gives lambda_(j-c)(T_m) <= lambda_j(T_(m+c)) <= lambda_j(T_m).
+ *
+ * Eigenvalues are computed lazily, so Lanczos ghosts that have to be skipped only cost
+ * one more bisection each.
+ *
+ * Indexing follows the storage in Resolvent: alphas[k] belongs to q_k and betas[k]
+ * (k >= 1) couples q_(k-1) and q_k; betas[0] is a dummy entry.
+ *
+ * @tparam RealType Floating point type of the recurrence coefficients.
+ */
+template <class RealType>
+class RitzTracker {
+public:
+    using Vector = Eigen::Vector<RealType, Eigen::Dynamic>;
+
+private:
+    static constexpr RealType eps = std::numeric_limits<RealType>::epsilon();
+
+    SymmetricTridiagonal<RealType> _matrix;
+
+    std::vector<RealType> _eigenvalues;  // lowest eigenvalues of the current T_m, computed lazily
+    std::vector<RealType> _previous;     // eigenvalues of the previous update
+    Eigen::Index _previous_size{};
+    std::vector<Vector> _eigenvectors;  // eigenvectors of the current T_m, computed lazily
+
+    RealType bisect(Eigen::Index j) const {
+        RealType lower = _matrix.lower_bound();
+        RealType upper = _matrix.upper_bound();
+        // Warm start; the slack accounts for the finite accuracy of the previous values
+        if (!_previous.empty()) {
+            const Eigen::Index shift = _matrix.size() - _previous_size;
+            if (j < static_cast<Eigen::Index>(_previous.size())) {
+                const RealType candidate = _previous[j] + 4 * eps * std::abs(_previous[j]) + _matrix.pivot_min();
+                if (_matrix.count_below(candidate) > j) {
+                    upper = std::min(upper, candidate);
+                }
+            }
+            if (j >= shift && j - shift < static_cast<Eigen::Index>(_previous.size())) {
+                const RealType candidate =
+                    _previous[j - shift] - 4 * eps * std::abs(_previous[j - shift]) - _matrix.pivot_min();
+                if (_matrix.count_below(candidate) <= j) {
+                    lower = std::max(lower, candidate);
+                }
+            }
+        }
+        return _matrix.bisect(j, lower, upper);
+    }
+
+public:
+    /**
+     * @brief Set the current tridiagonal matrix T_m.
+     *
+     * alphas and betas must stay alive and unchanged until the next call.
+     *
+     * @param alphas Diagonal elements; at least @p size entries.
+     * @param betas Off-diagonal elements including the dummy betas[0]; at least @p size entries.
+     * @param size Dimension m of the tridiagonal matrix.
+     */
+    void update(const std::vector<RealType>& alphas, const std::vector<RealType>& betas, Eigen::Index size) {
+        if (!_eigenvalues.empty()) {
+            _previous = std::move(_eigenvalues);
+            _previous_size = _matrix.size();
+        }
+        _eigenvalues.clear();
+        _eigenvectors.clear();
+        _matrix.reset(alphas.data(), betas.data() + 1, size);
+    }
+
+    /**
+     * @brief Dimension of the current tridiagonal matrix.
+     */
+    inline Eigen::Index size() const noexcept { return _matrix.size(); }
+
+    /**
+     * @brief The j-th lowest eigenvalue of T_m (j < size()), in ascending order.
+     */
+    RealType eigenvalue(Eigen::Index j) {
+        while (static_cast<Eigen::Index>(_eigenvalues.size()) <= j) {
+            _eigenvalues.push_back(bisect(static_cast<Eigen::Index>(_eigenvalues.size())));
+        }
+        return _eigenvalues[j];
+    }
+
+    /**
+     * @brief Normalized eigenvector of T_m belonging to the j-th lowest eigenvalue.
+     *
+     * Computed by inverse iteration; the sign is arbitrary. Eigenvectors of a cluster of close eigenvalues
+     * are orthogonalized against each other, see SymmetricTridiagonal::cluster_gap(). Otherwise,
+     * near-degenerate Ritz values, e.g., a Ritz value and its Lanczos ghost, would give almost parallel vectors.
+     */
+    Vector eigenvector(Eigen::Index j) {
+        Eigen::Index cluster_begin = j;
+        while (cluster_begin > 0 &&
+               eigenvalue(cluster_begin) - eigenvalue(cluster_begin - 1) <= _matrix.cluster_gap()) {
+            --cluster_begin;
+        }
+        if (static_cast<Eigen::Index>(_eigenvectors.size()) <= j) {
+            _eigenvectors.resize(j + 1);
+        }
+        for (Eigen::Index k = cluster_begin; k <= j; ++k) {
+            if (_eigenvectors[k].size() > 0) {
+                continue;
+            }
+            // A start vector without symmetries, so that it is not orthogonal to the eigenvector
+            Vector vector = Vector::LinSpaced(_matrix.size(), RealType{1}, RealType{2});
+            _matrix.inverse_iteration(eigenvalue(k), 3, vector, [&](Vector& iterate) {
+                for (int pass = 0; pass < 2; ++pass) {
+                    for (Eigen::Index i = cluster_begin; i < k; ++i) {
+                        iterate -= _eigenvectors[i].dot(iterate) * _eigenvectors[i];
+                    }
+                }
+            });
+            _eigenvectors[k] = std::move(vector);
+        }
+        return _eigenvectors[j];
+    }
+};
+}  // namespace mrock::iEoM::detail
+#endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_RITZTRACKER_HPP
@@ -0,0 +1,61 @@
+#ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_SYMMETRICPRODUCT_HPP
+#define MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_SYMMETRICPRODUCT_HPP
+#include <Eigen/Dense>
+
+#include <cmath>
+
+namespace mrock::iEoM::detail {
+/**
+ * @brief Compute the lower triangle of result = B diag(d) B^H with symmetric rank-k updates.
+ *
+ * The columns of @p factor are scaled in place by sqrt(|d_j|), so that the product becomes
+ * sum_s s * B_s B_s^H with s = +1 and s = -1 (signed split for indefinite d).
+ * Each run of consecutive columns with the same sign of d is one rank-k update (SYRK),
+ * which needs half the FLOPs of the general product and no temporaries.
+ * For sorted d, there are at most two runs. Columns with d_j = 0 do not contribute.
+ *
+ * Only the lower triangle of @p result is written; the strictly upper triangle is zero.
+ * Eigen's SelfAdjointEigenSolver only reads the lower triangle; otherwise, see mirror_lower_triangle().
+ *
+ * @param result Output; resized to factor.rows() x factor.rows(). May be a map of that size.
+ * @param factor The matrix B; overwritten by B |diag(d)|^(1/2).
+ * @param d Diagonal of the inner matrix, one entry per column of @p factor.
+ */
+template <class ResultType, class FactorType, class VectorType>
+void symmetric_product_lower(ResultType& result, FactorType& factor, const VectorType& d) {
+    using RealType = typename VectorType::Scalar;
+    result.resize(factor.rows(), factor.rows());
+    result.setZero();
+    auto sign = [&d](Eigen::Index j) { return (d(j) > RealType{}) - (d(j) < RealType{}); };
+
+    Eigen::Index begin{};
+    while (begin < factor.cols()) {
+        const int run_sign = sign(begin);
+        Eigen::Index end = begin + 1;
+        while (end < factor.cols() && sign(end) == run_sign) {
+            ++end;
+        }
+        if (run_sign != 0) {
+            for (Eigen::Index j = begin; j < end; ++j) {
+                factor.col(j) *= std::sqrt(std::abs(d(j)));
+            }
+            result.template selfadjointView<Eigen::Lower>().rankUpdate(factor.middleCols(begin, end - begin),
+                                                                         RealType(run_sign));
+        }
+        begin = end;
+    }
+}
+
+/**
+ * @brief Copy the (adjoint of the) strictly lower triangle to the strictly upper triangle in place.
+ *
+ * O(n^2) and without temporaries.
+ */
+template <class MatrixType>
+void mirror_lower_triangle(MatrixType& matrix) {
+    for (Eigen::Index j = 0; j + 1 < matrix.cols(); ++j) {
+        matrix.row(j).tail(matrix.cols() - j - 1) = matrix.col(j).tail(matrix.rows() - j - 1).adjoint();
+    }
+}
+}  // namespace mrock::iEoM::detail
+#endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_SYMMETRICPRODUCT_HPP
@@ -0,0 +1,217 @@
+#ifndef MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_SYMMETRICTRIDIAGONAL_HPP
+#define MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_SYMMETRICTRIDIAGONAL_HPP
+#include <Eigen/Core>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace mrock::iEoM::detail {
+/**
+ * @brief Eigenvalues by Sturm sequence bisection and eigenvectors by inverse iteration
+ * of a real symmetric tridiagonal matrix T, cf. LAPACK's dstebz and dstein.
+ *
+ * Shared by RitzTracker and BisectionEigenSolver. Both steps cost O(m) for an m x m matrix.
+ * The matrix is referenced, not copied: diagonal[i] = T_ii and off_diagonal[i] = T_(i,i+1) = T_(i+1,i).
+ *
+ * @tparam RealType Floating point type of the matrix elements.
+ */
+template <class RealType>
+class SymmetricTridiagonal {
+public:
+    using Vector = Eigen::Vector<RealType, Eigen::Dynamic>;
+
+private:
+    static constexpr RealType eps = std::numeric_limits<RealType>::epsilon();
+
+    const RealType* _diagonal{};
+    const RealType* _off_diagonal{};
+    Eigen::Index _size{};
+    RealType _norm{};
+    RealType _lower_bound{};
+    RealType _upper_bound{};
+    RealType _pivot_min{};
+
+    // LU factors of T - shift with partial pivoting: U has the diagonal u and the superdiagonals u1 and u2,
+    // L the subdiagonal l; swapped[i] marks a row interchange in step i
+    Vector _u, _u1, _u2, _l;
+    std::vector<char> _swapped;
+
+    void factorize(RealType shift) {
+        const Eigen::Index n = _size;
+        const RealType pivot_floor = eps * _norm;
+        _u.resize(n);
+        _u1.setZero(n);
+        _u2.setZero(n);
+        _l.setZero(n);
+        _swapped.assign(static_cast<std::size_t>(n), false);
+        for (Eigen::Index i = 0; i < n; ++i) {
+            _u(i) = _diagonal[i] - shift;
+            if (i + 1 < n) {
+                _u1(i) = _off_diagonal[i];
+                _l(i) = _off_diagonal[i];
+            }
+        }
+        for (Eigen::Index i = 0; i + 1 < n; ++i) {
+            _swapped[i] = std::abs(_u(i)) < std::abs(_l(i));
+            if (!_swapped[i]) {
+                if (_u(i) == RealType{})
+                    _u(i) = pivot_floor;
+                _l(i) /= _u(i);
+                _u(i + 1) -= _l(i) * _u1(i);
+            } else {
+                const RealType factor = _u(i) / _l(i);
+                _u(i) = _l(i);
+                _l(i) = factor;
+                const RealType upper = _u1(i);
+                _u1(i) = _u(i + 1);
+                _u(i + 1) = upper - factor * _u1(i);
+                if (i + 2 < n) {
+                    _u2(i) = _u1(i + 1);
+                    _u1(i + 1) *= -factor;
+                }
+            }
+        }
+        for (Eigen::Index i = 0; i < n; ++i) {
+            if (std::abs(_u(i)) < pivot_floor)
+                _u(i) = _u(i) < RealType{} ? -pivot_floor : pivot_floor;
+        }
+    }
+
+    /**
+     * @brief Solve (T - shift) x = rhs in place with the factors of factorize().
+     */
+    void solve(Vector& rhs) const {
+        const Eigen::Index n = _size;
+        for (Eigen::Index i = 0; i + 1 < n; ++i) {
+            if (_swapped[i]) {
+                std::swap(rhs(i), rhs(i + 1));
+            }
+            rhs(i + 1) -= _l(i) * rhs(i);
+        }
+        for (Eigen::Index i = n - 1; i >= 0; --i) {
+            RealType value = rhs(i);
+            if (i + 1 < n)
+                value -= _u1(i) * rhs(i + 1);
+            if (i + 2 < n)
+                value -= _u2(i) * rhs(i + 2);
+            rhs(i) = value / _u(i);
+        }
+    }
+
+public:
+    /**
+     * @brief Reference a new matrix and compute the Gershgorin bounds of its spectrum.
+     *
+     * @p diagonal and @p off_diagonal must stay alive and unchanged while the matrix is used.
+     *
+     * @param diagonal Diagonal elements; @p size entries.
+     * @param off_diagonal Off-diagonal elements; @p size - 1 entries.
+     * @param size Dimension m of the matrix.
+     */
+    void reset(const RealType* diagonal, const RealType* off_diagonal, Eigen::Index size) {
+        _diagonal = diagonal;
+        _off_diagonal = off_diagonal;
+        _size = size;
+
+        _norm = RealType{};
+        _lower_bound = std::numeric_limits<RealType>::max();
+        _upper_bound = std::numeric_limits<RealType>::lowest();
+        for (Eigen::Index i = 0; i < _size; ++i) {
+            const RealType radius = (i > 0 ? std::abs(_off_diagonal[i - 1]) : RealType{}) +
+                                    (i + 1 < _size ? std::abs(_off_diagonal[i]) : RealType{});
+            _lower_bound = std::min(_lower_bound, _diagonal[i] - radius);
+            _upper_bound = std::max(_upper_bound, _diagonal[i] + radius);
+            _norm = std::max(_norm, std::abs(_diagonal[i]) + radius);
+        }
+        _norm = std::max(_norm, std::numeric_limits<RealType>::min());
+        _pivot_min = _norm * eps * eps;
+        _lower_bound -= 2 * eps * _norm + _pivot_min;
+        _upper_bound += 2 * eps * _norm + _pivot_min;
+    }
+
+    /**
+     * @brief Dimension of the matrix.
+     */
+    inline Eigen::Index size() const noexcept { return _size; }
+    /**
+     * @brief Gershgorin estimate of the norm of the matrix.
+     */
+    inline RealType norm() const noexcept { return _norm; }
+    /**
+     * @brief Lower bound of the spectrum.
+     */
+    inline RealType lower_bound() const noexcept { return _lower_bound; }
+    /**
+     * @brief Upper bound of the spectrum.
+     */
+    inline RealType upper_bound() const noexcept { return _upper_bound; }
+    /**
+     * @brief Smallest magnitude of a pivot in count_below(); also the absolute accuracy of bisect().
+     */
+    inline RealType pivot_min() const noexcept { return _pivot_min; }
+    /**
+     * @brief Eigenvalues closer than this form a cluster, whose eigenvectors have to be orthogonalized
+     * against each other, see inverse_iteration().
+     */
+    inline RealType cluster_gap() const noexcept { return RealType(1e-3) * _norm; }
+
+    /**
+     * @brief Number of eigenvalues smaller than @p x, i.e., the number of negative pivots of
+     * the LDL^T decomposition of T - x.
+     */
+    Eigen::Index count_below(RealType x) const noexcept {
+        Eigen::Index count{};
+        RealType pivot = _diagonal[0] - x;
+        for (Eigen::Index i = 0;; ++i) {
+            if (std::abs(pivot) < _pivot_min)
+                pivot = -_pivot_min;
+            if (pivot < RealType{})
+                ++count;
+            if (i + 1 >= _size)
+                return count;
+            pivot = (_diagonal[i + 1] - x) - _off_diagonal[i] * _off_diagonal[i] / pivot;
+        }
+    }
+
+    /**
+     * @brief The j-th lowest eigenvalue (j < size()), given that it lies in [lower, upper].
+     */
+    RealType bisect(Eigen::Index j, RealType lower, RealType upper) const {
+        while (upper - lower > 2 * eps * std::max(std::abs(lower), std::abs(upper)) + _pivot_min) {
+            const RealType middle = lower + RealType{0.5} * (upper - lower);
+            if (middle <= lower || middle >= upper)
+                break;
+            if (count_below(middle) > j) {
+                upper = middle;
+            } else {
+                lower = middle;
+            }
+        }
+        return lower + RealType{0.5} * (upper - lower);
+    }
+    /**
+     * @brief The j-th lowest eigenvalue (j < size()).
+     */
+    inline RealType bisect(Eigen::Index j) const { return bisect(j, _lower_bound, _upper_bound); }
+
+    /**
+     * @brief Eigenvector of @p eigenvalue by inverse iteration with the LU decomposition of T - eigenvalue.
+     *
+     * @param vector Start vector on input, normalized eigenvector on output; the sign is arbitrary.
+     * @param orthogonalize Called with the iterate in every step; has to orthogonalize it against the eigenvectors
+     *                      of the previous eigenvalues of the same cluster, see cluster_gap().
+     */
+    template <class Orthogonalize>
+    void inverse_iteration(RealType eigenvalue, int n_iterations, Vector& vector, const Orthogonalize& orthogonalize) {
+        factorize(eigenvalue);
+        for (int iteration = 0; iteration < n_iterations; ++iteration) {
+            solve(vector);
+            orthogonalize(vector);
+            vector.normalize();
+        }
+    }
+};
+}  // namespace mrock::iEoM::detail
+#endif  // MROCK_IEOM_INCLUDE_MROCK_IEOM_DETAIL_SYMMETRICTRIDIAGONAL_HPP
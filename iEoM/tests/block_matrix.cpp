@@ -1,9 +1,13 @@
+#include <mrock/iEoM/LinearOperator.hpp>
 #include <mrock/iEoM/detail/BlockDiagonalMatrix.hpp>
 #include <mrock/iEoM/detail/PivotToBlockStructure.hpp>
+#include <mrock/iEoM/detail/PositiveDefinite.hpp>
 
 #include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
@@ -114,5 +118,158 @@ int main() {
         return 6;
     }
 
+    // The in-place solvers overwrite the matrix by its eigenvectors; the shuffled matrix needs pivoting
+    {
+        Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic> shuffle(toSolve.rows());
+        shuffle.setIdentity();
+        std::reverse(shuffle.indices().data(), shuffle.indices().data() + shuffle.indices().size());
+        for (Eigen::Index i = 0; i + 3 < shuffle.indices().size(); i += 3) {
+            std::swap(shuffle.indices()(i), shuffle.indices()(i + 2));
+        }
+        const Eigen::MatrixXd shuffled = shuffle.transpose() * toSolve * shuffle;
+
+        Eigen::MatrixXd in_place = toSolve;
+        const auto in_place_solution = matrix_wrapper<Eigen::MatrixXd>::solve_in_place(in_place);
+        Eigen::MatrixXd pivoted = shuffled;
+        const auto pivoted_solution = matrix_wrapper<Eigen::MatrixXd>::pivot_and_solve_in_place(pivoted);
+        if (in_place.size() != 0 || pivoted.size() != 0 ||
+            rel_error(toSolve, in_place_solution.reconstruct_matrix()) > 1e-12 ||
+            rel_error(shuffled, pivoted_solution.reconstruct_matrix()) > 1e-12 ||
+            (in_place_solution.eigenvalues - eigen_solver.eigenvalues()).norm() > 1e-12) {
+            std::cerr << "In-place diagonalization failed" << std::endl;
+            return 7;
+        }
+    }
+
+    // The Cholesky tests leave the matrix unchanged unless they succeed in factorizing it
+    {
+        const double min_eigenvalue = eigen_solver.eigenvalues()(0);
+        const Eigen::MatrixXd positive =
+            toSolve - (min_eigenvalue - 1.) * Eigen::MatrixXd::Identity(toSolve.rows(), toSolve.cols());
+        Eigen::MatrixXd tester = positive;
+        const bool above = eigenvalues_exceed(tester, 0.5);
+        const bool not_above = eigenvalues_exceed(tester, 1.5);
+        const bool unchanged = tester == positive;
+        const bool not_factorized = !cholesky_in_place_if_above(tester, 1.5) && tester == positive;
+        // The bound from the factor is conservative, so the eigenvalues have to exceed the threshold clearly
+        const bool factorized = cholesky_in_place_if_above(tester, 1e-2);
+        Eigen::MatrixXd indefinite = toSolve;
+        if (!above || not_above || !unchanged || !not_factorized || !factorized ||
+            !tester.triangularView<Eigen::StrictlyUpper>().toDenseMatrix().isZero() ||
+            rel_error(positive, tester * tester.transpose()) > 1e-12 ||
+            matrix_wrapper<Eigen::MatrixXd>::is_non_negative(indefinite, 1e-12)) {
+            std::cerr << "Cholesky definiteness test failed" << std::endl;
+            return 8;
+        }
+    }
+
+    // The blocks of a shuffled matrix are recovered as the connected components shared by all matrices
+    {
+        Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic> shuffle(toSolve.rows());
+        shuffle.setIdentity();
+        for (Eigen::Index i = 0; i + 7 < shuffle.indices().size(); i += 7) {
+            std::swap(shuffle.indices()(i), shuffle.indices()(shuffle.indices().size() - 1 - i));
+        }
+        const Eigen::MatrixXd shuffled = shuffle.transpose() * toSolve * shuffle;
+        const BlockStructure structure = find_block_structure(1e-12, shuffled);
+        Eigen::MatrixXd pivoted = shuffled;
+        permute_in_place(pivoted, structure.permutation);
+
+        Eigen::MatrixXd coupling = Eigen::MatrixXd::Identity(toSolve.rows(), toSolve.cols());
+        // Couples the first two blocks of toSolve
+        const Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic> unshuffle = shuffle.inverse();
+        const Eigen::Index first = unshuffle.indices()(0);
+        const Eigen::Index second = unshuffle.indices()(N);
+        coupling(first, second) = coupling(second, first) = 1.;
+        const BlockStructure shared_structure = find_block_structure(1e-12, shuffled, coupling);
+
+        const auto expected_blocks = identify_hermitian_blocks(pivoted);
+        bool correct_blocks = structure.blocks.size() == static_cast<std::size_t>(n_blocks) &&
+                              expected_blocks.size() == structure.blocks.size() &&
+                              shared_structure.blocks.size() == static_cast<std::size_t>(n_blocks - 1);
+        for (std::size_t b = 0U; correct_blocks && b < structure.blocks.size(); ++b) {
+            correct_blocks = structure.blocks[b].size == N && expected_blocks[b].size == N &&
+                             expected_blocks[b].position == structure.blocks[b].position;
+        }
+        const Eigen::MatrixXd pivoted_product =
+            structure.permutation.transpose() * shuffled * structure.permutation;
+        if (!correct_blocks || pivoted != pivoted_product) {
+            std::cerr << "Block structure detection failed" << std::endl;
+            return 9;
+        }
+    }
+
+    // Packed blocks: copies own their arena, and noalias() and *= evaluate into the existing blocks
+    {
+        BlockMatrix copy = blocked_toSolve;
+        copy += second_blocked;
+        BlockMatrix product(blocked_toSolve.layout());
+        product.noalias() = blocked_toSolve * second_blocked;
+        BlockMatrix adjoint(blocked_toSolve.layout());
+        adjoint.noalias() = second_blocked.adjoint();
+        // In-place products, also with the matrix itself as the right-hand side
+        BlockMatrix in_place_product = blocked_toSolve;
+        in_place_product *= second_blocked;
+        BlockMatrix square = blocked_toSolve;
+        square *= square;
+        if (blocked_toSolve.rows() != toSolve.rows() || rel_error(toSolve, blocked_toSolve.construct_matrix()) > 0 ||
+            rel_error(toSolve + second_matrix, copy.construct_matrix()) > 1e-12 ||
+            rel_error(toSolve * second_matrix, product.construct_matrix()) > 1e-12 ||
+            rel_error(toSolve * second_matrix, in_place_product.construct_matrix()) > 1e-12 ||
+            rel_error(toSolve * toSolve, square.construct_matrix()) > 1e-12 ||
+            rel_error(second_matrix.adjoint(), adjoint.construct_matrix()) > 0) {
+            std::cerr << "Packed block storage failed" << std::endl;
+            return 10;
+        }
+    }
+
+    // Fused block-wise congruences F diag(d) F^H and F M F^H, also in place
+    {
+        const Eigen::VectorXd d = Eigen::VectorXd::Random(toSolve.rows());
+        const BlockMatrix diagonal_congruence = congruence(blocked_toSolve * second_blocked, d);
+        const Eigen::MatrixXd factor = toSolve * second_matrix;
+        BlockMatrix in_place = second_blocked;
+        in_place = congruence(blocked_toSolve, in_place);
+        if (rel_error(factor * d.asDiagonal() * factor.adjoint(), diagonal_congruence.construct_matrix()) > 1e-12 ||
+            rel_error(toSolve * second_matrix * toSolve.adjoint(), in_place.construct_matrix()) > 1e-12) {
+            std::cerr << "Block-wise congruence failed" << std::endl;
+            return 11;
+        }
+    }
+
+    // Block-wise matrix-vector products, also as the operator of the Lanczos routines
+    {
+        static_assert(mrock::iEoM::LinearOperator<BlockMatrix, Eigen::VectorXcd>);
+        const Eigen::VectorXcd in = Eigen::VectorXcd::Random(toSolve.cols());
+        Eigen::VectorXcd out(toSolve.rows());
+        mrock::iEoM::detail::apply_operator<Eigen::VectorXcd>(blocked_toSolve, in, out);
+        const Eigen::MatrixXd panel = Eigen::MatrixXd::Random(toSolve.cols(), 3);
+        const Eigen::VectorXcd expected = toSolve * in;
+        if ((expected - out).norm() > 1e-12 * expected.norm() ||
+            rel_error(toSolve * panel, blocked_toSolve * panel) > 1e-12) {
+            std::cerr << "Block-wise matrix-vector product failed" << std::endl;
+            return 12;
+        }
+    }
+
+    // The in-place eigensolvers report non-convergence instead of returning invalid eigenpairs
+    {
+        using Wrapper = matrix_wrapper<Eigen::MatrixXd>;
+        for (const bool pivot : {false, true}) {
+            Eigen::MatrixXd invalid = generateRandomHermitian(6);
+            invalid(3, 2) = invalid(2, 3) = std::numeric_limits<double>::quiet_NaN();
+            bool thrown = false;
+            try {
+                pivot ? Wrapper::pivot_and_solve_in_place(invalid) : Wrapper::solve_in_place(invalid);
+            } catch (const std::runtime_error&) {
+                thrown = true;
+            }
+            if (!thrown) {
+                std::cerr << "In-place eigensolver did not report non-convergence" << std::endl;
+                return 13;
+            }
+        }
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,125 @@
+#define MROCK_IEOM_NO_NLOHMANN_JSON
+
+#include <mrock/iEoM/GeneralResolvent.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+using namespace mrock::iEoM;
+
+using Matrix = Eigen::MatrixXd;
+using Vector = Eigen::VectorXd;
+using Complex = std::complex<double>;
+
+// Blocks of different sizes, shuffled so that the block structure has to be found by pivoting
+struct ShuffledBlocks : public GeneralResolvent<double> {
+    static constexpr int dimension = 40;
+
+    ShuffledBlocks() : GeneralResolvent<double>(1e-6) {}
+
+    void create_starting_states() override {
+        // Touches only a part of the blocks
+        Vector state = Vector::Zero(dimension);
+        state.head(16).setLinSpaced(1., 2.);
+        starting_states = {state};
+        resolvent_names = {"test"};
+    }
+
+    void fill_matrices() override {
+        std::srand(3);
+        M = Matrix::Zero(dimension, dimension);
+        N = Matrix::Zero(dimension, dimension);
+        const std::vector<int> block_sizes{3, 5, 8, 12, 4, 8};
+        int position{};
+        for (const int size : block_sizes) {
+            const Matrix A = Matrix::Random(size, size);
+            const Matrix B = Matrix::Random(size, size);
+            M.block(position, position, size, size) = A * A.transpose() + Matrix::Identity(size, size);
+            N.block(position, position, size, size) = B * B.transpose() + Matrix::Identity(size, size);
+            position += size;
+        }
+        Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic> shuffle(dimension);
+        shuffle.setIdentity();
+        for (int i = 0; i < dimension; i += 3) {
+            std::swap(shuffle.indices()(i), shuffle.indices()(dimension - 1 - i));
+        }
+        M = shuffle.transpose() * M * shuffle;
+        N = shuffle.transpose() * N * shuffle;
+    }
+
+    void fill_M() override {}
+};
+
+Complex continued_fraction(const ResolventData<double>& data, Complex z) {
+    Complex g{};
+    for (std::size_t i = data.a_i.size(); i-- > 0U;) {
+        g = data.b_i[i] / (z - data.a_i[i] - g);
+    }
+    return g;
+}
+
+Complex blockwise_green_function(const BlockwiseResolventData<double>& data, Complex z) {
+    Complex g{};
+    for (const auto& lanczos : data.lanczos) {
+        g += continued_fraction(lanczos, z);
+    }
+    for (std::size_t j = 0U; j < data.poles.size(); ++j) {
+        g += data.weights[j] / (z - data.poles[j]);
+    }
+    return g;
+}
+
+int main() {
+    const Complex z(0.7, 0.3);
+
+    // A Lanczos run over the full dimension is exact
+    ShuffledBlocks full;
+    const auto full_data = full.compute_collective_modes(ShuffledBlocks::dimension);
+
+    // Every block by Lanczos, small blocks exactly, and every block exactly
+    const Eigen::Index dimension = ShuffledBlocks::dimension;
+    for (const Eigen::Index exact_block_size : {Eigen::Index{}, Eigen::Index{5}, dimension}) {
+        ShuffledBlocks per_block;
+        const auto block_data = per_block.compute_collective_modes_per_block(dimension, exact_block_size);
+        if (block_data.size() != full_data.size()) {
+            std::cerr << "Per-block resolvents returned " << block_data.size() << " instead of " << full_data.size()
+                      << " resolvents" << std::endl;
+            return 1;
+        }
+        for (std::size_t s = 0U; s < full_data.size(); ++s) {
+            const Complex expected = continued_fraction(full_data[s].lanczos.front(), z);
+            const Complex blockwise = blockwise_green_function(block_data[s], z);
+            const double total_weight = std::accumulate(block_data[s].weights.begin(), block_data[s].weights.end(), 0.);
+            const double expected_weight = full_data[s].lanczos.front().b_i.front();
+            if (block_data[s].name != full_data[s].name || std::abs(expected - blockwise) > 1e-8 * std::abs(expected)) {
+                std::cerr << "Per-block Green's function of " << full_data[s].name << " deviates: " << blockwise
+                          << " instead of " << expected << std::endl;
+                return 2;
+            }
+            // With all blocks exact, the weights sum to the norm of the state, and untouched blocks have no poles
+            if (exact_block_size == dimension &&
+                (!block_data[s].lanczos.empty() || block_data[s].poles.size() >= dimension ||
+                 std::abs(total_weight - expected_weight) > 1e-8 * expected_weight)) {
+                std::cerr << "Exact per-block solution of " << full_data[s].name << " is incomplete" << std::endl;
+                return 3;
+            }
+            // Every result is labeled by its block, in ascending block order
+            const auto& data = block_data[s];
+            if (data.lanczos_blocks.size() != data.lanczos.size() || data.pole_blocks.size() != data.poles.size() ||
+                !std::is_sorted(data.lanczos_blocks.begin(), data.lanczos_blocks.end()) ||
+                !std::is_sorted(data.pole_blocks.begin(), data.pole_blocks.end()) ||
+                std::adjacent_find(data.lanczos_blocks.begin(), data.lanczos_blocks.end()) !=
+                    data.lanczos_blocks.end()) {
+                std::cerr << "Per-block results of " << full_data[s].name << " are not labeled by their blocks"
+                          << std::endl;
+                return 4;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -9,11 +9,15 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdint>
+#include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <list>
+#include <memory>
 #include <numbers>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -160,10 +164,72 @@ struct PhaseTester : public BCSTester {
     PhaseTester(double _delta) : BCSTester(_delta) {}
 };
 
+// Random positive definite K_plus (12 x 12) and K_minus (7 x 7) with a random L (12 x 7):
+// The transform of the phase channel has full column rank, the one of the amplitude channel does not.
+// The phase solver matrix has 5 zero modes, so 8 eigenvectors include 3 proper ones.
+struct RandomTester : public XPResolvent<double, 8> {
+    // Exposed for the reference computation
+    using XPResolvent<double, 8>::K_plus;
+    using XPResolvent<double, 8>::K_minus;
+    using XPResolvent<double, 8>::L;
+
+    static Matrix positive_definite(int n) {
+        const Matrix A = Matrix::Random(n, n);
+        return A * A.transpose() + n * Matrix::Identity(n, n);
+    }
+
+    void fill_M() override {
+        K_plus = positive_definite(12);
+        K_minus = positive_definite(7);
+    }
+    void fill_matrices() override {
+        std::srand(42);
+        fill_M();
+        L = Matrix::Random(12, 7);
+    }
+    void create_starting_states() override {
+        starting_states.clear();
+        starting_states.push_back(XPStartingState<double>{Vector::Ones(7), Vector::Ones(12), "random"});
+    }
+    RandomTester() : XPResolvent<double, 8>(1e-8, false) {}
+};
+
+// Reference for the first eigenvectors of a channel: the minimum-norm least-squares solutions of
+// T x = u_j with a complete orthogonal decomposition of T = N_new^(-1/2) L
+bool check_first_eigenvectors(const RandomTester::FullDiagData& data,
+                              const Eigen::MatrixXd& K_plus,
+                              const Eigen::MatrixXd& K_minus,
+                              const Eigen::MatrixXd& L) {
+    using Matrix = Eigen::MatrixXd;
+    const Matrix N = L * K_minus.inverse() * L.transpose();
+    Eigen::SelfAdjointEigenSolver<Matrix> n_solver(N);
+    const Eigen::VectorXd inverse_sqrt = n_solver.eigenvalues().unaryExpr(
+        [](double ev) { return ev < 1e-8 ? 0. : 1. / std::sqrt(ev); });
+    const Matrix inverse_sqrt_N =
+        n_solver.eigenvectors() * inverse_sqrt.asDiagonal() * n_solver.eigenvectors().transpose();
+    Eigen::SelfAdjointEigenSolver<Matrix> solver(inverse_sqrt_N * K_plus * inverse_sqrt_N);
+    const Eigen::CompleteOrthogonalDecomposition<Matrix> qr(inverse_sqrt_N * L);
+
+    for (std::size_t k = 0U; k < data.eigenvalues.size() && k < data.first_eigenvectors.size(); ++k) {
+        Eigen::Index closest{};
+        (solver.eigenvalues().cwiseAbs().cwiseSqrt().array() - data.eigenvalues[k]).abs().minCoeff(&closest);
+        const Eigen::VectorXd expected = qr.solve(solver.eigenvectors().col(closest));
+        const Eigen::Map<const Eigen::VectorXd> result(data.first_eigenvectors[k].data(),
+                                                       data.first_eigenvectors[k].size());
+        // Eigenvectors are only determined up to their sign
+        if (std::min((result - expected).norm(), (result + expected).norm()) > 1e-8 * (1. + expected.norm())) {
+            std::cerr << "First eigenvector " << k << " deviates from the reference by " << (result - expected).norm()
+                      << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
 // Helper to write the Lanczos coefficients to an output stream. The
 // format writes  N_lanczos rows with the (a_i, b_i) pairs for each computed resolvent.
 std::array<std::string, N_lanczos> save_data(const std::vector<BCSTester::ResolventReturnData>& data,
-                                             std::ofstream& out) {
+                                             std::ostream& out) {
     out << std::scientific << std::setprecision(10);
     std::array<std::string, N_lanczos> lines;
 
@@ -183,7 +249,7 @@ std::array<std::string, N_lanczos> save_data(const std::vector<BCSTester::Resolv
     return lines;
 };
 
-std::array<std::string, 3> save_data(const PhaseTester::FullDiagData& data, std::ofstream& out) {
+std::array<std::string, 3> save_data(const PhaseTester::FullDiagData& data, std::ostream& out) {
     std::array<std::string, 3> lines;
     // A global constant does not matter for the property of the eigenoperator, since X=const*E
     // still fulfills [H, [H, X]] = omega^2 X
@@ -260,6 +326,136 @@ int main() {
     }
     std::cout << "Test data has been saved to bcs_result.txt" << std::endl;
 
+    // The block Lanczos engine must reproduce the same continued fractions
+    std::vector<BCSTester::ResolventReturnData> block_result = tester.compute_collective_modes_block<11>(N_lanczos);
+    std::ofstream block_filestream("bcs_block_result.txt", std::ios_base::out);
+    if (block_filestream.is_open()) {
+        const auto lines = save_data(block_result, block_filestream);
+        block_filestream.close();
+
+        if (lines != comparison_result) {
+            std::cerr << "Block Lanczos result does not match the comparison!" << std::endl;
+            return 1;
+        }
+    } else {
+        std::cerr << "ieom_bcs.cpp could not open output filestream" << std::endl;
+        return 1;
+    }
+
+    // A repeated parameter point must be served from the solver matrix cache, in memory and from disk
+    const std::filesystem::path cache_directory = "bcs_solver_matrix_cache";
+    std::filesystem::remove_all(cache_directory);
+    tester.solver_matrix_cache = std::make_shared<SolverMatrixCache<double>>(2U, 0U, cache_directory);
+    tester.compute_collective_modes<11>(N_lanczos);
+    for (int repetition = 0; repetition < 2; ++repetition) {
+        std::ostringstream cached_stream;
+        if (save_data(tester.compute_collective_modes<11>(N_lanczos), cached_stream) != comparison_result ||
+            tester.solver_matrix_cache->hits() != 1U ||
+            tester.solver_matrix_cache->misses() != (repetition == 0 ? 1U : 0U)) {
+            std::cerr << "Cached result does not match the comparison!" << std::endl;
+            return 1;
+        }
+        // Start over with an empty cache that has to load the entry from disk
+        tester.solver_matrix_cache = std::make_shared<SolverMatrixCache<double>>(2U, 0U, cache_directory);
+    }
+    const auto residual_result = tester.compute_collective_modes_with_residuals(N_lanczos);
+    std::filesystem::remove_all(cache_directory);
+    tester.solver_matrix_cache.reset();
+    const auto uncached_residual_result = tester.compute_collective_modes_with_residuals(N_lanczos);
+    if (std::abs(residual_result.second.front().eigenvalues[0] -
+                 uncached_residual_result.second.front().eigenvalues[0]) > 1e-10) {
+        std::cerr << "Cached residuals do not match the uncached ones!" << std::endl;
+        return 1;
+    }
+    std::cout << "The solver matrix cache reproduces the uncached results." << std::endl;
+
+    // The residual path honors the adaptive termination, too; the phase coefficients converge quickly
+    {
+        const auto terminated_result = tester.compute_collective_modes_with_residuals(
+            10 * N_lanczos, false, TerminationCriterion<double>::coefficients(1e-6));
+        const auto& phase_data = terminated_result.first.front().lanczos.front();
+        if (phase_data.termination_reason != TerminationReason::COEFFICIENTS_CONVERGED) {
+            std::cerr << "The residual path ignores the termination criterion: "
+                      << to_string(phase_data.termination_reason) << " after " << phase_data.a_i.size()
+                      << " iterations" << std::endl;
+            return 1;
+        }
+    }
+
+    // A hash collision or a different definiteness setting must be a miss, in memory and on disk
+    {
+        using CacheMatrix = SolverMatrixCache<double>::Matrix;
+        const CacheMatrix K = CacheMatrix::Identity(3, 3);
+        const CacheMatrix L = CacheMatrix::Ones(3, 2);
+        const SolverMatrixCacheKey key = SolverMatrixCache<double>::key(K, K, L, 1e-6, false, true);
+        SolverMatrixCacheKey colliding = key;
+        colliding.fingerprint ^= 1U;
+        std::filesystem::remove_all(cache_directory);
+        SolverMatrixCache<double> cache(2U, 0U, cache_directory);
+        cache.insert(key, std::make_shared<SolverMatrixCacheEntry<double>>());
+        SolverMatrixCache<double> disk_cache(2U, 0U, cache_directory);
+        if (!cache.find(key) || !disk_cache.find(key) || cache.find(colliding) ||
+            SolverMatrixCache<double>(2U, 0U, cache_directory).find(colliding) ||
+            SolverMatrixCache<double>::key(K, K, L, 1e-6, false, false) == key) {
+            std::cerr << "The solver matrix cache does not compare the whole key!" << std::endl;
+            return 1;
+        }
+
+        // Corrupted dimensions of the first matrix, which follow the header, the key and the flags,
+        // must be rejected before anything is allocated
+        for (const auto& file : std::filesystem::directory_iterator(cache_directory)) {
+            std::fstream stream(file.path(), std::ios::binary | std::ios::in | std::ios::out);
+            const std::int64_t corrupted[2] = {std::int64_t{1} << 40, std::int64_t{1} << 40};
+            stream.seekp(12 * sizeof(std::uint64_t));
+            stream.write(reinterpret_cast<const char*>(corrupted), sizeof(corrupted));
+        }
+        if (SolverMatrixCache<double>(2U, 0U, cache_directory).find(key)) {
+            std::cerr << "The solver matrix cache accepts a corrupted file!" << std::endl;
+            return 1;
+        }
+        std::filesystem::remove_all(cache_directory);
+    }
+
+    // A tight memory limit serializes the channels and the Lanczos runs but must not change the results
+    tester.memory_limit = 1U;
+    std::ostringstream limited_stream;
+    if (save_data(tester.compute_collective_modes<11>(N_lanczos), limited_stream) != comparison_result) {
+        std::cerr << "Memory-limited result does not match the comparison!" << std::endl;
+        return 1;
+    }
+    tester.memory_limit = 0U;
+
+    // The lean mode must reproduce the results with a lower peak memory
+    const std::size_t default_peak = tester.memory_report().high_water_bytes();
+    tester.lean = true;
+    std::ostringstream lean_stream;
+    if (save_data(tester.compute_collective_modes<11>(N_lanczos), lean_stream) != comparison_result) {
+        std::cerr << "Lean result does not match the comparison!" << std::endl;
+        return 1;
+    }
+    const MemoryReport lean_report = tester.memory_report();
+    std::cout << "Memory report of the lean mode:\n" << lean_report << std::endl;
+    if (lean_report.high_water_bytes() >= default_peak) {
+        std::cerr << "The lean mode does not lower the peak memory: " << lean_report.high_water_bytes()
+                  << " >= " << default_peak << std::endl;
+        return 1;
+    }
+    tester.lean = false;
+
+#ifndef MROCK_IEOM_DO_NOT_PARALLELIZE
+    // The pipeline nests parallel regions but must leave the caller's OpenMP setting untouched
+    const int max_active_levels = omp_get_max_active_levels();
+    omp_set_max_active_levels(1);
+    tester.compute_collective_modes<11>(N_lanczos);
+    const int levels_after_pipeline = omp_get_max_active_levels();
+    omp_set_max_active_levels(max_active_levels);
+    if (levels_after_pipeline != 1) {
+        std::cerr << "The pipeline changed the maximal number of active OpenMP levels to " << levels_after_pipeline
+                  << std::endl;
+        return 1;
+    }
+#endif
+
     // increase the gap by a factor of 0.1 => Now the system is no longer in thermal equilibrium
     tester.Delta *= 0.1;
     if (!tester.dynamic_matrix_is_negative()) {
@@ -290,5 +486,63 @@ int main() {
     }
     std::cout << "Test Goldstone mode data has been saved to bcs_goldstone_result.txt" << std::endl;
 
+    // The thick-restart Lanczos eigensolver must reproduce the lowest modes of the full diagonalization
+    const int n_lowest = 12;
+    const auto [partial_phase_data, partial_amplitude_data] = phase_tester.partial_diagonalization(n_lowest);
+    if (partial_phase_data.eigenvalues.size() < 2U || partial_phase_data.eigenvalues.size() > n_lowest) {
+        std::cerr << "Partial diagonalization returned " << partial_phase_data.eigenvalues.size() << " eigenvalues"
+                  << std::endl;
+        return 1;
+    }
+    // The last eigenvalue may be part of a degenerate group that is only partially resolved
+    const double highest_compared = partial_phase_data.eigenvalues[partial_phase_data.eigenvalues.size() - 2U];
+    for (std::size_t i = 0U; i + 1U < partial_phase_data.eigenvalues.size(); ++i) {
+        // omega = sqrt(omega^2), so the accuracy of the Goldstone mode is ~sqrt(eps)
+        if (std::abs(partial_phase_data.eigenvalues[i] - phase_data.eigenvalues[i]) > 1e-6 ||
+            std::abs(partial_phase_data.weights[0][i] - phase_data.weights[0][i]) > 1e-8) {
+            std::cerr << "Partial diagonalization deviates for mode " << i << " at " << phase_data.eigenvalues[i]
+                      << ": " << partial_phase_data.weights[0][i] << " != " << phase_data.weights[0][i] << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Partial diagonalization reproduces the modes up to " << highest_compared << std::endl;
+
+    // The window diagonalization must reproduce the lowest modes of the full diagonalization
+    // The first eigenvectors are not compared, since the Goldstone mode lies in a degenerate nullspace
+    const double omega_cut = 0.5 * (phase_data.eigenvalues[n_lowest - 1] + phase_data.eigenvalues[n_lowest]);
+    const auto [window_phase_data, window_amplitude_data] = phase_tester.window_diagonalization(0., omega_cut);
+    if (window_phase_data.eigenvalues.size() != static_cast<std::size_t>(n_lowest)) {
+        std::cerr << "The window below " << omega_cut << " contains " << window_phase_data.eigenvalues.size()
+                  << " instead of " << n_lowest << " modes" << std::endl;
+        return 1;
+    }
+    for (std::size_t i = 0U; i < window_phase_data.eigenvalues.size(); ++i) {
+        if (std::abs(window_phase_data.eigenvalues[i] - phase_data.eigenvalues[i]) > 1e-6 ||
+            std::abs(window_phase_data.weights[0][i] - phase_data.weights[0][i]) > 1e-8) {
+            std::cerr << "Window diagonalization deviates for mode " << i << " at " << phase_data.eigenvalues[i]
+                      << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Window diagonalization reproduces the modes below " << omega_cut << std::endl;
+
+    // The first eigenvectors are transformed with the factors of N_new for full column rank (phase channel)
+    // and with a QR decomposition otherwise (amplitude channel); both must match the reference
+    // The same holds for the lowest eigenpairs from bisection
+    RandomTester random_tester;
+    for (int bisection = 0; bisection < 2; ++bisection) {
+        const auto [random_phase_data, random_amplitude_data] =
+            bisection == 0 ? random_tester.full_diagonalization() : random_tester.lowest_diagonalization(8);
+        // The pipeline releases the input matrices
+        random_tester.fill_matrices();
+        if (!check_first_eigenvectors(random_phase_data, random_tester.K_plus, random_tester.K_minus,
+                                      random_tester.L) ||
+            !check_first_eigenvectors(random_amplitude_data, random_tester.K_minus, random_tester.K_plus,
+                                      random_tester.L.transpose())) {
+            return 1;
+        }
+    }
+    std::cout << "The transformed eigenvectors match the least-squares reference." << std::endl;
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,138 @@
+#define MROCK_IEOM_NO_NLOHMANN_JSON
+
+#include <mrock/iEoM/KernelPolynomial.hpp>
+#include <mrock/iEoM/LinearOperator.hpp>
+
+#include <Eigen/SparseCore>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace mrock::iEoM;
+
+using Matrix = Eigen::MatrixXd;
+using Vector = Eigen::VectorXd;
+using SparseMatrix = Eigen::SparseMatrix<double>;
+
+// Nearest-neighbor chain with a smoothly varying on-site energy
+Matrix generateChainMatrix(int size) {
+    Matrix mat = Matrix::Zero(size, size);
+    for (int i = 0; i < size; ++i) {
+        mat(i, i) = std::cos(0.05 * i);
+        if (i + 1 < size) {
+            mat(i, i + 1) = -1.;
+            mat(i + 1, i) = -1.;
+        }
+    }
+    return mat;
+}
+
+double max_deviation(const std::vector<double>& lhs, const std::vector<double>& rhs) {
+    double deviation{};
+    for (std::size_t i = 0U; i < std::min(lhs.size(), rhs.size()); ++i) {
+        deviation = std::max(deviation, std::abs(lhs[i] - rhs[i]));
+    }
+    return lhs.size() == rhs.size() ? deviation : 1e300;
+}
+
+int main() {
+    const int N = 300;
+    const int N_moments = 201;
+    const Matrix toSolve = generateChainMatrix(N);
+    const Eigen::SelfAdjointEigenSolver<Matrix> solver(toSolve);
+    const std::vector<Vector> states{Vector::Ones(N), Vector::LinSpaced(N, -1., 1.), Vector::Unit(N, N / 2)};
+
+    KernelPolynomialMethod<Matrix, Vector> kpm;
+    kpm.estimate_spectral_bounds(toSolve);
+    if (kpm.center() - kpm.half_width() >= solver.eigenvalues()(0) ||
+        kpm.center() + kpm.half_width() <= solver.eigenvalues()(N - 1)) {
+        std::cerr << "Estimated spectral bounds do not contain the spectrum" << std::endl;
+        return 1;
+    }
+
+    // The moments must agree with the ones from the exact eigendecomposition
+    const auto moments = kpm.compute_moments(toSolve, states, N_moments, {"ones", "linear", "site"});
+    for (std::size_t s = 0U; s < states.size(); ++s) {
+        const Vector x = (solver.eigenvalues().array() - kpm.center()) / kpm.half_width();
+        const Vector weights = (solver.eigenvectors().adjoint() * states[s]).cwiseAbs2();
+        std::vector<double> exact(N_moments);
+        for (int n = 0; n < N_moments; ++n) {
+            exact[n] = weights.dot(x.array().acos().unaryExpr([n](double t) { return std::cos(n * t); }).matrix());
+        }
+        const double error = max_deviation(moments[s].mu, exact) / weights.sum();
+        if (error > 1e-10) {
+            std::cerr << "KPM moments of " << moments[s].name << " are wrong: " << error << std::endl;
+            return 1;
+        }
+    }
+
+    // Batched, sparse and matrix-free sweeps must give the same moments
+    {
+        const SparseMatrix sparse = toSolve.sparseView();
+        const auto matrix_free = make_operator(N, [&](Eigen::Ref<const Vector> in, Eigen::Ref<Vector> out) {
+            out.noalias() = sparse * in;
+        });
+        KernelPolynomialMethod<SparseMatrix, Vector> sparse_kpm(kpm.center() - kpm.half_width(),
+                                                                kpm.center() + kpm.half_width(), 0.);
+        const auto sparse_moments = sparse_kpm.compute_moments(sparse, states, N_moments);
+        const auto free_moments = sparse_kpm.compute_moments(matrix_free, states, N_moments);
+        for (std::size_t s = 0U; s < states.size(); ++s) {
+            const auto single = kpm.compute_moments(toSolve, {states[s]}, N_moments);
+            const double error = std::max({max_deviation(single.front().mu, moments[s].mu),
+                                           max_deviation(sparse_moments[s].mu, moments[s].mu),
+                                           max_deviation(free_moments[s].mu, moments[s].mu)});
+            if (error > 1e-10) {
+                std::cerr << "KPM moments depend on the operator representation: " << error << std::endl;
+                return 2;
+            }
+        }
+    }
+
+    // The Jackson kernel yields a positive spectral function with the correct total weight
+    {
+        const double lower = kpm.center() - kpm.half_width();
+        const double upper = kpm.center() + kpm.half_width();
+        const int n_grid = 4000;
+        std::vector<double> grid(n_grid);
+        for (int i = 0; i < n_grid; ++i) {
+            grid[i] = lower + (upper - lower) * (i + 0.5) / n_grid;
+        }
+        for (const auto kernel : {KPMKernel::JACKSON, KPMKernel::LORENTZ}) {
+            const auto spectral = moments.front().spectral_function(grid, kernel);
+            double weight{};
+            for (double value : spectral) {
+                weight += value * (upper - lower) / n_grid;
+            }
+            if (std::abs(weight - moments.front().mu[0]) > 1e-2 * moments.front().mu[0]) {
+                std::cerr << "Spectral weight is wrong: " << weight << " != " << moments.front().mu[0] << std::endl;
+                return 3;
+            }
+            if (kernel == KPMKernel::JACKSON && *std::min_element(spectral.begin(), spectral.end()) < -1e-8) {
+                std::cerr << "Jackson kernel produced a negative spectral function" << std::endl;
+                return 3;
+            }
+        }
+    }
+
+    // Stochastic trace estimation must reproduce Tr H within the statistical error
+    {
+        const auto trace = kpm.compute_stochastic_trace(toSolve, 64, N_moments, 42U);
+        const double exact_trace = toSolve.trace();
+        const double estimated_trace = kpm.half_width() * trace.mu[1] + kpm.center() * trace.mu[0];
+        if (std::abs(trace.mu[0] - N) > 1e-10 || std::abs(estimated_trace - exact_trace) > 0.05 * N) {
+            std::cerr << "Stochastic trace is wrong: " << estimated_trace << " != " << exact_trace << std::endl;
+            return 4;
+        }
+        const double exact_second = (toSolve.array().square().sum() - 2 * kpm.center() * exact_trace +
+                                     N * kpm.center() * kpm.center()) /
+                                    (kpm.half_width() * kpm.half_width());
+        if (std::abs(trace.mu[2] - (2 * exact_second - N)) > 0.05 * N) {
+            std::cerr << "Stochastic second moment is wrong: " << trace.mu[2] << std::endl;
+            return 4;
+        }
+    }
+
+    return 0;
+}
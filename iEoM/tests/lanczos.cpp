@@ -0,0 +1,538 @@
+#define MROCK_IEOM_NO_NLOHMANN_JSON
+
+#include <mrock/iEoM/BisectionEigenSolver.hpp>
+#include <mrock/iEoM/BlockResolvent.hpp>
+#include <mrock/iEoM/LinearOperator.hpp>
+#include <mrock/iEoM/Resolvent.hpp>
+#include <mrock/iEoM/SparseAssembly.hpp>
+#include <mrock/iEoM/ThickRestartLanczos.hpp>
+#include <mrock/iEoM/detail/Hermiticity.hpp>
+#include <mrock/iEoM/detail/RitzTracker.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace mrock::iEoM;
+
+using Matrix = Eigen::MatrixXd;
+using Vector = Eigen::VectorXd;
+
+// Diagonal plus a weak collective (rank-one) coupling, similar to the matrices in ieom_bcs.cpp
+Matrix generateCollectiveMatrix(int size) {
+    Vector coupling = Vector::LinSpaced(size, 0.5, 1.5);
+    Matrix mat = (-1. / size) * coupling * coupling.transpose();
+    mat.diagonal() += Vector::LinSpaced(size, 1., 5.);
+    return mat;
+}
+
+double max_deviation(const std::vector<double>& lhs, const std::vector<double>& rhs) {
+    double deviation{};
+    for (std::size_t i = 0U; i < std::min(lhs.size(), rhs.size()); ++i) {
+        deviation = std::max(deviation, std::abs(lhs[i] - rhs[i]) / std::max(1., std::abs(rhs[i])));
+    }
+    return deviation;
+}
+
+template <int n_residuals>
+bool ritz_pairs_are_exact(const ResidualInformation<double, n_residuals>& residual_info,
+                          const Eigen::SelfAdjointEigenSolver<Matrix>& solver,
+                          const Matrix& toSolve,
+                          const Vector& starting_state) {
+    for (int i = 0; i < n_residuals; ++i) {
+        if (!residual_info.converged[i]) {
+            std::cerr << "Ritz value " << i << " did not converge" << std::endl;
+            return false;
+        }
+        if (std::abs(residual_info.eigenvalues[i] - solver.eigenvalues()(i)) > 1e-8) {
+            std::cerr << "Ritz value " << i << " is wrong: " << residual_info.eigenvalues[i]
+                      << " != " << solver.eigenvalues()(i) << std::endl;
+            return false;
+        }
+        Eigen::Map<const Vector> eigvec(residual_info.eigenvectors[i].data(), toSolve.rows());
+        const double residual = (toSolve * eigvec - residual_info.eigenvalues[i] * eigvec).norm();
+        if (residual > 1e-6) {
+            std::cerr << "Ritz vector " << i << " has a large residual " << residual << std::endl;
+            return false;
+        }
+        const double exact_weight = solver.eigenvectors().col(i).dot(starting_state);
+        if (std::abs(std::abs(residual_info.weights[i]) - std::abs(exact_weight)) > 1e-8) {
+            std::cerr << "Weight of Ritz vector " << i << " is wrong" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    const int N = 400;
+    const int N_lanczos = 150;
+    const Matrix toSolve = generateCollectiveMatrix(N);
+    const Vector starting_state = Vector::Ones(N).normalized();
+
+    // The first coefficients are not yet affected by the loss of orthogonality
+    // thus plain and reorthogonalized Lanczos must agree
+    {
+        Resolvent<Matrix, Vector> plain(starting_state);
+        plain.compute(toSolve, 20);
+        Resolvent<Matrix, Vector> reorthogonalized(starting_state);
+        reorthogonalized.compute_with_reorthogonalization(toSolve, 20);
+
+        const auto& plain_data = plain.get_data().lanczos.front();
+        const auto& reorth_data = reorthogonalized.get_data().lanczos.front();
+        if (plain_data.a_i.size() != reorth_data.a_i.size() || plain_data.b_i.size() != reorth_data.b_i.size()) {
+            std::cerr << "Reorthogonalized Lanczos produced a different number of coefficients" << std::endl;
+            return 1;
+        }
+        const double error =
+            std::max(max_deviation(plain_data.a_i, reorth_data.a_i), max_deviation(plain_data.b_i, reorth_data.b_i));
+        if (error > 1e-10) {
+            std::cerr << "Reorthogonalized Lanczos deviates from plain Lanczos " << error << std::endl;
+            return 1;
+        }
+
+        // Eigen expressions are accepted as operators, too
+        Resolvent<Matrix, Vector> scaled(starting_state);
+        scaled.compute(2.0 * toSolve, 20);
+        Resolvent<Matrix, Vector> corner(starting_state);
+        corner.compute(toSolve.topLeftCorner(N, N), 20);
+        const auto& scaled_data = scaled.get_data().lanczos.front();
+        const auto& corner_data = corner.get_data().lanczos.front();
+        const double scaled_error = std::abs(scaled_data.a_i.front() - 2.0 * plain_data.a_i.front());
+        if (scaled_data.a_i.size() != plain_data.a_i.size() || max_deviation(corner_data.a_i, plain_data.a_i) > 1e-10 ||
+            scaled_error > 1e-10 * std::abs(plain_data.a_i.front())) {
+            std::cerr << "Lanczos with an Eigen expression as operator failed" << std::endl;
+            return 1;
+        }
+    }
+
+    // Partial reorthogonalization must reproduce the fully reorthogonalized coefficients
+    // while reorthogonalizing less often
+    {
+        Resolvent<Matrix, Vector> full(starting_state);
+        full.compute_with_reorthogonalization(toSolve, N_lanczos, Reorthogonalization::FULL);
+        Resolvent<Matrix, Vector> partial(starting_state);
+        partial.compute_with_reorthogonalization(toSolve, N_lanczos, Reorthogonalization::PARTIAL);
+
+        const auto& full_data = full.get_data().lanczos.front();
+        const auto& partial_data = partial.get_data().lanczos.front();
+        if (full_data.a_i.size() != partial_data.a_i.size() || full_data.b_i.size() != partial_data.b_i.size()) {
+            std::cerr << "Partial reorthogonalization produced a different number of coefficients" << std::endl;
+            return 4;
+        }
+        const double error =
+            std::max(max_deviation(full_data.a_i, partial_data.a_i), max_deviation(full_data.b_i, partial_data.b_i));
+        if (error > 1e-8) {
+            std::cerr << "Partial reorthogonalization deviates from full reorthogonalization " << error << std::endl;
+            return 4;
+        }
+        if (partial_data.n_reorthogonalizations >= full_data.n_reorthogonalizations) {
+            std::cerr << "Partial reorthogonalization did not save any work: " << partial_data.n_reorthogonalizations
+                      << " vs " << full_data.n_reorthogonalizations << std::endl;
+            return 4;
+        }
+    }
+
+    // Mixed precision must reproduce the leading coefficients within single precision accuracy
+    {
+        Resolvent<Matrix, Vector> reference(starting_state);
+        reference.compute_with_reorthogonalization(toSolve, 20);
+        Resolvent<Matrix, Vector> mixed(starting_state);
+        mixed.compute_mixed_precision(Eigen::MatrixXf(toSolve.cast<float>()), 20);
+
+        const auto report =
+            compare_resolvent_data(mixed.get_data().lanczos.front(), reference.get_data().lanczos.front(), 1e-5);
+        if (!report.within_tolerance()) {
+            std::cerr << "Mixed-precision Lanczos is inaccurate: " << report << std::endl;
+            return 8;
+        }
+    }
+
+    // The lowest Ritz pairs must be eigenpairs of the original matrix
+    // both when keeping the whole basis and when reconstructing it in a second pass
+    {
+        const Eigen::SelfAdjointEigenSolver<Matrix> solver(toSolve);
+        Resolvent<Matrix, Vector> resolvent(starting_state);
+        if (!ritz_pairs_are_exact(resolvent.compute_with_residuals<2>(toSolve, N_lanczos), solver, toSolve,
+                                  starting_state)) {
+            return 2;
+        }
+        Resolvent<Matrix, Vector> two_pass_resolvent(starting_state);
+        if (!ritz_pairs_are_exact(two_pass_resolvent.compute_with_residuals_two_pass<2>(toSolve, N_lanczos), solver,
+                                  toSolve, starting_state)) {
+            return 5;
+        }
+    }
+
+    // The incremental Ritz tracker must reproduce the lowest eigenpairs of the growing tridiagonal matrix
+    {
+        std::vector<double> alphas(120), betas(121);
+        for (std::size_t i = 0U; i < alphas.size(); ++i) {
+            alphas[i] = std::cos(0.7 * i) + 0.01 * i;
+            betas[i] = 0.5 + 0.3 * std::sin(1.3 * i);
+        }
+        betas[0] = 1.;
+        detail::RitzTracker<double> ritz_tracker;
+        for (int m = 10; m <= 120; m += 7) {
+            ritz_tracker.update(alphas, betas, m);
+            Eigen::SelfAdjointEigenSolver<Matrix> solver;
+            solver.computeFromTridiagonal(Eigen::Map<const Vector>(alphas.data(), m),
+                                          Eigen::Map<const Vector>(betas.data() + 1, m - 1));
+            for (int j = 0; j < 5; ++j) {
+                const double vector_error =
+                    std::min((ritz_tracker.eigenvector(j) - solver.eigenvectors().col(j)).norm(),
+                             (ritz_tracker.eigenvector(j) + solver.eigenvectors().col(j)).norm());
+                if (std::abs(ritz_tracker.eigenvalue(j) - solver.eigenvalues()(j)) > 1e-12 || vector_error > 1e-8) {
+                    std::cerr << "Ritz tracker is wrong for m=" << m << ", j=" << j << ": "
+                              << ritz_tracker.eigenvalue(j) << " != " << solver.eigenvalues()(j) << std::endl;
+                    return 10;
+                }
+            }
+        }
+
+        // Two weakly coupled copies of the same chain give pairs of nearly degenerate Ritz values,
+        // whose eigenvectors must still be orthonormal
+        std::vector<double> doubled_alphas(alphas.begin(), alphas.begin() + 40);
+        std::vector<double> doubled_betas(betas.begin(), betas.begin() + 41);
+        doubled_alphas.insert(doubled_alphas.end(), alphas.begin(), alphas.begin() + 40);
+        doubled_betas.insert(doubled_betas.end(), betas.begin() + 1, betas.begin() + 40);
+        doubled_betas[40] = 1e-10;
+        ritz_tracker.update(doubled_alphas, doubled_betas, 80);
+        Eigen::Map<const Vector> diagonal(doubled_alphas.data(), 80);
+        Eigen::Map<const Vector> off_diagonal(doubled_betas.data() + 1, 79);
+        Matrix ritz_vectors(80, 6);
+        for (int j = 0; j < 6; ++j) {
+            ritz_vectors.col(j) = ritz_tracker.eigenvector(j);
+            Vector residual = diagonal.cwiseProduct(ritz_vectors.col(j)) -
+                              ritz_tracker.eigenvalue(j) * ritz_vectors.col(j);
+            residual.head(79) += off_diagonal.cwiseProduct(ritz_vectors.col(j).tail(79));
+            residual.tail(79) += off_diagonal.cwiseProduct(ritz_vectors.col(j).head(79));
+            if (residual.norm() > 1e-8) {
+                std::cerr << "Ritz tracker residual of the degenerate pair j=" << j << " is " << residual.norm()
+                          << std::endl;
+                return 10;
+            }
+        }
+        if ((ritz_vectors.transpose() * ritz_vectors - Matrix::Identity(6, 6)).norm() > 1e-8) {
+            std::cerr << "Ritz tracker eigenvectors of degenerate Ritz values are not orthonormal" << std::endl;
+            return 10;
+        }
+    }
+
+    // Thick-restart Lanczos must find the lowest eigenpairs with a basis much smaller than the matrix
+    {
+        const Eigen::SelfAdjointEigenSolver<Matrix> solver(toSolve);
+        ThickRestartLanczos<Matrix, Vector> thick_restart(6, 30);
+        if (!thick_restart.compute(toSolve) || thick_restart.n_restarts() == 0) {
+            std::cerr << "Thick-restart Lanczos did not converge or did not restart" << std::endl;
+            return 11;
+        }
+        for (int i = 0; i < 6; ++i) {
+            const double residual = (toSolve * thick_restart.eigenvectors().col(i) -
+                                     thick_restart.eigenvalues()(i) * thick_restart.eigenvectors().col(i))
+                                        .norm();
+            if (std::abs(thick_restart.eigenvalues()(i) - solver.eigenvalues()(i)) > 1e-10 || residual > 1e-8) {
+                std::cerr << "Thick-restart Lanczos is wrong for eigenpair " << i << ": "
+                          << thick_restart.eigenvalues()(i) << " != " << solver.eigenvalues()(i) << std::endl;
+                return 11;
+            }
+        }
+
+        // Starting states in different copies of the matrix see only one vector of each degenerate eigenspace;
+        // the combined runs must find all of them with their complete weights
+        Matrix doubled = Matrix::Zero(2 * N, 2 * N);
+        doubled.topLeftCorner(N, N) = toSolve;
+        doubled.bottomRightCorner(N, N) = toSolve;
+        Matrix states = Matrix::Zero(2 * N, 2);
+        states.col(0).head(N) = starting_state;
+        states.col(1) = Vector::LinSpaced(2 * N, -1., 1.).normalized();
+        ThickRestartLanczos<Matrix, Vector> multi_start(6, 30);
+        if (!multi_start.compute_from_states(doubled, states)) {
+            std::cerr << "Multi-start thick-restart Lanczos did not converge" << std::endl;
+            return 11;
+        }
+        const Matrix exact_vectors = solver.eigenvectors().leftCols(3);
+        for (Eigen::Index s = 0; s < states.cols(); ++s) {
+            const double exact_weight = (exact_vectors.transpose() * states.col(s).head(N)).squaredNorm() +
+                                        (exact_vectors.transpose() * states.col(s).tail(N)).squaredNorm();
+            const double weight = (multi_start.eigenvectors().transpose() * states.col(s)).squaredNorm();
+            if (std::abs(weight - exact_weight) > 1e-8) {
+                std::cerr << "Multi-start weight of state " << s << " is " << weight << " != " << exact_weight
+                          << std::endl;
+                return 11;
+            }
+        }
+        for (int i = 0; i < 6; ++i) {
+            if (std::abs(multi_start.eigenvalues()(i) - solver.eigenvalues()(i / 2)) > 1e-10) {
+                std::cerr << "Multi-start thick-restart Lanczos is wrong for eigenvalue " << i << ": "
+                          << multi_start.eigenvalues()(i) << " != " << solver.eigenvalues()(i / 2) << std::endl;
+                return 11;
+            }
+        }
+    }
+
+    // Bisection must reproduce the lowest eigenpairs and an eigenvalue window,
+    // also for a spectrum where every eigenvalue is doubly degenerate
+    {
+        Matrix degenerate = Matrix::Zero(2 * N, 2 * N);
+        degenerate.topLeftCorner(N, N) = toSolve;
+        degenerate.bottomRightCorner(N, N) = toSolve;
+        const Matrix rotation = Eigen::HouseholderQR<Matrix>(Matrix::Random(2 * N, 2 * N)).householderQ();
+        degenerate = rotation * degenerate * rotation.transpose();
+
+        for (const Matrix& matrix : {toSolve, degenerate}) {
+            const Eigen::SelfAdjointEigenSolver<Matrix> solver(matrix);
+            // The window contains the eigenvalues 4 to 11
+            const double lower = 0.5 * (solver.eigenvalues()(3) + solver.eigenvalues()(4));
+            const double upper = 0.5 * (solver.eigenvalues()(11) + solver.eigenvalues()(12));
+            for (auto bisection :
+                 {BisectionEigenSolver<Matrix>::lowest(7), BisectionEigenSolver<Matrix>::window(lower, upper)}) {
+                bisection.compute(matrix);
+                const Eigen::Index first = bisection.eigenvalues().size() == 7 ? 0 : 4;
+                if (bisection.eigenvalues().size() != (first == 0 ? 7 : 8) ||
+                    (bisection.eigenvectors().transpose() * bisection.eigenvectors() -
+                     Matrix::Identity(bisection.eigenvalues().size(), bisection.eigenvalues().size()))
+                            .norm() > 1e-10) {
+                    std::cerr << "Bisection returned " << bisection.eigenvalues().size()
+                              << " eigenpairs or non-orthonormal eigenvectors" << std::endl;
+                    return 12;
+                }
+                for (Eigen::Index i = 0; i < bisection.eigenvalues().size(); ++i) {
+                    const double residual = (matrix * bisection.eigenvectors().col(i) -
+                                             bisection.eigenvalues()(i) * bisection.eigenvectors().col(i))
+                                                .norm();
+                    if (std::abs(bisection.eigenvalues()(i) - solver.eigenvalues()(first + i)) > 1e-12 ||
+                        residual > 1e-10) {
+                        std::cerr << "Bisection is wrong for eigenpair " << first + i << ": "
+                                  << bisection.eigenvalues()(i) << " != " << solver.eigenvalues()(first + i)
+                                  << ", residual " << residual << std::endl;
+                        return 12;
+                    }
+                }
+            }
+        }
+    }
+
+    // A matrix-free operator must give the same coefficients as the dense matrix
+    {
+        const Vector diagonal = Vector::LinSpaced(N, 1., 5.);
+        const Vector coupling = Vector::LinSpaced(N, 0.5, 1.5) / std::sqrt(static_cast<double>(N));
+        const auto matrix_free = make_operator(N, [&](Eigen::Ref<const Vector> in, Eigen::Ref<Vector> out) {
+            out = diagonal.cwiseProduct(in) - coupling * coupling.dot(in);
+        });
+        Resolvent<Matrix, Vector> dense(starting_state);
+        dense.compute_with_reorthogonalization(toSolve, N_lanczos);
+        Resolvent<Matrix, Vector> free(starting_state);
+        free.compute_with_reorthogonalization(matrix_free, N_lanczos);
+
+        const auto& dense_data = dense.get_data().lanczos.front();
+        const auto& free_data = free.get_data().lanczos.front();
+        double error =
+            std::max(max_deviation(dense_data.a_i, free_data.a_i), max_deviation(dense_data.b_i, free_data.b_i));
+        if (error > 1e-10 || dense_data.a_i.size() != free_data.a_i.size()) {
+            std::cerr << "Matrix-free Lanczos deviates from dense Lanczos " << error << std::endl;
+            return 6;
+        }
+
+        // Symplectic path with a matrix-free metric
+        const Vector metric_diagonal = Vector::LinSpaced(N, 0.5, 2.);
+        const Matrix metric = metric_diagonal.asDiagonal();
+        const auto metric_free = make_operator(N, [&](Eigen::Ref<const Vector> in, Eigen::Ref<Vector> out) {
+            out = metric_diagonal.cwiseProduct(in);
+        });
+        Resolvent<Matrix, Vector> dense_symplectic(starting_state);
+        dense_symplectic.compute(toSolve, metric, 20);
+        Resolvent<Matrix, Vector> free_symplectic(starting_state);
+        free_symplectic.compute(matrix_free, metric_free, 20);
+
+        const auto& dense_symplectic_data = dense_symplectic.get_data().lanczos.front();
+        const auto& free_symplectic_data = free_symplectic.get_data().lanczos.front();
+        error = std::max(max_deviation(dense_symplectic_data.a_i, free_symplectic_data.a_i),
+                         max_deviation(dense_symplectic_data.b_i, free_symplectic_data.b_i));
+        if (error > 1e-10) {
+            std::cerr << "Matrix-free symplectic Lanczos deviates from dense Lanczos " << error << std::endl;
+            return 6;
+        }
+
+        // The metric is applied once per iteration and reorthogonalization in the metric needs no extra applications
+        int n_metric_applications{};
+        const auto counting_metric = make_operator(N, [&](Eigen::Ref<const Vector> in, Eigen::Ref<Vector> out) {
+            ++n_metric_applications;
+            out = metric_diagonal.cwiseProduct(in);
+        });
+        // S^-1 H is self-adjoint in the metric S
+        const Matrix metric_self_adjoint = metric_diagonal.cwiseInverse().asDiagonal() * toSolve;
+        Resolvent<Matrix, Vector> plain_symplectic(starting_state);
+        plain_symplectic.compute(metric_self_adjoint, metric, 20);
+        Resolvent<Matrix, Vector> reorthogonalized_symplectic(starting_state);
+        reorthogonalized_symplectic.compute(metric_self_adjoint, counting_metric, 20, true);
+        const auto& plain_data = plain_symplectic.get_data().lanczos.front();
+        const auto& reorthogonalized_data = reorthogonalized_symplectic.get_data().lanczos.front();
+        // Only the leading coefficients are unaffected by the loss of orthogonality in the plain iteration
+        const auto leading = [](const std::vector<double>& coefficients) {
+            return std::vector<double>(coefficients.begin(), coefficients.begin() + 10);
+        };
+        error = std::max(max_deviation(leading(plain_data.a_i), reorthogonalized_data.a_i),
+                         max_deviation(leading(plain_data.b_i), reorthogonalized_data.b_i));
+        if (n_metric_applications != 21 || error > 1e-8) {
+            std::cerr << "Symplectic Lanczos with metric reorthogonalization deviates " << error << " after "
+                      << n_metric_applications << " metric applications" << std::endl;
+            return 6;
+        }
+    }
+
+    // A sparse matrix must give the same results as its dense counterpart
+    {
+        using SparseMatrix = Eigen::SparseMatrix<double>;
+        // Local hopping between nearest and next-nearest neighbors
+        TripletAssembler<double> assembler(N, N, 5 * N);
+        for (int i = 0; i < N; ++i) {
+            assembler(i, i) = 2. + std::cos(0.1 * i);
+            for (int d = 1; d <= 2; ++d) {
+                if (i + d < N) {
+                    assembler(i, i + d) -= 0.5 / d;
+                    assembler(i + d, i) -= 0.5 / d;
+                }
+            }
+        }
+        const SparseMatrix sparse = assembler.to_sparse();
+        Matrix dense;
+        assembler.to_dense(dense);
+        if (sparse.nonZeros() != 5 * N - 6 || (Matrix(sparse) - dense).norm() > 1e-14) {
+            std::cerr << "Triplet assembly is wrong" << std::endl;
+            return 7;
+        }
+        if (!detail::is_hermitian(sparse, 1e-12) || !detail::is_hermitian(dense, 1e-12)) {
+            std::cerr << "Hermitian matrix is not recognized as such" << std::endl;
+            return 7;
+        }
+        SparseMatrix non_hermitian = sparse;
+        non_hermitian.coeffRef(0, 1) += 1e-6;
+        if (detail::is_hermitian(non_hermitian, 1e-12) || detail::is_hermitian(Matrix(non_hermitian), 1e-12)) {
+            std::cerr << "Non-Hermitian matrix is not detected" << std::endl;
+            return 7;
+        }
+
+        // The coefficients of this matrix are sensitive to rounding after a few dozen iterations,
+        // thus only the first ones are compared, while the lowest Ritz value must converge either way
+        Resolvent<SparseMatrix, Vector> sparse_resolvent(starting_state);
+        sparse_resolvent.compute_with_reorthogonalization(sparse, 20);
+        Resolvent<Matrix, Vector> dense_resolvent(starting_state);
+        dense_resolvent.compute_with_reorthogonalization(dense, 20);
+
+        const auto& sparse_data = sparse_resolvent.get_data().lanczos.front();
+        const auto& dense_data = dense_resolvent.get_data().lanczos.front();
+        const double error =
+            std::max(max_deviation(sparse_data.a_i, dense_data.a_i), max_deviation(sparse_data.b_i, dense_data.b_i));
+        if (error > 1e-10) {
+            std::cerr << "Sparse Lanczos deviates from dense Lanczos " << error << std::endl;
+            return 7;
+        }
+
+        const auto sparse_residuals = sparse_resolvent.compute_with_residuals<1>(sparse, N_lanczos);
+        const double lowest_eigenvalue = Eigen::SelfAdjointEigenSolver<Matrix>(dense).eigenvalues()(0);
+        if (!sparse_residuals.converged[0] || std::abs(sparse_residuals.eigenvalues[0] - lowest_eigenvalue) > 1e-8) {
+            std::cerr << "Sparse Lanczos did not find the lowest eigenvalue " << sparse_residuals.eigenvalues[0]
+                      << " != " << lowest_eigenvalue << std::endl;
+            return 7;
+        }
+    }
+
+    // Adaptive termination must stop early, keep the coefficients of the full run, and record its reason
+    {
+        // A chain whose on-site energies approach 2 exponentially; starting at its first site,
+        // the Lanczos coefficients are the on-site energies and hoppings themselves
+        Matrix chain = Matrix::Zero(N, N);
+        for (int i = 0; i < N; ++i) {
+            chain(i, i) = 2. + std::exp(-0.2 * i);
+            if (i + 1 < N) {
+                chain(i, i + 1) = 1.;
+                chain(i + 1, i) = 1.;
+            }
+        }
+        const Vector first_site = Vector::Unit(N, 0);
+        Resolvent<Matrix, Vector> full(first_site);
+        full.compute_with_reorthogonalization(chain, 2 * N_lanczos);
+        Resolvent<Matrix, Vector> adaptive(first_site);
+        adaptive.termination = TerminationCriterion<double>::coefficients(1e-6);
+        adaptive.compute_with_reorthogonalization(chain, 2 * N_lanczos);
+
+        const auto& full_data = full.get_data().lanczos.front();
+        const auto& adaptive_data = adaptive.get_data().lanczos.front();
+        if (full_data.termination_reason != TerminationReason::MAX_ITERATIONS ||
+            adaptive_data.termination_reason != TerminationReason::COEFFICIENTS_CONVERGED ||
+            adaptive_data.a_i.size() >= full_data.a_i.size()) {
+            std::cerr << "Coefficient convergence did not stop the iteration: "
+                      << to_string(adaptive_data.termination_reason) << " after " << adaptive_data.a_i.size()
+                      << " iterations" << std::endl;
+            return 9;
+        }
+        const double error =
+            std::max(max_deviation(full_data.a_i, adaptive_data.a_i), max_deviation(full_data.b_i, adaptive_data.b_i));
+        if (error > 1e-12 || std::abs(adaptive_data.a_i.back() - 2.) > 1e-5) {
+            std::cerr << "Adaptive termination changed the coefficients " << error << std::endl;
+            return 9;
+        }
+
+        const Vector probe_grid = Vector::LinSpaced(51, 0.5, 5.5);
+        Resolvent<Matrix, Vector> probed(starting_state);
+        probed.termination = TerminationCriterion<double>::resolvent(
+            std::vector<double>(probe_grid.begin(), probe_grid.end()), 0.1, 1e-4);
+        probed.compute_with_reorthogonalization(toSolve, N);
+        if (probed.get_data().lanczos.front().termination_reason != TerminationReason::RESOLVENT_CONVERGED) {
+            std::cerr << "Resolvent convergence did not stop the iteration" << std::endl;
+            return 9;
+        }
+
+        Resolvent<Matrix, Vector> eigenstate(Eigen::SelfAdjointEigenSolver<Matrix>(toSolve).eigenvectors().col(0));
+        eigenstate.compute(toSolve, N_lanczos);
+        if (eigenstate.get_data().lanczos.front().termination_reason != TerminationReason::INVARIANT_SUBSPACE ||
+            eigenstate.get_data().lanczos.front().a_i.size() != 1U) {
+            std::cerr << "An eigenstate as starting state did not exhaust the Krylov space" << std::endl;
+            return 9;
+        }
+    }
+
+    // Block Lanczos must reproduce the continued fractions of the individual starting states
+    // The block Krylov space of 3 states is exhausted after N / 3 iterations
+    {
+        const int N_block_lanczos = 100;
+        std::vector<Vector> states{starting_state, Vector::LinSpaced(N, -1., 1.), Vector::Random(N)};
+        BlockResolvent<Matrix, Vector> block_resolvent(states, {"ones", "linear", "random"});
+        block_resolvent.compute_with_reorthogonalization(toSolve, N_block_lanczos, true);
+        const auto& block_data = block_resolvent.get_data();
+        if (block_data.size() != 6U) {
+            std::cerr << "Block Lanczos returned " << block_data.size() << " instead of 6 resolvents" << std::endl;
+            return 3;
+        }
+
+        std::vector<Vector> single_states = states;
+        single_states.push_back(0.5 * (states[0] + states[1]));
+        for (std::size_t i = 0U; i < single_states.size(); ++i) {
+            Resolvent<Matrix, Vector> single(single_states[i]);
+            single.compute_with_reorthogonalization(toSolve, N_block_lanczos);
+            const auto& single_data = single.get_data().lanczos.front();
+            const auto& block_single_data = block_data[i < 3U ? i : 3U].lanczos.front();
+            const double error = std::max(max_deviation(single_data.a_i, block_single_data.a_i),
+                                          max_deviation(single_data.b_i, block_single_data.b_i));
+            if (error > 1e-8 || single_data.a_i.size() != block_single_data.a_i.size()) {
+                std::cerr << "Block Lanczos deviates for state " << i << ": " << error << std::endl;
+                return 3;
+            }
+        }
+
+        // Linearly dependent states are deflated with a random direction, which must be reproducible
+        const std::vector<Vector> dependent_states{starting_state, 2. * starting_state};
+        BlockResolvent<Matrix, Vector> deflated(dependent_states);
+        deflated.compute_with_reorthogonalization(toSolve, 10);
+        BlockResolvent<Matrix, Vector> repeated(dependent_states);
+        repeated.compute_with_reorthogonalization(toSolve, 10);
+        if (deflated.block_tridiagonal.construct_matrix() != repeated.block_tridiagonal.construct_matrix()) {
+            std::cerr << "Deflated block Lanczos is not reproducible" << std::endl;
+            return 3;
+        }
+    }
+
+    return 0;
+}